@@ -42,6 +42,7 @@
 #include "include/sys/my_thread.h"
 #include <mysql.h>
 #include "include/sys_main.h"
+#include "include/sys/m_string.h"
 #include <mysqld_error.h>
 
 #endif
@@ -87,6 +88,13 @@ extern "C"
 #define myodbc_mutex_trylock native_mutex_trylock
 #define myodbc_mutex_init native_mutex_init
 #define myodbc_mutex_destroy native_mutex_destroy
+#define myodbc_cond_t native_cond_t
+#define myodbc_cond_init native_cond_init
+#define myodbc_cond_destroy native_cond_destroy
+#define myodbc_cond_wait native_cond_wait
+#define myodbc_cond_timedwait native_cond_timedwait
+#define myodbc_cond_signal native_cond_signal
+#define myodbc_cond_broadcast native_cond_broadcast
 #define sort_dynamic(A,cmp) my_qsort((A)->buffer, (A)->elements, (A)->size_of_element, (cmp))
 #define push_dynamic(A,B) insert_dynamic((A),(B))
 #define myodbc_snprintf my_snprintf
@@ -313,7 +313,7 @@ SQLDescribeCol(SQLHSTMT hstmt, SQLUSMALLINT column,
 
   if (free_value == -1)
   {
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
 
@@ -448,13 +448,31 @@ SQLError(SQLHENV henv, SQLHDBC hdbc, SQLHSTMT hstmt, SQLCHAR *sqlstate,
 }
 
 
+/* SQLExecDirect() run by a worker, the query is in stmt->async.args */
+static SQLRETURN exec_direct_async(STMT *stmt)
+{
+  SQLRETURN rc= SQLPrepareImpl(stmt, (SQLCHAR *)stmt->async.args,
+                               (SQLINTEGER)stmt->async.args_length);
+
+  return rc ? rc : my_SQLExecute(stmt);
+}
+
+
 SQLRETURN SQL_API
 SQLExecDirect(SQLHSTMT hstmt, SQLCHAR *str, SQLINTEGER str_len)
 {
   int error;
+  SQLRETURN rc;
   
   CHECK_HANDLE(hstmt);  
 
+  if (str && (str_len == SQL_NTS || str_len > 0) &&
+      async_requested((STMT *)hstmt) &&
+      async_call((STMT *)hstmt, exec_direct_async, str,
+                 str_len == SQL_NTS ? strlen((char *)str) : (size_t)str_len,
+                 &rc))
+    return rc;
+
   if ((error= SQLPrepareImpl(hstmt, str, str_len)))
     return error;
   error= my_SQLExecute((STMT *)hstmt);
@@ -649,6 +667,7 @@ SQLGetCursorName(SQLHSTMT hstmt, SQLCHAR *cursor, SQLSMALLINT cursor_max,
   uint errors;
 
   CHECK_HANDLE(stmt);
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(stmt);
 
   if (cursor_max < 0)
@@ -975,6 +994,7 @@ SQLRETURN SQL_API
 SQLPrepare(SQLHSTMT hstmt, SQLCHAR *str, SQLINTEGER str_len)
 {
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC((STMT *)hstmt);
 
   return SQLPrepareImpl(hstmt, str, str_len);
 }
@@ -1003,7 +1023,7 @@ SQLPrepareImpl(SQLHSTMT hstmt, SQLCHAR *str, SQLINTEGER str_len)
 
     if (!str && str_len == -1)
     {
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
@@ -1228,9 +1248,9 @@ SQLSetConnectAttrImpl(SQLHDBC hdbc, SQLINTEGER attribute,
                                 value, &value_len, &errors);
       if (!value && value_len == -1)
       {
-        set_mem_error(&dbc->mysql);
-        return set_conn_error(dbc, MYERR_S1001, mysql_error(&dbc->mysql),
-                              mysql_errno(&dbc->mysql));
+        set_mem_error(dbc->mysql);
+        return set_conn_error(dbc, MYERR_S1001, mysql_error(dbc->mysql),
+                              mysql_errno(dbc->mysql));
       }
       free_value= TRUE;
     }
@@ -1278,7 +1298,7 @@ SQLSetCursorName(SQLHSTMT hstmt, SQLCHAR *name, SQLSMALLINT name_len)
 
   if (!name && len == -1)
   {
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
 
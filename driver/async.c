@@ -0,0 +1,393 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  async.c
+  @brief Asynchronous execution of statement functions.
+
+  With SQL_ATTR_ASYNC_ENABLE on, SQLExecDirect(), SQLExecute(), SQLFetch(),
+  SQLFetchScroll() and SQLMoreResults() hand the call to a worker thread
+  and return SQL_STILL_EXECUTING. Calling the same function again returns
+  SQL_STILL_EXECUTING until the worker is done, and then the result of the
+  call. If the driver manager has set a notification callback, the worker
+  calls it once the result is there.
+
+  Workers are shared by all statements of the process. They are started on
+  demand, up to MAX_ASYNC_WORKERS, and exit after being idle for a while.
+  Calls made while all workers are busy wait in a queue.
+*/
+
+#include "driver.h"
+
+#define MAX_ASYNC_WORKERS       64
+/* Milliseconds an idle worker waits for a call before exiting */
+#define ASYNC_WORKER_IDLE_TIME  30000
+
+#ifdef THREAD
+
+static myodbc_mutex_t async_lock;
+static myodbc_cond_t  async_queued, async_done;
+static STMT           *queue_head= NULL, *queue_tail= NULL;
+static uint           queue_length= 0;
+static uint           workers= 0, idle_workers= 0;
+static my_bool        async_stop= FALSE;
+
+
+/* Takes the statement out of the queue. Called under lock */
+static void unqueue(STMT *stmt)
+{
+  STMT **pos= &queue_head, *prev= NULL;
+
+  while (*pos && *pos != stmt)
+  {
+    prev= *pos;
+    pos= &(*pos)->async.next;
+  }
+
+  if (*pos == NULL)
+  {
+    return;
+  }
+
+  *pos= stmt->async.next;
+  if (queue_tail == stmt)
+  {
+    queue_tail= prev;
+  }
+  stmt->async.next= NULL;
+  --queue_length;
+}
+
+
+/* Body of a worker thread */
+static void * run_calls(void *arg)
+{
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&async_lock);
+
+  while (!async_stop)
+  {
+    STMT          *stmt;
+    MY_ASYNC_CALL *call;
+    SQLRETURN     rc;
+
+    if (queue_head == NULL)
+    {
+      int wait_rc;
+
+      ++idle_workers;
+      wait_rc= myodbc_cond_timedwait(&async_queued, &async_lock,
+                                     ASYNC_WORKER_IDLE_TIME);
+      --idle_workers;
+
+      if (queue_head == NULL && wait_rc == ETIMEDOUT)
+      {
+        break;
+      }
+      continue;
+    }
+
+    stmt= queue_head;
+    call= &stmt->async;
+    unqueue(stmt);
+    call->started= TRUE;
+
+    myodbc_mutex_unlock(&async_lock);
+
+    rc= call->run(stmt);
+
+    myodbc_mutex_lock(&async_lock);
+
+    call->rc= rc;
+    call->done= TRUE;
+    myodbc_cond_broadcast(&async_done);
+
+#ifdef SQL_ATTR_ASYNC_STMT_PCALLBACK
+    /* The statement may be gone once the lock is released */
+    if (call->callback)
+    {
+      SQLPOINTER callback= call->callback, context= call->context;
+
+      myodbc_mutex_unlock(&async_lock);
+      ((SQL_ASYNC_NOTIFICATION_CALLBACK)callback)(context, TRUE);
+      myodbc_mutex_lock(&async_lock);
+    }
+#endif
+  }
+
+  --workers;
+  myodbc_cond_broadcast(&async_done);
+  myodbc_mutex_unlock(&async_lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/* Queues the call of the statement, starting a worker if needed */
+static BOOL submit(STMT *stmt)
+{
+  myodbc_mutex_lock(&async_lock);
+
+  if (queue_tail)
+  {
+    queue_tail->async.next= stmt;
+  }
+  else
+  {
+    queue_head= stmt;
+  }
+  queue_tail= stmt;
+  ++queue_length;
+
+  if (idle_workers < queue_length && workers < MAX_ASYNC_WORKERS)
+  {
+    my_thread_attr_t  attr;
+    my_thread_handle  thread;
+
+    my_thread_attr_init(&attr);
+    my_thread_attr_setdetachstate(&attr, MY_THREAD_CREATE_DETACHED);
+
+    if (!my_thread_create(&thread, &attr, run_calls, NULL))
+    {
+      ++workers;
+    }
+    my_thread_attr_destroy(&attr);
+  }
+
+  /* Nobody to run the call, it is to be executed synchronously */
+  if (workers == 0)
+  {
+    unqueue(stmt);
+    myodbc_mutex_unlock(&async_lock);
+    return FALSE;
+  }
+
+  myodbc_cond_signal(&async_queued);
+  myodbc_mutex_unlock(&async_lock);
+
+  return TRUE;
+}
+
+
+static void finish_call(MY_ASYNC_CALL *call)
+{
+  x_free(call->args);
+  call->args= NULL;
+  call->args_length= 0;
+  call->run= NULL;
+}
+
+#endif /* THREAD */
+
+
+void async_init(void)
+{
+#ifdef THREAD
+  myodbc_mutex_init(&async_lock, NULL);
+  myodbc_cond_init(&async_queued);
+  myodbc_cond_init(&async_done);
+  async_stop= FALSE;
+#endif
+}
+
+
+/* Stops the workers. There are no statements left to run calls of */
+void async_end(void)
+{
+#ifdef THREAD
+  myodbc_mutex_lock(&async_lock);
+  async_stop= TRUE;
+  myodbc_cond_broadcast(&async_queued);
+
+# ifdef _WIN32
+  /* Called from DllMain(), where threads can not be waited for */
+  myodbc_mutex_unlock(&async_lock);
+# else
+  while (workers > 0)
+  {
+    myodbc_cond_wait(&async_done, &async_lock);
+  }
+  myodbc_mutex_unlock(&async_lock);
+
+  myodbc_cond_destroy(&async_done);
+  myodbc_cond_destroy(&async_queued);
+  myodbc_mutex_destroy(&async_lock);
+# endif
+#endif
+}
+
+
+/* Checks if the call to a statement function can go to a worker */
+BOOL async_requested(STMT *stmt)
+{
+#ifdef THREAD
+  return stmt->async.run != NULL ||
+         stmt->stmt_options.async_enable == SQL_ASYNC_ENABLE_ON;
+#else
+  return FALSE;
+#endif
+}
+
+
+/*
+  Starts the asynchronous call of the function, or reports the state of the
+  call started before. The arguments are copied for the worker, which finds
+  them in stmt->async.args.
+
+  Returns FALSE if the function is to be executed synchronously, otherwise
+  *rc is what the function returns to the application.
+*/
+BOOL async_call(STMT *stmt, MY_ASYNC_RUN run, const void *args,
+                size_t args_length, SQLRETURN *rc)
+{
+#ifdef THREAD
+  MY_ASYNC_CALL *call= &stmt->async;
+  my_bool       done;
+
+  if (call->run)
+  {
+    if (call->run != run)
+    {
+      *rc= set_error(stmt, MYERR_S1010, NULL, 0);
+      return TRUE;
+    }
+
+    myodbc_mutex_lock(&async_lock);
+    done= call->done;
+    myodbc_mutex_unlock(&async_lock);
+
+    if (!done)
+    {
+      *rc= SQL_STILL_EXECUTING;
+      return TRUE;
+    }
+
+    *rc= call->rc;
+    finish_call(call);
+    return TRUE;
+  }
+
+  if (stmt->stmt_options.async_enable != SQL_ASYNC_ENABLE_ON)
+  {
+    return FALSE;
+  }
+
+  if (args_length &&
+      !(call->args= myodbc_memdup((char *)args, args_length, MYF(0))))
+  {
+    return FALSE;
+  }
+
+  call->args_length= args_length;
+  call->run=         run;
+  call->started=     call->done= FALSE;
+  call->next=        NULL;
+
+  if (!submit(stmt))
+  {
+    finish_call(call);
+    return FALSE;
+  }
+
+  *rc= SQL_STILL_EXECUTING;
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+
+/*
+  Cancels the asynchronous call of the statement. A call still waiting for
+  a worker is not made at all, for a running one the caller has to kill
+  its query.
+*/
+int async_cancel(STMT *stmt)
+{
+#ifdef THREAD
+  MY_ASYNC_CALL *call= &stmt->async;
+  int           result= ASYNC_CANCEL_DONE;
+
+  if (call->run == NULL)
+  {
+    return ASYNC_CANCEL_NONE;
+  }
+
+  myodbc_mutex_lock(&async_lock);
+
+  if (!call->started)
+  {
+    unqueue(stmt);
+    call->rc= set_stmt_error(stmt, "HY008", "Operation canceled", 0);
+    call->done= TRUE;
+  }
+  else if (!call->done)
+  {
+    result= ASYNC_CANCEL_KILL;
+  }
+
+  myodbc_mutex_unlock(&async_lock);
+
+  return result;
+#else
+  return ASYNC_CANCEL_NONE;
+#endif
+}
+
+
+/*
+  Waits for the asynchronous call of the statement to finish and discards
+  its result. Has to be called before the statement is freed.
+*/
+void async_wait(STMT *stmt)
+{
+#ifdef THREAD
+  MY_ASYNC_CALL *call= &stmt->async;
+
+  if (call->run == NULL)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&async_lock);
+
+  if (!call->started)
+  {
+    unqueue(stmt);
+    call->done= TRUE;
+  }
+
+  while (!call->done)
+  {
+    myodbc_cond_wait(&async_done, &async_lock);
+  }
+
+  myodbc_mutex_unlock(&async_lock);
+
+  finish_call(call);
+#endif
+}
@@ -0,0 +1,444 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  cancel.c
+  @brief Killing running queries, for SQLCancel() and query timeouts.
+
+  A query is killed with KILL QUERY sent over a control connection. The
+  control connection is made with all options of the data source, SSL and
+  authentication ones included, the first time a query of a server is to be
+  killed, and is kept open for the next one. There is one idle control
+  connection per data source at most.
+
+  Where the server does not enforce SQL_ATTR_QUERY_TIMEOUT itself, that is
+  before MySQL 5.7.8 and for statements other than SELECT, do_query()
+  starts a timer for the query. A watchdog thread kills the queries whose
+  timers have expired, and their statements get HYT00.
+*/
+
+#include "driver.h"
+
+
+typedef struct control_conn
+{
+  SQLWCHAR            *key;       /* serialized data source */
+  size_t              key_len;
+  MYSQL               *mysql;     /* NULL while in use */
+  struct control_conn *next;
+} MY_CONTROL_CONN;
+
+
+static MY_CONTROL_CONN  *control_conns= NULL;
+static myodbc_mutex_t   cancel_lock;
+/* Serializes use of the data source strings for making connections */
+static myodbc_mutex_t   control_connect_lock;
+
+#ifdef THREAD
+static myodbc_cond_t    timers_changed, timer_killed;
+static MY_QUERY_TIMER   *timers= NULL;
+static my_thread_handle watchdog_thread;
+static my_bool          watchdog_running= FALSE;
+static my_bool          watchdog_stop= FALSE;
+#endif
+
+
+/* Opens a control connection to the server of the connection */
+static MYSQL * control_connect(DBC *dbc)
+{
+  DataSource  *ds= dbc->ds;
+  MYSQL       *mysql;
+
+  if (!(mysql= mysql_init(NULL)))
+  {
+    return NULL;
+  }
+
+  myodbc_mutex_lock(&control_connect_lock);
+
+  myodbc_set_connect_options(dbc, mysql, ds);
+
+  /* The strings of the connection itself are there since it connected */
+  if (!mysql_real_connect(mysql, (char *)ds->server8, (char *)ds->uid8,
+                          (char *)ds->pwd8, NULL, ds->port,
+                          (char *)ds->socket8, 0))
+  {
+    myodbc_mutex_unlock(&control_connect_lock);
+    mysql_close(mysql);
+    return NULL;
+  }
+
+  myodbc_mutex_unlock(&control_connect_lock);
+
+  return mysql;
+}
+
+
+/* Takes the idle control connection of the key, if there is one */
+static MYSQL * take_control_conn(SQLWCHAR *key, size_t key_len)
+{
+  MY_CONTROL_CONN *conn;
+  MYSQL           *mysql= NULL;
+
+  myodbc_mutex_lock(&cancel_lock);
+  for (conn= control_conns; conn; conn= conn->next)
+  {
+    if (conn->key_len == key_len &&
+        !memcmp(conn->key, key, key_len * sizeof(SQLWCHAR)))
+    {
+      mysql= conn->mysql;
+      conn->mysql= NULL;
+      break;
+    }
+  }
+  myodbc_mutex_unlock(&cancel_lock);
+
+  return mysql;
+}
+
+
+/*
+  Keeps the control connection for the next kill, or closes it if there is
+  an idle one for the key already. The key is taken over.
+*/
+static void return_control_conn(SQLWCHAR *key, size_t key_len, MYSQL *mysql)
+{
+  MY_CONTROL_CONN *conn;
+
+  myodbc_mutex_lock(&cancel_lock);
+
+  for (conn= control_conns; conn; conn= conn->next)
+  {
+    if (conn->key_len == key_len &&
+        !memcmp(conn->key, key, key_len * sizeof(SQLWCHAR)))
+    {
+      break;
+    }
+  }
+
+  if (conn == NULL &&
+      (conn= (MY_CONTROL_CONN *)myodbc_malloc(sizeof(MY_CONTROL_CONN),
+                                              MYF(MY_ZEROFILL))))
+  {
+    conn->key=     key;
+    conn->key_len= key_len;
+    conn->next=    control_conns;
+    control_conns= conn;
+    key= NULL;
+  }
+
+  if (conn && conn->mysql == NULL)
+  {
+    conn->mysql= mysql;
+    mysql= NULL;
+  }
+
+  myodbc_mutex_unlock(&cancel_lock);
+
+  if (mysql)
+  {
+    mysql_close(mysql);
+  }
+  x_free(key);
+}
+
+
+/**
+  Kills the query running on the connection with the given thread id.
+
+  @param[in]  dbc        Connection the query runs on
+  @param[in]  thread_id  Its mysql_thread_id()
+
+  @return TRUE if KILL QUERY has been sent successfully
+*/
+BOOL kill_query(DBC *dbc, unsigned long thread_id)
+{
+  SQLWCHAR  *key;
+  size_t    key_len;
+  MYSQL     *mysql;
+  my_bool   fresh= FALSE;
+  BOOL      killed= FALSE;
+  char      buff[40];
+
+  if (!(key= pool_key(dbc->ds, &key_len)))
+  {
+    return FALSE;
+  }
+
+  /* buff is always big enough because max length of %lu is 20 */
+  sprintf(buff, "KILL /*!50000 QUERY */ %lu", thread_id);
+
+  mysql= take_control_conn(key, key_len);
+
+  while (TRUE)
+  {
+    if (mysql == NULL)
+    {
+      if (!(mysql= control_connect(dbc)))
+      {
+        break;
+      }
+      fresh= TRUE;
+    }
+
+    if (!mysql_real_query(mysql, buff, (unsigned long)strlen(buff)))
+    {
+      killed= TRUE;
+      break;
+    }
+
+    /* A kept connection may have been closed by the server meanwhile */
+    if (fresh || !is_connection_lost(mysql_errno(mysql)))
+    {
+      break;
+    }
+
+    mysql_close(mysql);
+    mysql= NULL;
+  }
+
+  if (mysql && !is_connection_lost(mysql_errno(mysql)))
+  {
+    return_control_conn(key, key_len, mysql);
+    return killed;
+  }
+
+  if (mysql)
+  {
+    mysql_close(mysql);
+  }
+  x_free(key);
+
+  return killed;
+}
+
+
+#ifdef THREAD
+
+/* Body of the thread killing the queries that ran out of time */
+static void * watch_timers(void *arg)
+{
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&cancel_lock);
+
+  while (!watchdog_stop)
+  {
+    MY_QUERY_TIMER  *timer, *expired= NULL;
+    time_t          now= time(NULL), next= 0;
+
+    for (timer= timers; timer; timer= timer->next)
+    {
+      if (timer->fired)
+      {
+        continue;
+      }
+
+      /* The deadline is in seconds, so it has passed only after the next */
+      if (now > timer->deadline)
+      {
+        expired= timer;
+        break;
+      }
+
+      if (next == 0 || timer->deadline < next)
+      {
+        next= timer->deadline;
+      }
+    }
+
+    if (expired)
+    {
+      expired->fired=   TRUE;
+      expired->killing= TRUE;
+      myodbc_mutex_unlock(&cancel_lock);
+
+      /* The timer, and so the connection, stay until the kill is done */
+      kill_query(expired->dbc, expired->thread_id);
+
+      myodbc_mutex_lock(&cancel_lock);
+      expired->killing= FALSE;
+      myodbc_cond_broadcast(&timer_killed);
+      continue;
+    }
+
+    if (next)
+    {
+      myodbc_cond_timedwait(&timers_changed, &cancel_lock,
+                            (unsigned int)(next + 1 - now) * 1000);
+    }
+    else
+    {
+      myodbc_cond_wait(&timers_changed, &cancel_lock);
+    }
+  }
+
+  myodbc_mutex_unlock(&cancel_lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+#endif /* THREAD */
+
+
+/**
+  Starts the timer of the query about to be executed on the connection. The
+  timer has to stay valid until query_timer_stop() is called for it. The
+  connection has to be locked.
+
+  @param[in]  timer    Timer to start
+  @param[in]  dbc      Connection to execute the query on
+  @param[in]  timeout  Query timeout in seconds
+*/
+void query_timer_start(MY_QUERY_TIMER *timer, DBC *dbc, SQLULEN timeout)
+{
+  memset(timer, 0, sizeof(MY_QUERY_TIMER));
+
+#ifdef THREAD
+  timer->dbc=       dbc;
+  timer->thread_id= mysql_thread_id(dbc->mysql);
+  timer->deadline=  time(NULL) + (time_t)timeout;
+
+  myodbc_mutex_lock(&cancel_lock);
+
+  if (!watchdog_running && !watchdog_stop)
+  {
+    watchdog_running= !my_thread_create(&watchdog_thread, NULL, watch_timers,
+                                        NULL);
+  }
+
+  if (watchdog_running)
+  {
+    timer->next= timers;
+    timers= timer;
+    timer->started= TRUE;
+    myodbc_cond_signal(&timers_changed);
+  }
+
+  myodbc_mutex_unlock(&cancel_lock);
+#endif
+}
+
+
+/**
+  Stops the timer, waiting for the kill of its query if it is in progress.
+
+  @return TRUE if the timer has expired and the query has been killed
+*/
+BOOL query_timer_stop(MY_QUERY_TIMER *timer)
+{
+#ifdef THREAD
+  MY_QUERY_TIMER **pos;
+
+  if (!timer->started)
+  {
+    return FALSE;
+  }
+
+  myodbc_mutex_lock(&cancel_lock);
+
+  while (timer->killing)
+  {
+    myodbc_cond_wait(&timer_killed, &cancel_lock);
+  }
+
+  for (pos= &timers; *pos; pos= &(*pos)->next)
+  {
+    if (*pos == timer)
+    {
+      *pos= timer->next;
+      break;
+    }
+  }
+
+  myodbc_mutex_unlock(&cancel_lock);
+
+  timer->started= FALSE;
+
+  return timer->fired;
+#else
+  return FALSE;
+#endif
+}
+
+
+void cancel_init(void)
+{
+  myodbc_mutex_init(&cancel_lock, NULL);
+  myodbc_mutex_init(&control_connect_lock, NULL);
+#ifdef THREAD
+  myodbc_cond_init(&timers_changed);
+  myodbc_cond_init(&timer_killed);
+  watchdog_stop= FALSE;
+#endif
+}
+
+
+/* Stops the watchdog and closes the control connections */
+void cancel_end(void)
+{
+  MY_CONTROL_CONN *conn, *next;
+
+#ifdef THREAD
+  myodbc_mutex_lock(&cancel_lock);
+  watchdog_stop= TRUE;
+  myodbc_cond_broadcast(&timers_changed);
+  myodbc_mutex_unlock(&cancel_lock);
+
+# ifdef _WIN32
+  /* Called from DllMain(), where the thread can not be waited for */
+  if (watchdog_running)
+  {
+    return;
+  }
+# else
+  if (watchdog_running)
+  {
+    my_thread_join(&watchdog_thread, NULL);
+    watchdog_running= FALSE;
+  }
+# endif
+#endif
+
+  for (conn= control_conns; conn; conn= next)
+  {
+    next= conn->next;
+    if (conn->mysql)
+    {
+      mysql_close(conn->mysql);
+    }
+    x_free(conn->key);
+    x_free(conn);
+  }
+  control_conns= NULL;
+
+#ifdef THREAD
+  myodbc_cond_destroy(&timer_killed);
+  myodbc_cond_destroy(&timers_changed);
+#endif
+  myodbc_mutex_destroy(&control_connect_lock);
+  myodbc_mutex_destroy(&cancel_lock);
+}
@@ -42,7 +42,7 @@ my_bool server_has_i_s(DBC *dbc)
     According to the server ChangeLog INFORMATION_SCHEMA was introduced
     in the 5.0.2
   */
-  return is_minimum_version(dbc->mysql.server_version, "5.0.2");
+  return is_minimum_version(dbc->mysql->server_version, "5.0.2");
 }
 /*
   @type    : internal
@@ -96,7 +96,7 @@ create_fake_resultset(STMT *stmt, MYSQL_ROW rowval, size_t rowsize,
     x_free(stmt->result);
     x_free(stmt->result_array);
 
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
   stmt->fake_result= 1;
@@ -141,7 +141,7 @@ create_empty_fake_resultset(STMT *stmt, MYSQL_ROW rowval, size_t rowsize,
   @param[in] wildcard       Whether the table name is a wildcard
 
   @return Result of SHOW TABLE STATUS, or NULL if there is an error
-          or empty result (check mysql_errno(&stmt->dbc->mysql) != 0)
+          or empty result (check mysql_errno(stmt->dbc->mysql) != 0)
 */
 static MYSQL_RES *table_status_i_s(STMT        *stmt,
                                          SQLCHAR     *catalog_name,
@@ -152,7 +152,7 @@ static MYSQL_RES *table_status_i_s(STMT        *stmt,
                                          my_bool      show_tables,
                                          my_bool      show_views)
 {
-  MYSQL *mysql= &stmt->dbc->mysql;
+  MYSQL *mysql= stmt->dbc->mysql;
   /** the buffer size should count possible escapes */
   char buff[300+8*NAME_CHAR_LEN], *to;
   my_bool clause_added= FALSE;
@@ -242,7 +242,7 @@ static MYSQL_RES *table_status_i_s(STMT        *stmt,
   @param[in] wildcard       Whether the table name is a wildcard
 
   @return Result of SHOW TABLE STATUS, or NULL if there is an error
-          or empty result (check mysql_errno(&stmt->dbc->mysql) != 0)
+          or empty result (check mysql_errno(stmt->dbc->mysql) != 0)
 */
 MYSQL_RES *table_status(STMT        *stmt,
                         SQLCHAR     *catalog_name,
@@ -292,7 +292,7 @@ int add_name_condition_oa_id(HSTMT hstmt, char ** pos, SQLCHAR * name,
       *pos= myodbc_stpmov(*pos, "= BINARY ");
 
     *pos= myodbc_stpmov(*pos, "'");
-    *pos+= mysql_real_escape_string(&stmt->dbc->mysql, *pos, (char *)name, name_len);
+    *pos+= mysql_real_escape_string(stmt->dbc->mysql, *pos, (char *)name, name_len);
     *pos= myodbc_stpmov(*pos, "' ");
   }
   else
@@ -336,7 +336,7 @@ int add_name_condition_pv_id(HSTMT hstmt, char ** pos, SQLCHAR * name,
       *pos= myodbc_stpmov(*pos, " LIKE BINARY ");
 
     *pos= myodbc_stpmov(*pos, "'");
-    *pos+= mysql_real_escape_string(&stmt->dbc->mysql, *pos, (char *)name, name_len);
+    *pos+= mysql_real_escape_string(stmt->dbc->mysql, *pos, (char *)name, name_len);
     *pos= myodbc_stpmov(*pos, "' ");
   }
   else
@@ -381,6 +381,7 @@ MySQLTables(SQLHSTMT hstmt,
 {
   STMT *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt, MYSQL_RESET);
 
@@ -457,6 +458,7 @@ MySQLColumns(SQLHSTMT hstmt, SQLCHAR *catalog_name, SQLSMALLINT catalog_len,
 {
   STMT *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt, MYSQL_RESET);
 
@@ -523,6 +525,7 @@ MySQLStatistics(SQLHSTMT hstmt,
 {
   STMT *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -560,7 +563,7 @@ SQLRETURN list_table_priv_i_s(SQLHSTMT    hstmt,
                               SQLSMALLINT table_len)
 {
   STMT *stmt=(STMT *) hstmt;
-  MYSQL *mysql= &stmt->dbc->mysql;
+  MYSQL *mysql= stmt->dbc->mysql;
   char   buff[300+6*NAME_LEN+1], *pos;
   SQLRETURN rc;
 
@@ -604,6 +607,7 @@ MySQLTablePrivileges(SQLHSTMT hstmt,
 {
     STMT     *stmt= (STMT *)hstmt;
 
+    CHECK_ASYNC(stmt);
     CLEAR_STMT_ERROR(hstmt);
     my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -640,7 +644,7 @@ static SQLRETURN list_column_priv_i_s(HSTMT *     hstmt,
                                       SQLSMALLINT column_len)
 {
   STMT *stmt=(STMT *) hstmt;
-  MYSQL *mysql= &stmt->dbc->mysql;
+  MYSQL *mysql= stmt->dbc->mysql;
   /* 3 names theorethically can have all their characters escaped - thus 6*NAME_LEN  */
   char   buff[400+6*NAME_LEN+1], *pos;
   SQLRETURN rc;
@@ -686,6 +690,7 @@ MySQLColumnPrivileges(SQLHSTMT hstmt,
 {
   STMT     *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -751,6 +756,7 @@ MySQLSpecialColumns(SQLHSTMT hstmt, SQLUSMALLINT fColType,
 {
   STMT        *stmt=(STMT *) hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -808,6 +814,7 @@ MySQLPrimaryKeys(SQLHSTMT hstmt,
 {
   STMT *stmt= (STMT *) hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -848,7 +855,7 @@ SQLRETURN foreign_keys_i_s(SQLHSTMT hstmt,
                            SQLSMALLINT fk_table_len)
 {
   STMT *stmt=(STMT *) hstmt;
-  MYSQL *mysql= &stmt->dbc->mysql;
+  MYSQL *mysql= stmt->dbc->mysql;
   char query[3062], *buff; /* This should be big enough. */
   char *update_rule, *delete_rule, *ref_constraints_join;
   SQLRETURN rc;
@@ -856,7 +863,7 @@ SQLRETURN foreign_keys_i_s(SQLHSTMT hstmt,
   /*
      With 5.1, we can use REFERENTIAL_CONSTRAINTS to get even more info.
   */
-  if (is_minimum_version(stmt->dbc->mysql.server_version, "5.1"))
+  if (is_minimum_version(stmt->dbc->mysql->server_version, "5.1"))
   {
     update_rule= "CASE"
                  " WHEN R.UPDATE_RULE = 'CASCADE' THEN 0"
@@ -1013,6 +1020,7 @@ MySQLForeignKeys(SQLHSTMT hstmt,
 {
     STMT *stmt=(STMT *) hstmt;
 
+    CHECK_ASYNC(stmt);
     CLEAR_STMT_ERROR(hstmt);
     my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -1069,6 +1077,7 @@ MySQLProcedures(SQLHSTMT hstmt,
   SQLRETURN rc;
   STMT *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
@@ -1215,6 +1224,7 @@ MySQLProcedureColumns(SQLHSTMT hstmt,
 {
   STMT *stmt= (STMT *)hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(hstmt);
   my_SQLFreeStmt(hstmt,MYSQL_RESET);
 
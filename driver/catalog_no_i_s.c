@@ -106,7 +106,7 @@ static MYSQL_RES *server_list_dbkeys(STMT *stmt,
                                      SQLSMALLINT table_len)
 {
     DBC   *dbc = stmt->dbc;
-    MYSQL *mysql= &dbc->mysql;
+    MYSQL *mysql= dbc->mysql;
     char  buff[255 + 4 * NAME_LEN], *to;
 
     to= myodbc_stpmov(buff, "SHOW KEYS FROM `");
@@ -127,6 +127,264 @@ static MYSQL_RES *server_list_dbkeys(STMT *stmt,
 }
 
 
+/*
+  Keys of tables are kept by the connection for KEY_CACHE_TTL seconds, so
+  that positioned operations and catalog functions do not read them again
+  for each statement. They are dropped when DDL is executed on the
+  connection.
+*/
+
+/* Makes the cache entry of the SHOW KEYS result, NULL if out of memory */
+static TABLE_KEYS *table_keys_new(MYSQL_RES *res, const char *db,
+                                  const char *table)
+{
+  TABLE_KEYS    *keys;
+  MYSQL_ROW     row;
+  unsigned long *lengths;
+  size_t        size;
+  char          *pos, **to;
+  uint          i;
+
+  size= sizeof(TABLE_KEYS) + strlen(db) + strlen(table) + 2 +
+        sizeof(char *) * TABLE_KEYS_FIELDS * (size_t)res->row_count;
+
+  while ((row= mysql_fetch_row(res)))
+  {
+    lengths= mysql_fetch_lengths(res);
+    for (i= 0; i < TABLE_KEYS_FIELDS; ++i)
+    {
+      if (row[i])
+        size+= lengths[i] + 1;
+    }
+  }
+
+  if (!(keys= (TABLE_KEYS *)myodbc_malloc(size, MYF(0))))
+    return NULL;
+
+  keys->list.data= keys;
+  keys->size= size;
+  keys->row_count= (uint)res->row_count;
+  keys->rows= (char **)(keys + 1);
+
+  pos= (char *)(keys->rows + TABLE_KEYS_FIELDS * keys->row_count);
+  keys->db= pos;
+  pos= myodbc_stpmov(pos, db) + 1;
+  keys->table= pos;
+  pos= myodbc_stpmov(pos, table) + 1;
+
+  mysql_data_seek(res, 0);
+  for (to= keys->rows; (row= mysql_fetch_row(res)); )
+  {
+    lengths= mysql_fetch_lengths(res);
+    for (i= 0; i < TABLE_KEYS_FIELDS; ++i, ++to)
+    {
+      if (row[i])
+      {
+        *to= pos;
+        memcpy(pos, row[i], lengths[i]);
+        pos+= lengths[i];
+        *pos++= '\0';
+      }
+      else
+        *to= NULL;
+    }
+  }
+
+  return keys;
+}
+
+
+/* Copies the entry, pointing into the block of the copy */
+static TABLE_KEYS *table_keys_copy(const TABLE_KEYS *keys)
+{
+  TABLE_KEYS *copy;
+  uint       i;
+
+  if (!(copy= (TABLE_KEYS *)myodbc_malloc(keys->size, MYF(0))))
+    return NULL;
+
+  memcpy(copy, keys, keys->size);
+
+  copy->list.data= copy;
+  copy->db= (char *)copy + (keys->db - (char *)keys);
+  copy->table= (char *)copy + (keys->table - (char *)keys);
+  copy->rows= (char **)(copy + 1);
+
+  for (i= 0; i < TABLE_KEYS_FIELDS * keys->row_count; ++i)
+  {
+    if (keys->rows[i])
+      copy->rows[i]= (char *)copy + (keys->rows[i] - (char *)keys);
+  }
+
+  return copy;
+}
+
+
+/*
+  Returns the keys of the table, the cached ones if they were read less than
+  KEY_CACHE_TTL seconds ago. The database is the current one if db_len is 0,
+  then the keys are read by the server in whatever database the session
+  has, USE included, and are not cached. The caller frees the result with
+  x_free(). Returns NULL if there is an error, which is set for the
+  statement.
+*/
+TABLE_KEYS *table_keys_get(STMT *stmt, const char *db, uint db_len,
+                           const char *table, uint table_len)
+{
+  DBC         *dbc= stmt->dbc;
+  TABLE_KEYS  *keys, *found= NULL, *evicted= NULL;
+  LIST        *element, *next, *stale= NULL;
+  MYSQL_RES   *res;
+  char        db_name[NAME_LEN + 1], table_name[NAME_LEN + 1];
+  uint        ttl= dbc->ds->key_cache_ttl;
+  time_t      now= time(NULL);
+
+  /* dbc->database is not used for the current one, it misses USE */
+  strmake(db_name, db_len ? db : "", myodbc_min(db_len, NAME_LEN));
+  strmake(table_name, table, myodbc_min(table_len, NAME_LEN));
+
+  if (ttl && db_name[0])
+  {
+    myodbc_mutex_lock(&dbc->key_cache_lock);
+
+    for (element= dbc->key_cache; element; element= next)
+    {
+      next= element->next;
+      keys= (TABLE_KEYS *)element->data;
+
+      if (keys->expires <= now)
+      {
+        dbc->key_cache= list_delete(dbc->key_cache, element);
+        --dbc->key_cache_count;
+        stale= list_add(stale, element);
+      }
+      else if (found == NULL && !strcmp(keys->table, table_name)
+            && !strcmp(keys->db, db_name))
+      {
+        /* Most recently used first */
+        dbc->key_cache= list_delete(dbc->key_cache, element);
+        dbc->key_cache= list_add(dbc->key_cache, element);
+        found= table_keys_copy(keys);
+      }
+    }
+
+    myodbc_mutex_unlock(&dbc->key_cache_lock);
+
+    for (element= stale; element; element= next)
+    {
+      next= element->next;
+      x_free(element->data);
+    }
+
+    if (found)
+    {
+      return found;
+    }
+  }
+
+  myodbc_mutex_lock(&dbc->lock);
+  if (!(res= server_list_dbkeys(stmt, (SQLCHAR *)db_name,
+                                (SQLSMALLINT)strlen(db_name),
+                                (SQLCHAR *)table_name,
+                                (SQLSMALLINT)strlen(table_name))))
+  {
+    handle_connection_error(stmt);
+    myodbc_mutex_unlock(&dbc->lock);
+    return NULL;
+  }
+  myodbc_mutex_unlock(&dbc->lock);
+
+  keys= table_keys_new(res, db_name, table_name);
+  mysql_free_result(res);
+
+  if (!keys)
+  {
+    set_mem_error(dbc->mysql);
+    handle_connection_error(stmt);
+    return NULL;
+  }
+
+  /* The cache gets the copy, the caller frees what it has been given */
+  if (ttl && db_name[0] && (found= table_keys_copy(keys)))
+  {
+    found->expires= now + (time_t)ttl;
+
+    myodbc_mutex_lock(&dbc->key_cache_lock);
+
+    dbc->key_cache= list_add(dbc->key_cache, &found->list);
+
+    if (++dbc->key_cache_count > KEY_CACHE_SIZE)
+    {
+      for (element= dbc->key_cache; element->next; element= element->next);
+
+      dbc->key_cache= list_delete(dbc->key_cache, element);
+      --dbc->key_cache_count;
+      evicted= (TABLE_KEYS *)element->data;
+    }
+
+    myodbc_mutex_unlock(&dbc->key_cache_lock);
+
+    x_free(evicted);
+  }
+
+  return keys;
+}
+
+
+/*
+  Drops the keys cached by the connection. Done when they may have become
+  out of date, or the connection is about to be closed.
+*/
+void key_cache_free(DBC *dbc)
+{
+  LIST *element, *next, *cache;
+
+  myodbc_mutex_lock(&dbc->key_cache_lock);
+  cache= dbc->key_cache;
+  dbc->key_cache= NULL;
+  dbc->key_cache_count= 0;
+  myodbc_mutex_unlock(&dbc->key_cache_lock);
+
+  for (element= cache; element; element= next)
+  {
+    next= element->next;
+    x_free(element->data);
+  }
+}
+
+
+/*
+  Makes the fake result of the rows, that point to table keys. The values
+  are copied to the statement, so that keys can be freed.
+*/
+static SQLRETURN table_keys_resultset(STMT *stmt, char **data, uint row_count,
+                                      MYSQL_FIELD *fields, uint field_count)
+{
+  SQLRETURN rc;
+  uint      i;
+
+  /* data has room for one row at least, even if there are none */
+  rc= create_fake_resultset(stmt, data, sizeof(char *) * field_count *
+                                        myodbc_max(row_count, 1),
+                            row_count, fields, field_count);
+  if (!SQL_SUCCEEDED(rc))
+    return rc;
+
+  for (i= 0; i < row_count * field_count; ++i)
+  {
+    if (stmt->result_array[i] &&
+        !(stmt->result_array[i]= strdup_root(&stmt->alloc_root,
+                                             stmt->result_array[i])))
+    {
+      set_mem_error(stmt->dbc->mysql);
+      return handle_connection_error(stmt);
+    }
+  }
+
+  return SQL_SUCCESS;
+}
+
+
 /*
 ****************************************************************************
 SQLColumns
@@ -188,7 +446,7 @@ server_list_dbcolumns(STMT *stmt,
                       SQLCHAR *szColumn, SQLSMALLINT cbColumn)
 {
   DBC *dbc= stmt->dbc;
-  MYSQL *mysql= &dbc->mysql;
+  MYSQL *mysql;
   MYSQL_RES *result;
   char buff[NAME_LEN * 2 + 64], column_buff[NAME_LEN * 2 + 64];
 
@@ -202,6 +460,7 @@ server_list_dbcolumns(STMT *stmt,
     /* reget_current_catalog locks and release mutex, so locking
        here again */
     myodbc_mutex_lock(&dbc->lock);
+    mysql= readahead_yield(dbc);
 
     strncpy(buff, szCatalog, cbCatalog);
     buff[cbCatalog]= '\0';
@@ -213,7 +472,10 @@ server_list_dbcolumns(STMT *stmt,
     }
   }
   else
+  {
     myodbc_mutex_lock(&dbc->lock);
+    mysql= readahead_yield(dbc);
+  }
 
   strncpy(buff, szTable, cbTable);
   buff[cbTable]= '\0';
@@ -277,7 +539,7 @@ columns_no_i_s(STMT * stmt, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
   res= table_status(stmt, szCatalog, cbCatalog, szTable, cbTable, TRUE,
                     TRUE, TRUE);
 
-  if (!res && mysql_errno(&stmt->dbc->mysql))
+  if (!res && mysql_errno(stmt->dbc->mysql))
   {
     SQLRETURN rc= handle_connection_error(stmt);
     myodbc_mutex_unlock(&stmt->dbc->lock);
@@ -327,7 +589,7 @@ columns_no_i_s(STMT * stmt, SQLCHAR *szCatalog, SQLSMALLINT cbCatalog,
                                             MYF(MY_ALLOW_ZERO_PTR));
     if (!stmt->result_array)
     {
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
@@ -529,7 +791,7 @@ static MYSQL_RES *table_privs_raw_data( STMT *      stmt,
                                         SQLSMALLINT table_len)
 {
   DBC *dbc= stmt->dbc;
-  MYSQL *mysql= &dbc->mysql;
+  MYSQL *mysql= dbc->mysql;
   char   buff[255+2*NAME_LEN+1], *pos;
 
   pos= strxmov(buff,
@@ -619,7 +881,7 @@ list_table_priv_no_i_s(SQLHSTMT hstmt,
 
     if (!stmt->result_array)
     {
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
@@ -680,7 +942,7 @@ static MYSQL_RES *column_privs_raw_data(STMT *      stmt,
                                         SQLSMALLINT column_len)
 {
   DBC   *dbc = stmt->dbc;
-  MYSQL *mysql = &dbc->mysql;
+  MYSQL *mysql = dbc->mysql;
 
   char buff[400+6*NAME_LEN+1], *pos;
 
@@ -772,7 +1034,7 @@ list_column_priv_no_i_s(SQLHSTMT hstmt,
     MYF(MY_ZEROFILL));
   if (!stmt->result_array)
   {
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
   alloc= &stmt->alloc_root;
@@ -824,7 +1086,7 @@ Lengths may not be SQL_NTS.
 @param[in] wildcard       Whether the table name is a wildcard
 
 @return Result of SHOW TABLE STATUS, or NULL if there is an error
-or empty result (check mysql_errno(&stmt->dbc->mysql) != 0)
+or empty result (check mysql_errno(stmt->dbc->mysql) != 0)
 */
 MYSQL_RES *table_status_no_i_s(STMT        *stmt,
                                SQLCHAR     *catalog,
@@ -833,7 +1095,7 @@ MYSQL_RES *table_status_no_i_s(STMT        *stmt,
                                SQLSMALLINT  table_length,
                                my_bool      wildcard)
 {
-	MYSQL *mysql= &stmt->dbc->mysql;
+	MYSQL *mysql= stmt->dbc->mysql;
 	/** @todo determine real size for buffer */
 	char buff[36 + 4*NAME_LEN + 1], *to;
 
@@ -889,7 +1151,7 @@ Lengths may not be SQL_NTS.
 @param[in] table_length   Length of table name
 
 @return Result of SHOW CREATE TABLE , or NULL if there is an error
-or empty result (check mysql_errno(&stmt->dbc->mysql) != 0)
+or empty result (check mysql_errno(stmt->dbc->mysql) != 0)
 */
 MYSQL_RES *server_show_create_table(STMT        *stmt,
                                     SQLCHAR     *catalog,
@@ -897,7 +1159,7 @@ MYSQL_RES *server_show_create_table(STMT        *stmt,
                                     SQLCHAR     *table,
                                     SQLSMALLINT  table_length)
 {
-  MYSQL *mysql= &stmt->dbc->mysql;
+  MYSQL *mysql= stmt->dbc->mysql;
   /** @todo determine real size for buffer */
   char buff[36 + 4*NAME_LEN + 1], *to;
 
@@ -924,7 +1186,8 @@ MYSQL_RES *server_show_create_table(STMT        *stmt,
 
   assert(to - buff < sizeof(buff));
 
-  if (mysql_real_query(mysql,buff,(unsigned long)(to - buff)))
+  if (mysql_real_query(readahead_yield(stmt->dbc), buff,
+                       (unsigned long)(to - buff)))
   {
     return NULL;
   }
@@ -1091,7 +1354,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
   char      **data= NULL;
   /* We need this array for the cases if key count is greater than 18 */
   char      **tempdata= NULL;
-  char      buffer[NAME_LEN + 1];
+  char      buffer[NAME_LEN + 1], catalog_buff[NAME_LEN + 1];
   unsigned int index= 0;
   DYNAMIC_ARRAY records;
   MY_FOREIGN_KEY_FIELD *fkRows= NULL;
@@ -1104,7 +1367,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
   myodbc_mutex_lock(&stmt->dbc->lock);
   local_res= table_status(stmt, szFkCatalogName, cbFkCatalogName, szFkTableName, 
                     cbFkTableName, FALSE, TRUE, TRUE);
-  if (!local_res && mysql_errno(&stmt->dbc->mysql))
+  if (!local_res && mysql_errno(stmt->dbc->mysql))
   {
     rc= handle_connection_error(stmt);
     goto unlock_and_free;
@@ -1129,7 +1392,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
 
     if (!stmt->result)
     {
-      if (mysql_errno(&stmt->dbc->mysql))
+      if (mysql_errno(stmt->dbc->mysql))
       {
         rc= handle_connection_error(stmt);
         goto unlock_and_free;
@@ -1249,12 +1512,12 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
                     myodbc_stpmov(fkRows->FKTABLE_NAME, row[0]);
                     myodbc_stpmov(fkRows->FKTABLE_CAT, (szFkCatalogName ?
                             strdup_root(alloc, (char *)szFkCatalogName) :
-                            strdup_root(alloc, stmt->dbc->database ?
-                            stmt->dbc->database : "null")));
+                            strdup_root(alloc, current_catalog_copy(stmt->dbc,
+                            catalog_buff, "null"))));
                     myodbc_stpmov(fkRows->PKTABLE_CAT, (szPkCatalogName ?
                             strdup_root(alloc, (char *)szPkCatalogName) :
-                            strdup_root(alloc, stmt->dbc->database ?
-                            stmt->dbc->database : "null")));
+                            strdup_root(alloc, current_catalog_copy(stmt->dbc,
+                            catalog_buff, "null"))));
                     /* key_seq incremented once for each PK column */
                     fkRows->KEY_SEQ= ++key_seq;
                   }
@@ -1278,12 +1541,12 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
                     myodbc_stpmov(fkRows->FKTABLE_NAME, row[0]);
                     myodbc_stpmov(fkRows->FKTABLE_CAT, (szFkCatalogName ?
                             strdup_root(alloc, (char *)szFkCatalogName) :
-                            strdup_root(alloc, stmt->dbc->database ?
-                            stmt->dbc->database : "null")));
+                            strdup_root(alloc, current_catalog_copy(stmt->dbc,
+                            catalog_buff, "null"))));
                     myodbc_stpmov(fkRows->PKTABLE_CAT, (szPkCatalogName ?
                             strdup_root(alloc, (char *)szPkCatalogName) :
-                            strdup_root(alloc, stmt->dbc->database ?
-                            stmt->dbc->database : "null")));
+                            strdup_root(alloc, current_catalog_copy(stmt->dbc,
+                            catalog_buff, "null"))));
                     /* key_seq incremented once for each PK column */
                     fkRows->KEY_SEQ= ++key_seq;
                   }
@@ -1383,7 +1646,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
                                          MYF(MY_ZEROFILL));
     if (!tempdata)
     {
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       rc= handle_connection_error(stmt);
       goto free_and_return;
     }
@@ -1443,7 +1706,7 @@ SQLRETURN foreign_keys_no_i_s(SQLHSTMT hstmt,
 
   if (!stmt->result_array)
   {
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
 
@@ -1504,8 +1767,6 @@ MYSQL_FIELD SQLPRIM_KEYS_fields[]=
 
 const uint SQLPRIM_KEYS_FIELDS= array_elements(SQLPRIM_KEYS_fields);
 
-const long SQLPRIM_LENGTHS[]= {0, 0, 1, 5, 4, -7};
-
 char *SQLPRIM_KEYS_values[]= {
     NULL,"",NULL,NULL,0,NULL
 };
@@ -1524,63 +1785,52 @@ primary_keys_no_i_s(SQLHSTMT hstmt,
                     SQLSMALLINT schema_len __attribute__((unused)),
                     SQLCHAR *table, SQLSMALLINT table_len)
 {
-    STMT *stmt= (STMT *) hstmt;
-    MYSQL_ROW row;
-    char      **data;
-    uint      row_count;
-
-    myodbc_mutex_lock(&stmt->dbc->lock);
-    if (!(stmt->result= server_list_dbkeys(stmt, catalog, catalog_len,
-                                           table, table_len)))
-    {
-      SQLRETURN rc= handle_connection_error(stmt);
-      myodbc_mutex_unlock(&stmt->dbc->lock);
-      return rc;
-    }
-    myodbc_mutex_unlock(&stmt->dbc->lock);
-    stmt->result_array= (char**) myodbc_malloc(sizeof(char*)*SQLPRIM_KEYS_FIELDS*
-                                            (ulong) stmt->result->row_count,
-                                            MYF(MY_ZEROFILL));
-    if (!stmt->result_array)
+    STMT       *stmt= (STMT *) hstmt;
+    TABLE_KEYS *keys;
+    char       **row, **data, **to;
+    uint       i, row_count;
+    SQLRETURN  rc;
+
+    if (!(keys= table_keys_get(stmt, (char *)catalog, catalog_len,
+                               (char *)table, table_len)))
+      return SQL_ERROR;
+
+    data= (char **)myodbc_malloc(sizeof(char *) * SQLPRIM_KEYS_FIELDS *
+                                 myodbc_max(keys->row_count, 1),
+                                 MYF(MY_ZEROFILL));
+    if (!data)
     {
-      set_mem_error(&stmt->dbc->mysql);
-      return handle_connection_error(stmt);
-    }
-
-    stmt->lengths= (unsigned long*) myodbc_malloc( sizeof(long)*SQLPRIM_KEYS_FIELDS*
-                                            (ulong) stmt->result->row_count,
-                                            MYF(MY_ZEROFILL));
-    if (!stmt->lengths)
-    {
-      set_mem_error(&stmt->dbc->mysql);
+      x_free(keys);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
     row_count= 0;
-    data= stmt->result_array;
-    while ( (row= mysql_fetch_row(stmt->result)) )
+    to= data;
+    for (i= 0, row= keys->rows; i < keys->row_count;
+         ++i, row+= TABLE_KEYS_FIELDS)
     {
         if ( row[1][0] == '0' )     /* If unique index */
         {
             if ( row_count && !strcmp(row[3],"1") )
                 break;    /* Already found unique key */
 
-            fix_row_lengths(stmt, SQLPRIM_LENGTHS, row_count, SQLPRIM_KEYS_FIELDS);
-
             ++row_count;
-            data[0]= data[1]=0;
-            data[2]= row[0];
-            data[3]= row[4];
-            data[4]= row[3];
-            data[5]= "PRIMARY";
-            data+= SQLPRIM_KEYS_FIELDS;
+            to[0]= to[1]=0;
+            to[2]= row[0];
+            to[3]= row[4];
+            to[4]= row[3];
+            to[5]= "PRIMARY";
+            to+= SQLPRIM_KEYS_FIELDS;
         }
     }
 
-    set_row_count(stmt, row_count);
-    myodbc_link_fields(stmt,SQLPRIM_KEYS_fields,SQLPRIM_KEYS_FIELDS);
+    rc= table_keys_resultset(stmt, data, row_count, SQLPRIM_KEYS_fields,
+                             SQLPRIM_KEYS_FIELDS);
+    x_free(data);
+    x_free(keys);
 
-    return SQL_SUCCESS;
+    return rc;
 }
 
 
@@ -1636,7 +1886,7 @@ static MYSQL_RES *server_list_proc_params(STMT *stmt,
                                           SQLSMALLINT proc_name_len)
 {
   DBC   *dbc = stmt->dbc;
-  MYSQL *mysql= &dbc->mysql;
+  MYSQL *mysql= dbc->mysql;
   char   buff[255+4*NAME_LEN+1], *pos;
 
   pos= myodbc_stpmov(buff, "SELECT name, CONCAT(IF(length(returns)>0, CONCAT('RETURN_VALUE ', returns, if(length(param_list)>0, ',', '')),''), param_list),"
@@ -1742,7 +1992,7 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
   if (params_r == NULL)
   {
     dynstr_free(&dynQuery);
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
 
@@ -1754,8 +2004,8 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
   {
     myodbc_mutex_unlock(&stmt->dbc->lock);
 
-    nReturn= set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                      mysql_errno(&stmt->dbc->mysql));
+    nReturn= set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+                      mysql_errno(stmt->dbc->mysql));
     goto clean_exit;
   }
 
@@ -1810,7 +2060,7 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
 
       if (data ==  NULL)
       {
-        set_mem_error(&stmt->dbc->mysql);
+        set_mem_error(stmt->dbc->mysql);
         nReturn= handle_connection_error(stmt);
         goto exit_with_free;
       }
@@ -1929,7 +2179,7 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
 
         if (new_elem == NULL)
         {
-          set_mem_error(&stmt->dbc->mysql);
+          set_mem_error(stmt->dbc->mysql);
           nReturn= handle_connection_error(stmt);
           goto exit_with_free;
         }
@@ -1951,12 +2201,12 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
   {
     myodbc_mutex_lock(&stmt->dbc->lock);
     if (exec_stmt_query(stmt, dynQuery.str, (unsigned long)dynQuery.length, FALSE) ||
-        !(columns_res= mysql_store_result(&stmt->dbc->mysql)))
+        !(columns_res= mysql_store_result(stmt->dbc->mysql)))
     {
       myodbc_mutex_unlock(&stmt->dbc->lock);
 
-      nReturn= set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                mysql_errno(&stmt->dbc->mysql));
+      nReturn= set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+                mysql_errno(stmt->dbc->mysql));
       goto exit_with_free;
     }
 
@@ -1967,8 +2217,8 @@ procedure_columns_no_i_s(SQLHSTMT hstmt,
 
     if (row == NULL)
     {
-      nReturn= set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                mysql_errno(&stmt->dbc->mysql));
+      nReturn= set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+                mysql_errno(stmt->dbc->mysql));
       goto exit_with_free;
     }
 
@@ -2132,7 +2382,7 @@ special_columns_no_i_s(SQLHSTMT hstmt, SQLUSMALLINT fColType,
         if ( !(stmt->result_array= (char**) myodbc_malloc(sizeof(char*)*SQLSPECIALCOLUMNS_FIELDS*
                                                       result->field_count, MYF(MY_ZEROFILL))) )
         {
-          set_mem_error(&stmt->dbc->mysql);
+          set_mem_error(stmt->dbc->mysql);
           return handle_connection_error(stmt);
         }
 
@@ -2213,7 +2463,7 @@ special_columns_no_i_s(SQLHSTMT hstmt, SQLUSMALLINT fColType,
     if ( !(stmt->result_array= (char**) myodbc_malloc(sizeof(char*)*SQLSPECIALCOLUMNS_FIELDS*
                                                   result->field_count, MYF(MY_ZEROFILL))) )
     {
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
@@ -2309,65 +2559,61 @@ statistics_no_i_s(SQLHSTMT hstmt,
                   SQLUSMALLINT fUnique,
                   SQLUSMALLINT fAccuracy __attribute__((unused)))
 {
-    STMT *stmt= (STMT *)hstmt;
-    MYSQL *mysql= &stmt->dbc->mysql;
-    DBC *dbc= stmt->dbc;
+    STMT       *stmt= (STMT *)hstmt;
+    TABLE_KEYS *keys;
+    char       **row, **data, **to;
+    char       catalog_name[NAME_LEN + 1];
+    uint       i, j, row_count;
+    SQLRETURN  rc;
 
     if (!table_len)
         goto empty_set;
 
-    myodbc_mutex_lock(&dbc->lock);
-    stmt->result= server_list_dbkeys(stmt, catalog, catalog_len,
-                                     table, table_len);
-    if (!stmt->result)
-    {
-      SQLRETURN rc= handle_connection_error(stmt);
-      myodbc_mutex_unlock(&dbc->lock);
-      return rc;
-    }
-    myodbc_mutex_unlock(&dbc->lock);
-    my_int2str(SQL_INDEX_OTHER,SS_type,10,0);
-    stmt->order=       SQLSTAT_order;
-    stmt->order_count= array_elements(SQLSTAT_order);
-    stmt->fix_fields=  fix_fields_copy;
-    stmt->array= (MYSQL_ROW) myodbc_memdup((char *)SQLSTAT_values,
-                                       sizeof(SQLSTAT_values),MYF(0));
-    if (!stmt->array)
+    if (!(keys= table_keys_get(stmt, (char *)catalog, catalog_len,
+                               (char *)table, table_len)))
+      return SQL_ERROR;
+
+    data= (char **)myodbc_malloc(sizeof(char *) * SQLSTAT_FIELDS *
+                                 myodbc_max(keys->row_count, 1), MYF(0));
+    if (!data)
     {
-      set_mem_error(&stmt->dbc->mysql);
+      x_free(keys);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
+    my_int2str(SQL_INDEX_OTHER,SS_type,10,0);
+
     if (stmt->dbc->ds->no_catalog)
-      stmt->array[0]= "";
+      catalog_name[0]= '\0';
     else
-      stmt->array[0]= strmake_root(&stmt->alloc_root,
-                                   (char *)catalog, catalog_len);
+      strmake(catalog_name, (char *)catalog,
+              myodbc_min(catalog_len, NAME_LEN));
 
-    if ( fUnique == SQL_INDEX_UNIQUE )
+    row_count= 0;
+    to= data;
+    for (i= 0, row= keys->rows; i < keys->row_count;
+         ++i, row+= TABLE_KEYS_FIELDS)
     {
-        /* This is too low level... */
-        MYSQL_ROWS **prev,*pos;
-        prev= &stmt->result->data->data;
-        for ( pos= *prev; pos; pos= pos->next )
-        {
-            if ( pos->data[1][0] == '0' ) /* Unlink nonunique index */
-            {
-                (*prev)=pos;
-                prev= &pos->next;
-            }
-            else
-            {
-                --stmt->result->row_count;
-            }
-        }
-        (*prev)= 0;
-        mysql_data_seek(stmt->result,0);  /* Restore pointer */
+        /* Skip nonunique indexes if only unique ones are asked for */
+        if ( fUnique == SQL_INDEX_UNIQUE && row[1][0] != '0' )
+            continue;
+
+        memcpy(to, SQLSTAT_values, sizeof(SQLSTAT_values));
+        to[0]= catalog_name;
+        for (j= 0; j < array_elements(SQLSTAT_order); ++j)
+            to[SQLSTAT_order[j]]= row[j];
+
+        ++row_count;
+        to+= SQLSTAT_FIELDS;
     }
 
-    set_row_count(stmt, stmt->result->row_count);
-    myodbc_link_fields(stmt,SQLSTAT_fields,SQLSTAT_FIELDS);
-    return SQL_SUCCESS;
+    rc= table_keys_resultset(stmt, data, row_count, SQLSTAT_fields,
+                             SQLSTAT_FIELDS);
+    x_free(data);
+    x_free(keys);
+
+    return rc;
 
 empty_set:
   return create_empty_fake_resultset(stmt, SQLSTAT_values,
@@ -2437,12 +2683,12 @@ tables_no_i_s(SQLHSTMT hstmt,
       {
         char buff[32 + NAME_LEN * 2], *to;
         to= myodbc_stpmov(buff, "SHOW DATABASES LIKE '");
-        to+= mysql_real_escape_string(&stmt->dbc->mysql, to,
+        to+= mysql_real_escape_string(stmt->dbc->mysql, to,
                                       (char *)catalog, catalog_len);
         to= myodbc_stpmov(to, "'");
         MYLOG_QUERY(stmt, buff);
-        if (!mysql_query(&stmt->dbc->mysql, buff))
-          catalog_res= mysql_store_result(&stmt->dbc->mysql);
+        if (!mysql_query(readahead_yield(stmt->dbc), buff))
+          catalog_res= mysql_store_result(stmt->dbc->mysql);
       }
       myodbc_mutex_unlock(&stmt->dbc->lock);
 
@@ -2473,7 +2719,7 @@ tables_no_i_s(SQLHSTMT hstmt,
       stmt->result= catalog_res;
       if (!stmt->array)
       {
-        set_mem_error(&stmt->dbc->mysql);
+        set_mem_error(stmt->dbc->mysql);
         return handle_connection_error(stmt);
       }
       myodbc_link_fields(stmt, SQLTABLES_fields, SQLTABLES_FIELDS);
@@ -2572,10 +2818,10 @@ tables_no_i_s(SQLHSTMT hstmt,
                                      user_tables, views);
         }
 
-        if (!stmt->result && mysql_errno(&stmt->dbc->mysql))
+        if (!stmt->result && mysql_errno(stmt->dbc->mysql))
         {
           /* unknown DB will return empty set from SQLTables */
-          switch (mysql_errno(&stmt->dbc->mysql))
+          switch (mysql_errno(stmt->dbc->mysql))
           {
           case ER_BAD_DB_ERROR:
             myodbc_mutex_unlock(&stmt->dbc->lock);
@@ -2611,7 +2857,7 @@ tables_no_i_s(SQLHSTMT hstmt,
                                        SQLTABLES_FIELDS * row_count,
                                        MYF(MY_ZEROFILL))))
           {
-            set_mem_error(&stmt->dbc->mysql);
+            set_mem_error(stmt->dbc->mysql);
             rc = handle_connection_error(stmt);
             goto free_and_return;
           }
@@ -2630,8 +2876,9 @@ tables_no_i_s(SQLHSTMT hstmt,
             {
               if (!reget_current_catalog(stmt->dbc))
               {
-                const char *dbname= stmt->dbc->database ? stmt->dbc->database
-                                                        : "null";
+                char dbname[NAME_LEN + 1];
+
+                current_catalog_copy(stmt->dbc, dbname, "null");
                 db= strmake_root(&stmt->alloc_root,
                                  dbname, strlen(dbname));
               }
@@ -31,6 +31,14 @@
 #include "installer.h"
 #include "stringutil.h"
 
+#include <sys/stat.h>
+
+#ifndef _WIN32
+# include <sys/socket.h>
+# include <netinet/in.h>
+# include <netinet/tcp.h>
+#endif
+
 #ifndef CLIENT_NO_SCHEMA
 # define CLIENT_NO_SCHEMA      16
 #endif
@@ -99,26 +107,27 @@ SQLRETURN myodbc_set_initial_character_set(DBC *dbc, const char *charset)
 
   if (charset && charset[0])
   {
-    if (mysql_set_character_set(&dbc->mysql, charset))
+    if (mysql_set_character_set(readahead_yield(dbc), charset))
     {
-      set_dbc_error(dbc, "HY000", mysql_error(&dbc->mysql),
-                    mysql_errno(&dbc->mysql));
+      set_dbc_error(dbc, "HY000", mysql_error(dbc->mysql),
+                    mysql_errno(dbc->mysql));
       return SQL_ERROR;
     }
   }
   else
   {
-    if (mysql_set_character_set(&dbc->mysql, dbc->ansi_charset_info->csname))
+    if (mysql_set_character_set(readahead_yield(dbc),
+                                dbc->ansi_charset_info->csname))
     {
-      set_dbc_error(dbc, "HY000", mysql_error(&dbc->mysql),
-                    mysql_errno(&dbc->mysql));
+      set_dbc_error(dbc, "HY000", mysql_error(dbc->mysql),
+                    mysql_errno(dbc->mysql));
       return SQL_ERROR;
     }
   }
 
   {
     MY_CHARSET_INFO my_charset;
-    mysql_get_character_set_info(&dbc->mysql, &my_charset);
+    mysql_get_character_set_info(dbc->mysql, &my_charset);
     dbc->cxn_charset_info= get_charset(my_charset.number, MYF(0));
   }
 
@@ -129,7 +138,7 @@ SQLRETURN myodbc_set_initial_character_set(DBC *dbc, const char *charset)
     We always set character_set_results to NULL so we can do our own
     conversion to the ANSI character set or Unicode.
   */
-  if (is_minimum_version(dbc->mysql.server_version, "4.1.1")
+  if (is_minimum_version(dbc->mysql->server_version, "4.1.1")
       && odbc_stmt(dbc, "SET character_set_results = NULL", SQL_NTS, TRUE) != SQL_SUCCESS)
   {
     return SQL_ERROR;
@@ -140,43 +149,90 @@ SQLRETURN myodbc_set_initial_character_set(DBC *dbc, const char *charset)
 
 
 /**
-  Try to establish a connection to a MySQL server based on the data source
-  configuration.
+  Turn TCP keepalive on for the connection, so that a peer gone without
+  closing the connection is found while it is idle.
 
-  @param[in]  dbc  Database connection
-  @param[in]  ds   Data source information
+  @param[in]  mysql  Connected client handle
+  @param[in]  idle   Seconds of idle time before the first probe, 0 to keep
+                     the system setting
+*/
+static void set_keepalive(MYSQL *mysql, unsigned int idle)
+{
+  int on= 1;
+
+  /* Named pipes and shared memory have no socket */
+  if (idle == 0 || mysql->net.fd == INVALID_SOCKET)
+    return;
+
+  setsockopt(mysql->net.fd, SOL_SOCKET, SO_KEEPALIVE, (char *)&on, sizeof(on));
+#if defined(TCP_KEEPIDLE)
+  setsockopt(mysql->net.fd, IPPROTO_TCP, TCP_KEEPIDLE, (char *)&idle,
+             sizeof(idle));
+#elif defined(TCP_KEEPALIVE)
+  setsockopt(mysql->net.fd, IPPROTO_TCP, TCP_KEEPALIVE, (char *)&idle,
+             sizeof(idle));
+#endif
+}
 
-  @return Standard SQLRETURN code. If it is @c SQL_SUCCESS or @c
-  SQL_SUCCESS_WITH_INFO, a connection has been established.
+
+/**
+  Connect again after the connection has been lost, so that a query can be
+  run once more. Session state the driver does not keep track of is lost,
+  as it is with AUTO_RECONNECT.
+
+  @param[in]  dbc  Connection handle
+
+  @return TRUE if the connection is there again
 */
-SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
+BOOL myodbc_reconnect(DBC *dbc)
 {
-  SQLRETURN rc= SQL_SUCCESS;
-  MYSQL *mysql= &dbc->mysql;
-  unsigned long flags;
-  /* Use 'int' and fill all bits to avoid alignment Bug#25920 */
-  unsigned int opt_ssl_verify_server_cert = ~0;
-  const my_bool on= 1;
-  unsigned long max_long = ~0L;
+  const my_bool on= 1, off= 0;
+  BOOL alive;
 
-#ifdef WIN32
-  /*
-   Detect if we are running with ADO present, and force on the
-   FLAG_COLUMN_SIZE_S32 option if we are.
-  */
-  if (GetModuleHandle("msado15.dll") != NULL)
-    ds->limit_column_size= 1;
+  mysql_options(dbc->mysql, MYSQL_OPT_RECONNECT, (char *)&on);
+  alive= !mysql_ping(readahead_yield(dbc));
+  if (!dbc->ds->auto_reconnect)
+  {
+    mysql_options(dbc->mysql, MYSQL_OPT_RECONNECT, (char *)&off);
+  }
 
-  /* Detect another problem specific to MS Access */
-  if (GetModuleHandle("msaccess.exe") != NULL)
-    ds->default_bigint_bind_str= 1;
-#endif
+  if (!alive)
+    return FALSE;
 
-  mysql_init(mysql);
+  set_keepalive(dbc->mysql, dbc->ds->tcp_keepalive);
+
+  /* The new session has the defaults, and none of the prepared statements */
+  dbc->sql_select_limit= (SQLULEN) -1;
+  dbc->max_execution_time= 0;
+  if (dbc->ssps_cache != NULL)
+  {
+    ssps_cache_free(dbc);
+  }
+
+  if (!dbc->ds->auto_increment_null_search &&
+      odbc_stmt(dbc, "SET SQL_AUTO_IS_NULL = 0", SQL_NTS, FALSE) != SQL_SUCCESS)
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
 
-  flags= get_client_flags(ds);
 
-  /* Set other connection options */
+/**
+  Set the options a connection to the data source is made with, including
+  the SSL and authentication ones.
+
+  @param[in]  dbc    Connection handle
+  @param[in]  mysql  Initialized, not yet connected, client handle
+  @param[in]  ds     Data source
+*/
+void myodbc_set_connect_options(DBC *dbc, MYSQL *mysql, DataSource *ds)
+{
+  /* Use 'int' and fill all bits to avoid alignment Bug#25920 */
+  unsigned int opt_ssl_verify_server_cert = ~0;
+  const my_bool on= 1;
+  unsigned long max_long = ~0L;
 
   if (ds->allow_big_results || ds->safe)
 #if MYSQL_VERSION_ID >= 50709
@@ -192,18 +248,6 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   if (ds->read_options_from_mycnf)
     mysql_options(mysql, MYSQL_READ_DEFAULT_GROUP, "odbc");
 
-  if (ds->initstmt && ds->initstmt[0])
-  {
-    /* Check for SET NAMES */
-    if (is_set_names_statement((SQLCHAR *)ds_get_utf8attr(ds->initstmt,
-                                                          &ds->initstmt8)))
-    {
-      return set_dbc_error(dbc, "HY000",
-                           "SET NAMES not allowed by driver", 0);
-    }
-    mysql_options(mysql, MYSQL_INIT_COMMAND, ds->initstmt8);
-  }
-
   if (dbc->login_timeout)
     mysql_options(mysql, MYSQL_OPT_CONNECT_TIMEOUT,
                   (char *)&dbc->login_timeout);
@@ -222,24 +266,22 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
 #if MYSQL_VERSION_ID >= 50507
   if (ds->plugin_dir)
   {
-    mysql_options(mysql, MYSQL_PLUGIN_DIR,
-                  ds_get_utf8attr(ds->plugin_dir, &ds->plugin_dir8));
+    mysql_options(mysql, MYSQL_PLUGIN_DIR, ds->plugin_dir8);
   }
 
   if (ds->default_auth)
   {
-    mysql_options(mysql, MYSQL_DEFAULT_AUTH,
-                  ds_get_utf8attr(ds->default_auth, &ds->default_auth8));
+    mysql_options(mysql, MYSQL_DEFAULT_AUTH, ds->default_auth8);
   }
 #endif
 
   /* set SSL parameters */
   mysql_ssl_set(mysql,
-                ds_get_utf8attr(ds->sslkey,    &ds->sslkey8),
-                ds_get_utf8attr(ds->sslcert,   &ds->sslcert8),
-                ds_get_utf8attr(ds->sslca,     &ds->sslca8),
-                ds_get_utf8attr(ds->sslcapath, &ds->sslcapath8),
-                ds_get_utf8attr(ds->sslcipher, &ds->sslcipher8));
+                (char *)ds->sslkey8,
+                (char *)ds->sslcert8,
+                (char *)ds->sslca8,
+                (char *)ds->sslcapath8,
+                (char *)ds->sslcipher8);
 
   if (ds->sslverify)
     mysql_options(mysql, MYSQL_OPT_SSL_VERIFY_SERVER_CERT,
@@ -248,8 +290,7 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   if (ds->rsakey)
   {
     /* Read the public key on the client side */
-    mysql_options(mysql, MYSQL_SERVER_PUBLIC_KEY,
-                  ds_get_utf8attr(ds->rsakey, &ds->rsakey8));
+    mysql_options(mysql, MYSQL_SERVER_PUBLIC_KEY, ds->rsakey8);
   }
 #endif
 #if MYSQL_VERSION_ID >= 50710
@@ -273,41 +314,6 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
 #endif
 
 
-  if (dbc->unicode)
-  {
-    /*
-      Get the ANSI charset info before we change connection to UTF-8.
-    */
-    MY_CHARSET_INFO my_charset;
-    mysql_get_character_set_info(&dbc->mysql, &my_charset);
-    dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
-    /*
-      We always use utf8 for the connection, and change it afterwards if needed.
-    */
-    mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8");
-    dbc->cxn_charset_info= utf8_charset_info;
-  }
-  else
-  {
-#ifdef _WIN32
-    char cpbuf[64];
-    const char *client_cs_name= NULL;
-
-    myodbc_snprintf(cpbuf, sizeof(cpbuf), "cp%u", GetACP());
-    client_cs_name= my_os_charset_to_mysql_charset(cpbuf);
-
-    if (client_cs_name)
-    {
-      mysql_options(mysql, MYSQL_SET_CHARSET_NAME, client_cs_name);
-      dbc->ansi_charset_info= dbc->cxn_charset_info= get_charset_by_csname(client_cs_name, MYF(MY_CS_PRIMARY), MYF(0));
-    }
-#else
-    MY_CHARSET_INFO my_charset;
-    mysql_get_character_set_info(&dbc->mysql, &my_charset);
-    dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
-#endif
-}
-
 #if MYSQL_VERSION_ID >= 50610
   if (ds->can_handle_exp_pwd)
   {
@@ -336,7 +342,6 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   if (ds->sslmode)
   {
     unsigned int mode = 0;
-    ds_get_utf8attr(ds->sslmode, &ds->sslmode8);
     if (!myodbc_strcasecmp(ODBC_SSL_MODE_DISABLED, ds->sslmode8))
       mode = SSL_MODE_DISABLED;
     if (!myodbc_strcasecmp(ODBC_SSL_MODE_PREFERRED, ds->sslmode8))
@@ -353,14 +358,104 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
       mysql_options(mysql, MYSQL_OPT_SSL_MODE, &mode);
   }
 #endif
+}
+
+
+/**
+  Try to establish a connection to a MySQL server based on the data source
+  configuration.
+
+  @param[in]  dbc  Database connection
+  @param[in]  ds   Data source information, with the UTF-8 attributes set
+                   by ds_set_utf8attrs()
+
+  @return Standard SQLRETURN code. If it is @c SQL_SUCCESS or @c
+  SQL_SUCCESS_WITH_INFO, a connection has been established.
+*/
+SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
+{
+  SQLRETURN rc= SQL_SUCCESS;
+  MYSQL *mysql= dbc->mysql;
+  unsigned long flags;
+  const my_bool on= 1;
+  BOOL pooled;
+
+#ifdef WIN32
+  /*
+   Detect if we are running with ADO present, and force on the
+   FLAG_COLUMN_SIZE_S32 option if we are.
+  */
+  if (GetModuleHandle("msado15.dll") != NULL)
+    ds->limit_column_size= 1;
+
+  /* Detect another problem specific to MS Access */
+  if (GetModuleHandle("msaccess.exe") != NULL)
+    ds->default_bigint_bind_str= 1;
+#endif
+
+  mysql_init(mysql);
+
+  flags= get_client_flags(ds);
+
+  if (ds->initstmt && ds->initstmt[0])
+  {
+    /* Check for SET NAMES */
+    if (is_set_names_statement(ds->initstmt8))
+    {
+      return set_dbc_error(dbc, "HY000",
+                           "SET NAMES not allowed by driver", 0);
+    }
+    mysql_options(mysql, MYSQL_INIT_COMMAND, ds->initstmt8);
+  }
+
+  myodbc_set_connect_options(dbc, mysql, ds);
+
+  if (dbc->unicode)
+  {
+    /*
+      Get the ANSI charset info before we change connection to UTF-8.
+    */
+    MY_CHARSET_INFO my_charset;
+    mysql_get_character_set_info(dbc->mysql, &my_charset);
+    dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
+    /*
+      We always use utf8 for the connection, and change it afterwards if needed.
+    */
+    mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8");
+    dbc->cxn_charset_info= utf8_charset_info;
+  }
+  else
+  {
+#ifdef _WIN32
+    char cpbuf[64];
+    const char *client_cs_name= NULL;
+
+    myodbc_snprintf(cpbuf, sizeof(cpbuf), "cp%u", GetACP());
+    client_cs_name= my_os_charset_to_mysql_charset(cpbuf);
+
+    if (client_cs_name)
+    {
+      mysql_options(mysql, MYSQL_SET_CHARSET_NAME, client_cs_name);
+      dbc->ansi_charset_info= dbc->cxn_charset_info= get_charset_by_csname(client_cs_name, MYF(MY_CS_PRIMARY), MYF(0));
+    }
+#else
+    MY_CHARSET_INFO my_charset;
+    mysql_get_character_set_info(dbc->mysql, &my_charset);
+    dbc->ansi_charset_info= get_charset(my_charset.number, MYF(0));
+#endif
+}
+
+  /* A pooled connection comes with its own handle */
+  pooled= pool_checkout(dbc, ds);
+  mysql= dbc->mysql;
 
-  if (!mysql_real_connect(mysql,
-                          ds_get_utf8attr(ds->server,   &ds->server8),
-                          ds_get_utf8attr(ds->uid,      &ds->uid8),
-                          ds_get_utf8attr(ds->pwd,      &ds->pwd8),
-                          ds_get_utf8attr(ds->database, &ds->database8),
+  if (!pooled && !mysql_real_connect(mysql,
+                          (char *)ds->server8,
+                          (char *)ds->uid8,
+                          (char *)ds->pwd8,
+                          (char *)ds->database8,
                           ds->port,
-                          ds_get_utf8attr(ds->socket,   &ds->socket8),
+                          (char *)ds->socket8,
                           flags))
   {
     unsigned int native_error= mysql_errno(mysql);
@@ -394,21 +489,29 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
     return SQL_ERROR;
   }
 
-  if (!is_minimum_version(dbc->mysql.server_version, "4.1.1"))
+  if (!is_minimum_version(dbc->mysql->server_version, "4.1.1"))
   {
     mysql_close(mysql);
     set_dbc_error(dbc, "08001", "Driver does not support server versions under 4.1.1", 0);
     return SQL_ERROR;
   }
 
-  rc= myodbc_set_initial_character_set(dbc, ds_get_utf8attr(ds->charset,
-                                                            &ds->charset8));
+  set_keepalive(mysql, ds->tcp_keepalive);
+
+  rc= myodbc_set_initial_character_set(dbc, (char *)ds->charset8);
   if (!SQL_SUCCEEDED(rc))
   {
     /** @todo set failure reason */
     goto error;
   }
 
+  /* The session of a pooled connection has been reset */
+  if (pooled && ds->initstmt8 && ds->initstmt8[0] &&
+      odbc_stmt(dbc, (char *)ds->initstmt8, SQL_NTS, TRUE) != SQL_SUCCESS)
+  {
+    goto error;
+  }
+
   /*
     The MySQL server has a workaround for old versions of Microsoft Access
     (and possibly other products) that is no longer necessary, but is
@@ -423,17 +526,11 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   }
 
   dbc->ds= ds;
-  /* init all needed UTF-8 strings */
-  ds_get_utf8attr(ds->name, &ds->name8);
-  ds_get_utf8attr(ds->server, &ds->server8);
-  ds_get_utf8attr(ds->uid, &ds->uid8);
-  ds_get_utf8attr(ds->pwd, &ds->pwd8);
-  ds_get_utf8attr(ds->socket, &ds->socket8);
+  dbc->max_allowed_packet= 0;
   if (ds->database)
   {
     x_free(dbc->database);
-    dbc->database= myodbc_strdup(ds_get_utf8attr(ds->database, &ds->database8),
-                             MYF(MY_WME));
+    dbc->database= myodbc_strdup((char *)ds->database8, MYF(MY_WME));
   }
   
   if (ds->save_queries && !dbc->query_log)
@@ -460,7 +557,8 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
                      "Transactions are not enabled, option value "
                      "SQL_AUTOCOMMIT_OFF changed to SQL_AUTOCOMMIT_ON", 0);
     }
-    else if (autocommit_on(dbc) && mysql_autocommit(mysql, FALSE))
+    else if (autocommit_on(dbc) &&
+             mysql_autocommit(readahead_yield(dbc), FALSE))
     {
       /** @todo set error */
       goto error;
@@ -469,7 +567,7 @@ SQLRETURN myodbc_do_connect(DBC *dbc, DataSource *ds)
   else if ((dbc->commit_flag == CHECK_AUTOCOMMIT_ON) &&
            trans_supported(dbc) && !autocommit_on(dbc))
   {
-    if (mysql_autocommit(mysql, TRUE))
+    if (mysql_autocommit(readahead_yield(dbc), TRUE))
     {
       /** @todo set error */
       goto error;
@@ -524,6 +622,236 @@ error:
 }
 
 
+/*
+  Cache of data sources resolved from connection strings, so that connecting
+  again with the same string does not read odbc.ini and convert every
+  attribute once more. Entries with a DSN are cached only if it is known
+  which odbc.ini files the DSN is read from, and are dropped when they
+  change. Otherwise only DSN-less strings are cached.
+*/
+
+#define DS_CACHE_SIZE 64
+
+typedef struct ds_cache_entry
+{
+  SQLWCHAR              *key;       /* connection string */
+  size_t                key_len;
+  DataSource            *ds;        /* with the UTF-8 attributes set */
+  ulonglong             signature;  /* of the odbc.ini files it was read from */
+  struct ds_cache_entry *next;
+} DS_CACHE_ENTRY;
+
+static DS_CACHE_ENTRY *ds_cache= NULL;  /* most recently used first */
+static uint           ds_cache_count= 0;
+static myodbc_mutex_t ds_cache_lock;
+
+
+#ifndef _WIN32
+static void add_file_signature(const char *path, ulonglong *signature)
+{
+  struct stat st;
+
+  if (path && !stat(path, &st))
+  {
+    *signature+= (ulonglong)st.st_mtime * 31 + (ulonglong)st.st_size + 1;
+  }
+}
+#endif
+
+
+/*
+  Computes a value that changes whenever one of the odbc.ini files is
+  changed, created or removed. Returns FALSE if that can not be told. The
+  driver manager looks for the files in the places it was built with, which
+  differs between unixODBC and iODBC, their versions and platforms, so the
+  files are known only when the environment names them: ODBCINI, and
+  ODBCSYSINI (unixODBC) or SYSODBCINI (iODBC). On Windows data sources are
+  kept in the registry.
+*/
+static BOOL odbc_ini_signature(ulonglong *signature)
+{
+#ifdef _WIN32
+  *signature= 0;
+  return FALSE;
+#else
+  char        path[FN_REFLEN];
+  const char  *user_ini= getenv("ODBCINI"),
+              *sys_dir=  getenv("ODBCSYSINI"),
+              *sys_ini=  getenv("SYSODBCINI");
+
+  *signature= 0;
+
+  if (!user_ini || !*user_ini ||
+      !((sys_dir && *sys_dir) || (sys_ini && *sys_ini)))
+  {
+    return FALSE;
+  }
+
+  add_file_signature(user_ini, signature);
+
+  if (sys_dir && *sys_dir)
+  {
+    myodbc_snprintf(path, sizeof(path), "%s/odbc.ini", sys_dir);
+    add_file_signature(path, signature);
+  }
+
+  add_file_signature(sys_ini, signature);
+
+  return TRUE;
+#endif
+}
+
+
+static void free_ds_cache_entry(DS_CACHE_ENTRY *entry)
+{
+  x_free(entry->key);
+  ds_delete(entry->ds);
+  x_free(entry);
+}
+
+
+/*
+  Returns a copy of the data source cached for the connection string, or
+  NULL if there is none or it is out of date.
+*/
+static DataSource * ds_cache_get(const SQLWCHAR *key, BOOL ini_known,
+                                 ulonglong signature)
+{
+  DS_CACHE_ENTRY  **pos, *entry, *stale= NULL;
+  DataSource      *ds= NULL;
+  size_t          key_len= sqlwcharlen(key);
+
+  myodbc_mutex_lock(&ds_cache_lock);
+
+  for (pos= &ds_cache; (entry= *pos); pos= &entry->next)
+  {
+    if (entry->key_len != key_len ||
+        memcmp(entry->key, key, key_len * sizeof(SQLWCHAR)))
+    {
+      continue;
+    }
+
+    *pos= entry->next;
+
+    if (entry->ds->name && (!ini_known || entry->signature != signature))
+    {
+      stale= entry;
+      --ds_cache_count;
+    }
+    else
+    {
+      entry->next= ds_cache;
+      ds_cache= entry;
+      ds= ds_dup(entry->ds);
+    }
+    break;
+  }
+
+  myodbc_mutex_unlock(&ds_cache_lock);
+
+  if (stale)
+  {
+    free_ds_cache_entry(stale);
+  }
+
+  return ds;
+}
+
+
+/*
+  Keeps a copy of the data source resolved from the connection string. The
+  UTF-8 attributes of the data source have to be set.
+*/
+static void ds_cache_put(const SQLWCHAR *key, DataSource *ds, BOOL ini_known,
+                         ulonglong signature)
+{
+  DS_CACHE_ENTRY  *entry, **pos, *evicted= NULL;
+  size_t          key_len= sqlwcharlen(key);
+
+  /* Without odbc.ini to watch a DSN could change unnoticed */
+  if (ds->name && !ini_known)
+  {
+    return;
+  }
+
+  if (!(entry= (DS_CACHE_ENTRY *)myodbc_malloc(sizeof(DS_CACHE_ENTRY),
+                                               MYF(MY_ZEROFILL))))
+  {
+    return;
+  }
+
+  if (!(entry->key= sqlwchardup(key, key_len)) || !(entry->ds= ds_dup(ds)))
+  {
+    x_free(entry->key);
+    x_free(entry);
+    return;
+  }
+  entry->key_len=   key_len;
+  entry->signature= signature;
+
+  myodbc_mutex_lock(&ds_cache_lock);
+
+  /* Another connect may have put the same string meanwhile */
+  for (pos= &ds_cache; *pos; pos= &(*pos)->next)
+  {
+    if ((*pos)->key_len == key_len &&
+        !memcmp((*pos)->key, key, key_len * sizeof(SQLWCHAR)))
+    {
+      evicted= *pos;
+      *pos= evicted->next;
+      evicted->next= NULL;
+      --ds_cache_count;
+      break;
+    }
+  }
+
+  entry->next= ds_cache;
+  ds_cache= entry;
+
+  if (++ds_cache_count > DS_CACHE_SIZE)
+  {
+    /* The least recently used one goes */
+    for (pos= &ds_cache; (*pos)->next; pos= &(*pos)->next);
+
+    (*pos)->next= evicted;
+    evicted= *pos;
+    *pos= NULL;
+    --ds_cache_count;
+  }
+
+  myodbc_mutex_unlock(&ds_cache_lock);
+
+  while (evicted)
+  {
+    entry= evicted->next;
+    free_ds_cache_entry(evicted);
+    evicted= entry;
+  }
+}
+
+
+void ds_cache_init(void)
+{
+  myodbc_mutex_init(&ds_cache_lock, NULL);
+}
+
+
+void ds_cache_end(void)
+{
+  DS_CACHE_ENTRY *entry, *next;
+
+  for (entry= ds_cache; entry; entry= next)
+  {
+    next= entry->next;
+    free_ds_cache_entry(entry);
+  }
+  ds_cache= NULL;
+  ds_cache_count= 0;
+
+  myodbc_mutex_destroy(&ds_cache_lock);
+}
+
+
 /**
   Establish a connection to a data source.
 
@@ -574,6 +902,7 @@ SQLRETURN SQL_API MySQLConnect(SQLHDBC   hdbc,
   ds_set_strnattr(&ds->pwd, szAuth, cbAuth);
 
   ds_lookup(ds);
+  ds_set_utf8attrs(ds);
 
   rc= myodbc_do_connect(dbc, ds);
 
@@ -622,7 +951,7 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
 {
   SQLRETURN rc= SQL_SUCCESS;
   DBC *dbc= (DBC *)hdbc;
-  DataSource *ds= ds_new();
+  DataSource *ds= ds_new(), *cached;
   /* We may have to read driver info to find the setup library. */
   Driver *pDriver= driver_new();
   SQLWCHAR *prompt_instr= NULL;
@@ -631,39 +960,55 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
   size_t prompt_inlen;
   BOOL bPrompt= FALSE;
   HMODULE hModule= NULL;
+  BOOL ini_known;
+  ulonglong ini_signature;
 
   if (cbConnStrIn != SQL_NTS)
     szConnStrIn= sqlwchardup(szConnStrIn, cbConnStrIn);
 
-  /* Parse the incoming string */
-  if (ds_from_kvpair(ds, szConnStrIn, (SQLWCHAR)';'))
+  /* Taken before odbc.ini is read, so a change made meanwhile is noticed */
+  ini_known= odbc_ini_signature(&ini_signature);
+
+  if ((cached= ds_cache_get(szConnStrIn, ini_known, ini_signature)))
   {
-    rc= set_dbc_error(dbc, "HY000",
-                      "Failed to parse the incoming connect string.", 0);
-    goto error;
+    ds_delete(ds);
+    ds= cached;
   }
+  else
+  {
+    /* Parse the incoming string */
+    if (ds_from_kvpair(ds, szConnStrIn, (SQLWCHAR)';'))
+    {
+      rc= set_dbc_error(dbc, "HY000",
+                        "Failed to parse the incoming connect string.", 0);
+      goto error;
+    }
 
 #ifndef NO_DRIVERMANAGER
-  /*
-   If the connection string contains the DSN keyword, the driver retrieves
-   the information for the specified data source (and merges it into the
-   connection info with the provided connection info having precedence).
+    /*
+     If the connection string contains the DSN keyword, the driver retrieves
+     the information for the specified data source (and merges it into the
+     connection info with the provided connection info having precedence).
 
-   This also allows us to get pszDRIVER (if not already given).
-  */
-  if (ds->name)
-  {
-     ds_lookup(ds);
-    
-    /* 
-      If DSN is used:
-      1 - we want the connection string options to override DSN options
-      2 - no need to check for parsing erros as it was done before
+     This also allows us to get pszDRIVER (if not already given).
     */
-    ds_from_kvpair(ds, szConnStrIn, (SQLWCHAR)';');
-  }
+    if (ds->name)
+    {
+      ds_lookup(ds);
+
+      /*
+        If DSN is used:
+        1 - we want the connection string options to override DSN options
+        2 - no need to check for parsing erros as it was done before
+      */
+      ds_from_kvpair(ds, szConnStrIn, (SQLWCHAR)';');
+    }
 #endif
 
+    ds_set_utf8attrs(ds);
+    ds_cache_put(szConnStrIn, ds, ini_known, ini_signature);
+  }
+
   /* If FLAG_NO_PROMPT is not set, force prompting off. */
   if (ds->dont_prompt_upon_connect)
     fDriverCompletion= SQL_DRIVER_NOPROMPT;
@@ -847,6 +1192,7 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
                         "Failed to parse the prompt output string.", 0);
       goto error;
     }
+    ds_set_utf8attrs(ds);
 
     /* 
       We don't need prompt_outstr after the new DataSource is created.
@@ -870,7 +1216,7 @@ SQLRETURN SQL_API MySQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd,
   if (ds->savefile)
   {
     /* We must disconnect if File DSN is created */
-    mysql_close(&dbc->mysql);
+    mysql_close(dbc->mysql);
   }
 
 connected:
@@ -938,6 +1284,7 @@ void free_connection_stmts(DBC *dbc)
   for (list_element= dbc->statements; list_element; list_element= next_element)
   {
       next_element= list_element->next;
+      async_wait((STMT *)list_element->data);
       my_SQLFreeStmt((SQLHSTMT)list_element->data, SQL_DROP);
   }
 }
@@ -960,16 +1307,21 @@ SQLRETURN SQL_API SQLDisconnect(SQLHDBC hdbc)
   CHECK_HANDLE(hdbc);
 
   free_connection_stmts(dbc);
-  
-  mysql_close(&dbc->mysql);
+  ssps_cache_free(dbc);
+  key_cache_free(dbc);
+
+  if (!pool_checkin(dbc))
+  {
+    mysql_close(dbc->mysql);
+  }
 
   if (dbc->ds && dbc->ds->save_queries)
     end_query_log(dbc->query_log);
 
   /* free allocated packet buffer */
-  if (dbc->mysql.net.buff)
+  if (dbc->mysql->net.buff)
   {
-    myodbc_net_end(&dbc->mysql.net);
+    myodbc_net_end(&dbc->mysql->net);
   }
 
   x_free(dbc->database);
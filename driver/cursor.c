@@ -45,7 +45,7 @@
 /* Sets affected rows everewhere where SQLRowCOunt could look for */
 void global_set_affected_rows(STMT * stmt, my_ulonglong rows)
 {
-  stmt->affected_rows= stmt->dbc->mysql.affected_rows= rows;
+  stmt->affected_rows= stmt->dbc->mysql->affected_rows= rows;
 
   /* Dirty hack. But not dirtier than the one above */
   if (ssps_used(stmt))
@@ -141,6 +141,7 @@ char *check_if_positioned_cursor_exists(STMT *pStmt, STMT **pStmtCursor)
       can find the cursor name this statement is referring to - it
       must have a result set to count.
     */
+    myodbc_mutex_lock(&dbc->handles_lock);
     for (list_element= dbc->statements;
          list_element;
          list_element= list_element->next)
@@ -156,9 +157,10 @@ char *check_if_positioned_cursor_exists(STMT *pStmt, STMT **pStmtCursor)
           !myodbc_strcasecmp((*pStmtCursor)->cursor.name,
                              cursorName))
       {
-        return (char *)wherePos;
+        break;
       }
     }
+    myodbc_mutex_unlock(&dbc->handles_lock);
 
     /* Did we run out of statements without finding a viable cursor? */
     if (!list_element)
@@ -215,10 +217,9 @@ static my_bool have_field_in_result(const char *name, MYSQL_RES *result)
 */
 static my_bool check_if_usable_unique_key_exists(STMT *stmt)
 {
-  char buff[NAME_LEN * 2 + 18], /* Possibly escaped name, plus text for query */
-       *pos, *table;
-  MYSQL_RES *res;
-  MYSQL_ROW row;
+  TABLE_KEYS *keys;
+  char *table, *db= NULL, **row;
+  uint i;
   int seq_in_index= 0;
 
   if (stmt->cursor.pk_validated)
@@ -231,25 +232,19 @@ static my_bool check_if_usable_unique_key_exists(STMT *stmt)
 #endif
     table= stmt->result->fields->table;
 
-  /* Use SHOW KEYS FROM table to check for keys. */
-  pos= myodbc_stpmov(buff, "SHOW KEYS FROM `");
-  pos+= mysql_real_escape_string(&stmt->dbc->mysql, pos, table, strlen(table));
-  pos= myodbc_stpmov(pos, "`");
-
-  MYLOG_QUERY(stmt, buff);
+#if MYSQL_VERSION_ID >= 40100
+  if (stmt->result->fields->db_length)
+    db= stmt->result->fields->db;
+#endif
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
-  if (exec_stmt_query(stmt, buff, strlen(buff), FALSE) ||
-      !(res= mysql_store_result(&stmt->dbc->mysql)))
-  {
-    set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-              mysql_errno(&stmt->dbc->mysql));
-    myodbc_mutex_unlock(&stmt->dbc->lock);
+  /* Keys of the table may be cached by the connection */
+  if (!(keys= table_keys_get(stmt, db, db ? strlen(db) : 0,
+                             table, strlen(table))))
     return FALSE;
-  }
 
-  while ((row= mysql_fetch_row(res)) &&
-         stmt->cursor.pk_count < MY_MAX_PK_PARTS)
+  for (i= 0, row= keys->rows;
+       i < keys->row_count && stmt->cursor.pk_count < MY_MAX_PK_PARTS;
+       ++i, row+= TABLE_KEYS_FIELDS)
   {
     int seq= atoi(row[3]);
 
@@ -276,8 +271,7 @@ static my_bool check_if_usable_unique_key_exists(STMT *stmt)
       /* Forget about any key we had in progress, we didn't have it all. */
       stmt->cursor.pk_count= seq_in_index= 0;
   }
-  mysql_free_result(res);
-  myodbc_mutex_unlock(&stmt->dbc->lock);
+  x_free(keys);
 
   /* Remember that we've figured this out already. */
   stmt->cursor.pk_validated= 1;
@@ -293,7 +287,7 @@ static my_bool check_if_usable_unique_key_exists(STMT *stmt)
 
 void set_current_cursor_data(STMT *stmt, SQLUINTEGER irow)
 {
-  long       nrow, row_pos;
+  long       row_pos;
   MYSQL_RES  *result= stmt->result;
 
   
@@ -313,22 +307,373 @@ void set_current_cursor_data(STMT *stmt, SQLUINTEGER irow)
     }
     else
     {
-      MYSQL_ROWS *dcursor;
-      dcursor= result->data->data;
+      result->data_cursor= stored_row(stmt, (my_ulonglong)row_pos);
+    }
+
+    stmt->cursor_row= row_pos;
+  }
+}
+
+
+/**
+  Mark the keyset of the statement as outdated. Has to be called whenever
+  the result is freed or replaced.
+*/
+void invalidate_keyset(STMT *stmt)
+{
+  stmt->keyset.result= NULL;
+}
+
+
+/*
+  Finds numbers of the fields of the unique key of the cursor in the result.
+  Returns the number of key parts found, it is less than the key has if
+  some part is missing in the result.
+*/
+static uint find_key_columns(STMT *stmt, uint *key_column)
+{
+  MYSQL_RES *result= stmt->result;
+  uint       i, j;
 
-      if (dcursor)
+  for (j= 0; j < stmt->cursor.pk_count; ++j)
+  {
+    for (i= 0; i < result->field_count; ++i)
+    {
+      if (!myodbc_strcasecmp(stmt->cursor.pkcol[j].name,
+                             result->fields[i].org_name))
       {
-        for ( nrow= 0; nrow < row_pos; ++nrow )
-        {
-          dcursor= dcursor->next;
-        }
+        break;
       }
+    }
 
-      result->data_cursor= dcursor;
+    if (i == result->field_count)
+    {
+      break;
     }
 
-    stmt->cursor_row= row_pos;
+    key_column[j]= i;
+  }
+
+  return j;
+}
+
+
+/*
+  Check that rows of the result can be refetched by the unique key of its
+  table: all its fields have to be plain columns of that table. Numbers of
+  the key fields are remembered in the keyset.
+*/
+static my_bool keyset_usable(STMT *stmt)
+{
+  MY_KEYSET   *keyset= &stmt->keyset;
+  MYSQL_RES   *result= stmt->result;
+  const char  *table;
+  uint         i;
+
+  if (keyset->usable >= 0)
+  {
+    return (my_bool)keyset->usable;
+  }
+
+  keyset->usable= 0;
+  keyset->key_count= 0;
+
+  if (!(table= find_used_table(stmt)) ||
+      !check_if_usable_unique_key_exists(stmt))
+  {
+    /* Not an error for the caller, the query will just run again */
+    CLEAR_STMT_ERROR(stmt);
+    return FALSE;
+  }
+
+  for (i= 0; i < result->field_count; ++i)
+  {
+    MYSQL_FIELD *field= result->fields + i;
+
+    if (!field->org_name || !field->org_name[0] ||
+        !field->org_table || strcmp(field->org_table, table))
+    {
+      return FALSE;
+    }
+  }
+
+  keyset->key_count= find_key_columns(stmt, keyset->key_column);
+
+  if (keyset->key_count != stmt->cursor.pk_count)
+  {
+    return FALSE;
+  }
+
+  keyset->usable= 1;
+
+  return TRUE;
+}
+
+
+/* Appends "(key value,...)," of a row. Returns TRUE if the key is NULL, or
+   on memory allocation error */
+static my_bool keyset_append_key(STMT *stmt, DYNAMIC_STRING *query,
+                                 MYSQL_ROW values)
+{
+  MY_KEYSET *keyset= &stmt->keyset;
+  uint i;
+
+  dynstr_append_mem(query, "(", 1);
+
+  for (i= 0; i < keyset->key_count; ++i)
+  {
+    const char *value= values[keyset->key_column[i]];
+    size_t length;
+
+    if (value == NULL)
+    {
+      return TRUE;
+    }
+
+    length= strlen(value);
+
+    if (dynstr_realloc(query, length * 2 + 3))
+    {
+      return TRUE;
+    }
+
+    query->str[query->length++]= '\'';
+    query->length+= mysql_real_escape_string(stmt->dbc->mysql,
+                                             query->str + query->length,
+                                             value, (ulong)length);
+    query->str[query->length++]= '\'';
+    dynstr_append_mem(query, ",", 1);
+  }
+
+  /* Replace the last ',' */
+  query->str[query->length - 1]= ')';
+
+  return dynstr_append_mem(query, ",", 1);
+}
+
+
+static my_bool keyset_same_key(MY_KEYSET *keyset, MYSQL_ROW values1,
+                               MYSQL_ROW values2)
+{
+  uint i;
+
+  for (i= 0; i < keyset->key_count; ++i)
+  {
+    const char *value1= values1[keyset->key_column[i]],
+               *value2= values2[keyset->key_column[i]];
+
+    if (value1 == NULL || value2 == NULL || strcmp(value1, value2))
+    {
+      return FALSE;
+    }
   }
+
+  return TRUE;
+}
+
+
+/*
+  Replaces values of a stored row. They are laid out one after another, as
+  the client library does that - lengths of values are computed from their
+  positions. Values that fit into the space of the old ones are written over
+  them, so that refreshing rows again and again takes no more memory; the
+  length of a row is the space its values have, the size of the packet for
+  rows stored by the client library.
+*/
+static my_bool keyset_replace_row(MYSQL_RES *result, MYSQL_ROWS *row,
+                                  MYSQL_ROW values, unsigned long *lengths)
+{
+  uint    i, fields= result->field_count;
+  size_t  size= 0;
+  char    **data= row->data, *to;
+
+  for (i= 0; i < fields; ++i)
+  {
+    if (values[i])
+    {
+      size+= lengths[i] + 1;
+    }
+  }
+
+  if (size > row->length)
+  {
+    if (!(data= (char **)alloc_root(&result->data->alloc,
+                                    (fields + 1) * sizeof(char *) + size)))
+    {
+      return TRUE;
+    }
+
+    row->data= data;
+    row->length= (unsigned long)size;
+  }
+
+  to= (char *)(data + fields + 1);
+
+  for (i= 0; i < fields; ++i)
+  {
+    if (values[i])
+    {
+      data[i]= to;
+      memcpy(to, values[i], lengths[i]);
+      to+= lengths[i];
+      *to++= '\0';
+    }
+    else
+    {
+      data[i]= NULL;
+    }
+  }
+  /* End of the last value */
+  data[fields]= to;
+
+  return FALSE;
+}
+
+
+/**
+  Refresh values of rows [first_row, first_row + rows) of a dynamic cursor
+  with a query selecting them by their keys.
+
+  @return TRUE if the rows can't be refreshed this way and the whole query
+          has to run again: the rowset leaves the keyset, some of its rows
+          are gone or have got another key, or the result does not allow
+          refetching its rows.
+*/
+my_bool keyset_refresh(STMT *stmt, long first_row, long rows)
+{
+  MY_KEYSET       *keyset= &stmt->keyset;
+  MYSQL_RES       *result= stmt->result, *res= NULL;
+  MYSQL_ROWS      **rowset= NULL;
+  MYSQL_ROW       values;
+  DYNAMIC_STRING  query;
+  SQLULEN         keyset_size= stmt->stmt_options.keyset_size;
+  long            i, found= 0;
+  uint            j;
+
+  if (ssps_used(stmt) || result == NULL || result->data == NULL ||
+      stmt->fake_result || stmt->result_array || scroller_exists(stmt))
+  {
+    return TRUE;
+  }
+
+  /* Rows of the result that has just been read are up to date */
+  if (keyset->result != result)
+  {
+    keyset->result= result;
+    keyset->first_row= keyset_size > 0 ? myodbc_max(first_row, 0) : 0;
+    keyset->usable= -1;
+    return FALSE;
+  }
+
+  if (first_row < 0 || rows <= 0)
+  {
+    return FALSE;
+  }
+
+  /* Past the end there can be new rows */
+  if (first_row < keyset->first_row ||
+      first_row + rows > (long)result->row_count ||
+      (keyset_size > 0 &&
+       first_row + rows > keyset->first_row + (long)keyset_size))
+  {
+    return TRUE;
+  }
+
+  if (!keyset_usable(stmt))
+  {
+    return TRUE;
+  }
+
+  if (!(rowset= (MYSQL_ROWS **)myodbc_malloc(rows * sizeof(MYSQL_ROWS *),
+                                             MYF(0))))
+  {
+    return TRUE;
+  }
+
+  if (init_dynamic_string(&query, "SELECT ", 1024, 1024))
+  {
+    x_free(rowset);
+    return TRUE;
+  }
+
+  for (j= 0; j < result->field_count; ++j)
+  {
+    dynstr_append_quoted_name(&query, result->fields[j].org_name);
+    dynstr_append_mem(&query, ",", 1);
+  }
+  --query.length;
+
+  dynstr_append_mem(&query, " FROM ", 6);
+  if (result->fields[0].db_length)
+  {
+    dynstr_append_quoted_name(&query, result->fields[0].db);
+    dynstr_append_mem(&query, ".", 1);
+  }
+  dynstr_append_quoted_name(&query, find_used_table(stmt));
+
+  dynstr_append_mem(&query, " WHERE (", 8);
+  for (j= 0; j < keyset->key_count; ++j)
+  {
+    dynstr_append_quoted_name(&query,
+                         result->fields[keyset->key_column[j]].org_name);
+    dynstr_append_mem(&query, ",", 1);
+  }
+  query.str[query.length - 1]= ')';
+  dynstr_append_mem(&query, " IN (", 5);
+
+  for (i= 0; i < rows; ++i)
+  {
+    if (!(rowset[i]= stored_row(stmt, (my_ulonglong)(first_row + i))) ||
+        keyset_append_key(stmt, &query, rowset[i]->data))
+    {
+      goto exit;
+    }
+  }
+  query.str[query.length - 1]= ')';
+
+  MYLOG_QUERY(stmt, query.str);
+
+  myodbc_mutex_lock(&stmt->dbc->lock);
+  if (exec_stmt_query(stmt, query.str, query.length, FALSE) ||
+      !(res= mysql_store_result(stmt->dbc->mysql)))
+  {
+    myodbc_mutex_unlock(&stmt->dbc->lock);
+    CLEAR_STMT_ERROR(stmt);
+    goto exit;
+  }
+  myodbc_mutex_unlock(&stmt->dbc->lock);
+
+  if (mysql_num_fields(res) != result->field_count)
+  {
+    goto exit;
+  }
+
+  while ((values= mysql_fetch_row(res)))
+  {
+    for (i= 0; i < rows; ++i)
+    {
+      if (rowset[i] && keyset_same_key(keyset, rowset[i]->data, values))
+      {
+        if (keyset_replace_row(result, rowset[i], values,
+                               mysql_fetch_lengths(res)))
+        {
+          goto exit;
+        }
+
+        /* Each row is refreshed once */
+        rowset[i]= NULL;
+        ++found;
+        break;
+      }
+    }
+  }
+
+exit:
+  mysql_free_result(res);
+  dynstr_free(&query);
+  x_free(rowset);
+
+  return found != rows;
 }
 
 
@@ -450,22 +795,29 @@ static SQLRETURN copy_rowdata(STMT *stmt, DESCREC *aprec,
 
 /*
   @type    : myodbc3 internal
-  @purpose : copies field data to statement
+  @purpose : appends the value of a field of the current row as a literal.
+             Returns SQL_NO_DATA if the value is NULL, nothing is appended then
 */
 
-static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
-                            DYNAMIC_STRING *dynQuery,
-                            SQLUSMALLINT nSrcCol)
+static SQLRETURN append_field_value(STMT *stmt, MYSQL_RES *result,
+                                    DYNAMIC_STRING *dynQuery,
+                                    SQLUSMALLINT nSrcCol)
 {
   DESCREC aprec_, iprec_;
   DESCREC *aprec= &aprec_, *iprec= &iprec_;
   MYSQL_FIELD *field= mysql_fetch_field_direct(result,nSrcCol);
   MYSQL_ROW   row_data;
-  NET         *net=&stmt->dbc->mysql.net;
-  unsigned char *to= net->buff;
+  NET         *net= stmt_query_net(stmt);
+  unsigned char *to;
   SQLLEN      length;
   char as_string[50], *dummy;
 
+  if (net == NULL)
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+  to= net->buff;
+
   if (ssps_used(stmt))
   {
     dummy= get_string(stmt, nSrcCol, NULL, &length, as_string);
@@ -476,6 +828,11 @@ static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
     row_data= result->data_cursor->data + nSrcCol;
   }
 
+  if (!row_data || !*row_data)
+  {
+    return SQL_NO_DATA;
+  }
+
   desc_rec_init_apd(aprec);
   desc_rec_init_ipd(iprec);
 
@@ -483,31 +840,45 @@ static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
   iprec->concise_type= get_sql_data_type(stmt, field, 0);
   aprec->concise_type= SQL_C_CHAR;
 
-  if (row_data && *row_data)
-  {
-    aprec->data_ptr= (SQLPOINTER) *row_data;
-    length= strlen(*row_data);
+  aprec->data_ptr= (SQLPOINTER) *row_data;
+  length= strlen(*row_data);
 
-    aprec->octet_length_ptr= &length;
-    aprec->indicator_ptr= &length;
+  aprec->octet_length_ptr= &length;
+  aprec->indicator_ptr= &length;
 
-    if (!SQL_SUCCEEDED(insert_param(stmt, (uchar *) &to, stmt->apd,
-                                    aprec, iprec, 0)))
-      return 1;
-    if (!(to= (unsigned char *) add_to_buffer(net, (char *) to, " AND ", 5)))
-    {
-      return (my_bool)set_error(stmt, MYERR_S1001, NULL, 4001);
-    }
+  if (!SQL_SUCCEEDED(insert_param(stmt, (uchar *) &to, stmt->apd,
+                                  aprec, iprec, 0)))
+    return SQL_ERROR;
 
-    length= (uint) ((char *)to - (char*) net->buff);
-    dynstr_append_mem(dynQuery, (char*) net->buff, length);
-  }
-  else
+  length= (uint) ((char *)to - (char*) net->buff);
+  dynstr_append_mem(dynQuery, (char*) net->buff, length);
+
+  return SQL_SUCCESS;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : copies field data to statement
+*/
+
+static my_bool insert_field(STMT *stmt, MYSQL_RES *result,
+                            DYNAMIC_STRING *dynQuery,
+                            SQLUSMALLINT nSrcCol)
+{
+  switch (append_field_value(stmt, result, dynQuery, nSrcCol))
   {
-    --dynQuery->length;
-    dynstr_append_mem(dynQuery, " IS NULL AND ",13);
+    case SQL_SUCCESS:
+      dynstr_append_mem(dynQuery, " AND ", 5);
+      return 0;
+
+    case SQL_NO_DATA:
+      --dynQuery->length;
+      dynstr_append_mem(dynQuery, " IS NULL AND ",13);
+      return 0;
   }
-  return 0;
+
+  return 1;
 }
 
 
@@ -588,10 +959,10 @@ static SQLRETURN append_all_fields(STMT *stmt, DYNAMIC_STRING *dynQuery)
   MYLOG_QUERY(stmt, select);
   myodbc_mutex_lock(&stmt->dbc->lock);
   if (exec_stmt_query(stmt, select, strlen(select), FALSE) ||
-      !(presultAllColumns= mysql_store_result(&stmt->dbc->mysql)))
+      !(presultAllColumns= mysql_store_result(stmt->dbc->mysql)))
   {
-    set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-              mysql_errno(&stmt->dbc->mysql));
+    set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+              mysql_errno(stmt->dbc->mysql));
     myodbc_mutex_unlock(&stmt->dbc->lock);
     return SQL_ERROR;
   }
@@ -707,9 +1078,131 @@ static SQLRETURN build_where_clause( STMT * pStmt,
         dynstr_append( dynQuery, buff );
     }
     else
-    {
-        dynstr_append_mem( dynQuery, " LIMIT 1", 8 );
-    }
+    {
+        dynstr_append_mem( dynQuery, " LIMIT 1", 8 );
+    }
+
+    return SQL_SUCCESS;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : checks if a column is left as it is by an update of a row of
+             the rowset - it is not bound or its length is SQL_COLUMN_IGNORE
+*/
+
+static my_bool set_value_ignored(STMT *stmt, SQLULEN irow, uint ncol)
+{
+    DESCREC *arrec= desc_get_rec(stmt->ard, ncol, FALSE),
+            *irrec= desc_get_rec(stmt->ird, ncol, FALSE);
+
+    if (!arrec || !ARD_IS_BOUND(arrec) || !irrec || !irrec->row.field)
+        return TRUE;
+
+    if ( arrec->octet_length_ptr )
+    {
+        SQLLEN *pcbValue= ptr_offset_adjust(arrec->octet_length_ptr,
+                                            stmt->ard->bind_offset_ptr,
+                                            stmt->ard->bind_type,
+                                            sizeof(SQLLEN), irow);
+        return *pcbValue == SQL_COLUMN_IGNORE;
+    }
+
+    return FALSE;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : appends the new value of a column of a row of the rowset
+             followed by ','. Returns SQL_NO_DATA if the column is to be
+             left as it is.
+*/
+
+static SQLRETURN append_set_value(STMT *stmt, SQLULEN irow, uint ncol,
+                                  DYNAMIC_STRING *dynQuery)
+{
+    DESCREC aprec_, iprec_;
+    DESCREC *aprec= &aprec_, *iprec= &iprec_;
+    SQLLEN        length= 0;
+    MYSQL_FIELD *field= mysql_fetch_field_direct(stmt->result,ncol);
+    NET         *net= stmt_query_net(stmt);
+    SQLCHAR     *to;
+    DESCREC *arrec, *irrec;
+
+    if (net == NULL)
+    {
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+    to= net->buff;
+
+    desc_rec_init_apd(aprec);
+    desc_rec_init_ipd(iprec);
+
+    arrec= desc_get_rec(stmt->ard, ncol, FALSE);
+    irrec= desc_get_rec(stmt->ird, ncol, FALSE);
+
+    if (!irrec)
+    {
+      return SQL_ERROR; // The error info is already set inside desc_get_rec()
+    }
+    assert(irrec->row.field);
+
+    if (stmt->setpos_apd)
+      aprec= desc_get_rec(stmt->setpos_apd, ncol, FALSE);
+
+    if (set_value_ignored(stmt, irow, ncol))
+    {
+      return SQL_NO_DATA;
+    }
+
+    if ( arrec->octet_length_ptr )
+    {
+        length= *(SQLLEN *)ptr_offset_adjust(arrec->octet_length_ptr,
+                                             stmt->ard->bind_offset_ptr,
+                                             stmt->ard->bind_type,
+                                             sizeof(SQLLEN), irow);
+    }
+    else
+    {
+        /* set SQL_NTS only if its a string */
+        switch (arrec->concise_type)
+        {
+            case SQL_CHAR:
+            case SQL_VARCHAR:
+            case SQL_LONGVARCHAR:
+                length= SQL_NTS;
+                break;
+        }
+    }
+
+    iprec->concise_type= get_sql_data_type(stmt, field, NULL);
+    aprec->concise_type= arrec->concise_type;
+    /* copy prec and scale - needed for SQL_NUMERIC values */
+    iprec->precision= arrec->precision;
+    iprec->scale= arrec->scale;
+    if (stmt->dae_type && aprec->par.is_dae)
+      aprec->data_ptr= aprec->par.value;
+    else
+      aprec->data_ptr= ptr_offset_adjust(arrec->data_ptr,
+                                         stmt->ard->bind_offset_ptr,
+                                         stmt->ard->bind_type,
+                                         bind_length(arrec->concise_type,
+                                                     arrec->octet_length),
+                                         irow);
+    aprec->octet_length= arrec->octet_length;
+    if (length == SQL_NTS)
+        length= strlen(aprec->data_ptr);
+
+    aprec->octet_length_ptr= &length;
+    aprec->indicator_ptr= &length;
+
+    if ( copy_rowdata(stmt,aprec,iprec,&net,&to) != SQL_SUCCESS )
+        return(SQL_ERROR);
+
+    length= (uint) ((char *)to - (char*) net->buff);
+    dynstr_append_mem(dynQuery, (char*) net->buff, length);
 
     return SQL_SUCCESS;
 }
@@ -723,20 +1216,13 @@ static SQLRETURN build_where_clause( STMT * pStmt,
 static SQLRETURN build_set_clause(STMT *stmt, SQLULEN irow,
                                   DYNAMIC_STRING *dynQuery)
 {
-    DESCREC aprec_, iprec_;
-    DESCREC *aprec= &aprec_, *iprec= &iprec_;
-    SQLLEN        length= 0;
     uint          ncol, ignore_count= 0;
     MYSQL_FIELD *field;
     MYSQL_RES   *result= stmt->result;
-    NET         *net=&stmt->dbc->mysql.net;
-    DESCREC *arrec, *irrec;
+    SQLRETURN   rc;
 
     dynstr_append_mem(dynQuery," SET ",5);
 
-    desc_rec_init_apd(aprec);
-    desc_rec_init_ipd(iprec);
-
     /*
       To make sure, it points to correct row in the
       current rowset..
@@ -744,93 +1230,259 @@ static SQLRETURN build_set_clause(STMT *stmt, SQLULEN irow,
     irow= irow ? irow-1: 0;
     for ( ncol= 0; ncol < stmt->result->field_count; ++ncol )
     {
-        SQLLEN *pcbValue;
-        SQLCHAR *to= net->buff;
+        size_t length= dynQuery->length;
+
         field= mysql_fetch_field_direct(result,ncol);
-        arrec= desc_get_rec(stmt->ard, ncol, FALSE);
-        irrec= desc_get_rec(stmt->ird, ncol, FALSE);
-        
-        if (!irrec)
-        {
-          return SQL_ERROR; // The error info is already set inside desc_get_rec()
-        }
-        assert(irrec->row.field);
 
-        if (stmt->setpos_apd)
-          aprec= desc_get_rec(stmt->setpos_apd, ncol, FALSE);
+        dynstr_append_quoted_name(dynQuery,field->org_name);
+        dynstr_append_mem(dynQuery,"=",1);
 
-        if (!arrec || !ARD_IS_BOUND(arrec) || !irrec->row.field)
+        rc= append_set_value(stmt, irow, ncol, dynQuery);
+        if (rc == SQL_NO_DATA)
         {
+          dynQuery->length= length;
           ++ignore_count;
           continue;
         }
-
-        if ( arrec->octet_length_ptr )
+        else if (rc != SQL_SUCCESS)
         {
-            pcbValue= ptr_offset_adjust(arrec->octet_length_ptr,
-                                        stmt->ard->bind_offset_ptr,
-                                        stmt->ard->bind_type,
-                                        sizeof(SQLLEN), irow);
-            /*
-              If the pcbValue is SQL_COLUMN_IGNORE, then ignore the
-              column in the SET clause
-            */
-            if ( *pcbValue == SQL_COLUMN_IGNORE )
-            {
-                ++ignore_count;
-                continue;
-            }
-            length= *pcbValue;
+          return SQL_ERROR;
         }
-        else
+    }
+
+    if (ignore_count == result->field_count)
+      return ER_ALL_COLUMNS_IGNORED;
+
+    dynQuery->str[--dynQuery->length]='\0';
+    return(SQL_SUCCESS);
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : deletes or updates several rows of the rowset with one statement
+             finding them by their unique key:
+               DELETE FROM `t` WHERE (`k`,..) IN ((..),..)
+               UPDATE `t` SET `c`=CASE WHEN (`k`,..)=(..) THEN .. ELSE `c` END
+                 WHERE (`k`,..) IN ((..),..)
+             dynQuery has to contain the statement up to the table name.
+             rows are numbers of the rows in the rowset, as for
+             set_current_cursor_data(), or NULL for the first count rows
+             of the rowset. Rows of an update, that have all
+             columns ignored, are left out.
+             Returns SQL_NO_DATA if the rows have to be processed one by one
+             instead - there is no usable key, a key value is NULL or the
+             values are supplied at execution time.
+*/
+
+static SQLRETURN setpos_rows_by_key(STMT *stmt, DYNAMIC_STRING *dynQuery,
+                                    SQLUSMALLINT *rows, uint count,
+                                    my_bool update, my_ulonglong *affected)
+{
+  MYSQL_RES      *result= stmt->result;
+  DYNAMIC_STRING  keys, key_names;
+  uint            key_column[MY_MAX_PK_PARTS], key_count;
+  size_t         *key_start;
+  uint            i, ncol, found= 0;
+  SQLRETURN       rc= SQL_NO_DATA;
+
+  if (count < 2 || stmt->dae_type)
+  {
+    return SQL_NO_DATA;
+  }
+
+  if (!check_if_usable_unique_key_exists(stmt))
+  {
+    /* Not an error here, WHERE clause is built of all fields then */
+    CLEAR_STMT_ERROR(stmt);
+    return SQL_NO_DATA;
+  }
+
+  key_count= find_key_columns(stmt, key_column);
+  if (key_count != stmt->cursor.pk_count)
+  {
+    return SQL_NO_DATA;
+  }
+
+  /* Key of the row i is "(..)," at key_start[i], it is empty if skipped */
+  if (!(key_start= (size_t *)myodbc_malloc((count + 1) * sizeof(size_t),
+                                           MYF(0))))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  if (init_dynamic_string(&keys, "", 1024, 1024))
+  {
+    x_free(key_start);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  if (init_dynamic_string(&key_names, "(", 64, 64))
+  {
+    dynstr_free(&keys);
+    x_free(key_start);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  for (i= 0; i < key_count; ++i)
+  {
+    dynstr_append_quoted_name(&key_names,
+                              result->fields[key_column[i]].org_name);
+    dynstr_append_mem(&key_names, ",", 1);
+  }
+  key_names.str[key_names.length - 1]= ')';
+
+  for (i= 0; i < count; ++i)
+  {
+    SQLUSMALLINT row= rows ? rows[i] : (SQLUSMALLINT)(i + 1);
+    uint         j;
+
+    key_start[i]= keys.length;
+
+    if (update)
+    {
+      for (ncol= 0; ncol < result->field_count; ++ncol)
+      {
+        if (!set_value_ignored(stmt, row ? row - 1 : 0, ncol))
+          break;
+      }
+
+      if (ncol == result->field_count)
+        continue;
+    }
+
+    set_current_cursor_data(stmt, row);
+
+    dynstr_append_mem(&keys, "(", 1);
+    for (j= 0; j < key_count; ++j)
+    {
+      /* NULL key values can't be compared, the caller has to do it */
+      if ((rc= append_field_value(stmt, result, &keys,
+                                  (SQLUSMALLINT)key_column[j])) != SQL_SUCCESS)
+        goto exit;
+
+      dynstr_append_mem(&keys, ",", 1);
+    }
+    keys.str[keys.length - 1]= ')';
+    dynstr_append_mem(&keys, ",", 1);
+    ++found;
+  }
+  key_start[count]= keys.length;
+
+  if (!found)
+  {
+    rc= ER_ALL_COLUMNS_IGNORED;
+    goto exit;
+  }
+
+  if (update)
+  {
+    uint j, n, keys_set= 0;
+
+    /*
+      MySQL assigns columns from left to right and the following CASEs
+      would see the new key. So key columns are assigned last, and if more
+      than one of them is changed rows are updated one by one.
+    */
+    for (j= 0; j < key_count; ++j)
+    {
+      for (i= 0; i < count; ++i)
+      {
+        SQLUSMALLINT row= rows ? rows[i] : (SQLUSMALLINT)(i + 1);
+
+        if (key_start[i] != key_start[i + 1] &&
+            !set_value_ignored(stmt, row ? row - 1 : 0, key_column[j]))
         {
-            /* set SQL_NTS only if its a string */
-            switch (arrec->concise_type)
-            {
-                case SQL_CHAR:
-                case SQL_VARCHAR:
-                case SQL_LONGVARCHAR:
-                    length= SQL_NTS;
-                    break;
-            }
+          ++keys_set;
+          break;
         }
+      }
+    }
 
-        dynstr_append_quoted_name(dynQuery,field->org_name);
-        dynstr_append_mem(dynQuery,"=",1);
+    if (keys_set > 1)
+    {
+      rc= SQL_NO_DATA;
+      goto exit;
+    }
 
-        iprec->concise_type= get_sql_data_type(stmt, field, NULL);
-        aprec->concise_type= arrec->concise_type;
-	/* copy prec and scale - needed for SQL_NUMERIC values */
-        iprec->precision= arrec->precision;
-        iprec->scale= arrec->scale;
-        if (stmt->dae_type && aprec->par.is_dae)
-          aprec->data_ptr= aprec->par.value;
-        else
-          aprec->data_ptr= ptr_offset_adjust(arrec->data_ptr,
-                                             stmt->ard->bind_offset_ptr,
-                                             stmt->ard->bind_type,
-                                             bind_length(arrec->concise_type,
-                                                         arrec->octet_length),
-                                             irow);
-        aprec->octet_length= arrec->octet_length;
-        if (length == SQL_NTS)
-            length= strlen(aprec->data_ptr);
+    dynstr_append_mem(dynQuery, " SET ", 5);
+
+    /* Non-key columns in the first pass over fields, key columns in the second */
+    for (n= 0; n < 2 * result->field_count; ++n)
+    {
+      MYSQL_FIELD *field;
+      size_t       length= dynQuery->length;
+      my_bool      have_value= FALSE;
 
-        aprec->octet_length_ptr= &length;
-        aprec->indicator_ptr= &length;
+      ncol= n % result->field_count;
+      field= result->fields + ncol;
 
-        if ( copy_rowdata(stmt,aprec,iprec,&net,&to) != SQL_SUCCESS )
-            return(SQL_ERROR);
+      for (j= 0; j < key_count && key_column[j] != ncol; ++j);
+
+      if ((j < key_count) != (n >= result->field_count))
+        continue;
+
+      dynstr_append_quoted_name(dynQuery, field->org_name);
+      dynstr_append_mem(dynQuery, "=CASE", 5);
+
+      for (i= 0; i < count; ++i)
+      {
+        SQLUSMALLINT row= rows ? rows[i] : (SQLUSMALLINT)(i + 1);
+        SQLULEN      irow= row ? row - 1 : 0;
 
-        length= (uint) ((char *)to - (char*) net->buff);
-        dynstr_append_mem(dynQuery, (char*) net->buff, length);
+        if (key_start[i] == key_start[i + 1] ||
+            set_value_ignored(stmt, irow, ncol))
+          continue;
+
+        dynstr_append_mem(dynQuery, " WHEN ", 6);
+        dynstr_append_mem(dynQuery, key_names.str, key_names.length);
+        dynstr_append_mem(dynQuery, "=", 1);
+        dynstr_append_mem(dynQuery, keys.str + key_start[i],
+                          key_start[i + 1] - key_start[i] - 1);
+        dynstr_append_mem(dynQuery, " THEN ", 6);
+
+        if ((rc= append_set_value(stmt, irow, ncol, dynQuery)) != SQL_SUCCESS)
+          goto exit;
+
+        /* Remove the ',' after the value */
+        --dynQuery->length;
+        have_value= TRUE;
+      }
+
+      if (!have_value)
+      {
+        dynQuery->length= length;
+        continue;
+      }
+
+      dynstr_append_mem(dynQuery, " ELSE ", 6);
+      dynstr_append_quoted_name(dynQuery, field->org_name);
+      dynstr_append_mem(dynQuery, " END,", 5);
     }
 
-    if (ignore_count == result->field_count)
-      return ER_ALL_COLUMNS_IGNORED;
+    /* Remove the trailing ',' */
+    --dynQuery->length;
+  }
 
-    dynQuery->str[--dynQuery->length]='\0';
-    return(SQL_SUCCESS);
+  dynstr_append_mem(dynQuery, " WHERE ", 7);
+  dynstr_append_mem(dynQuery, key_names.str, key_names.length);
+  dynstr_append_mem(dynQuery, " IN (", 5);
+  /* The trailing ',' of the keys is replaced by ')' */
+  dynstr_append_mem(dynQuery, keys.str, keys.length - 1);
+  dynstr_append_mem(dynQuery, ")", 1);
+
+  rc= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE);
+  if (SQL_SUCCEEDED(rc))
+  {
+    *affected= mysql_affected_rows(stmt->dbc->mysql);
+  }
+
+exit:
+  dynstr_free(&key_names);
+  dynstr_free(&keys);
+  x_free(key_start);
+
+  return rc;
 }
 
 
@@ -853,7 +1505,7 @@ SQLRETURN my_pos_delete(STMT *stmt, STMT *stmtParam,
     nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE);
     if ( nReturn == SQL_SUCCESS || nReturn == SQL_SUCCESS_WITH_INFO )
     {
-        stmtParam->affected_rows= mysql_affected_rows(&stmt->dbc->mysql);
+        stmtParam->affected_rows= mysql_affected_rows(stmt->dbc->mysql);
         nReturn= update_status(stmtParam,SQL_ROW_DELETED);
     }
     return nReturn;
@@ -908,7 +1560,7 @@ SQLRETURN my_pos_update( STMT *             pStmtCursor,
     rc = my_SQLExecute( pStmtTemp );
     if ( SQL_SUCCEEDED( rc ) )
     {
-        pStmt->affected_rows = mysql_affected_rows( &pStmtTemp->dbc->mysql );
+        pStmt->affected_rows = mysql_affected_rows( pStmtTemp->dbc->mysql );
         rc = update_status( pStmt, SQL_ROW_UPDATED );
     }
     else if (rc == SQL_NEED_DATA)
@@ -1004,6 +1656,8 @@ static SQLRETURN setpos_delete_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
   DESCREC *arrec;
   SQLPOINTER TargetValuePtr= NULL;
   long curr_bookmark_index= 0;
+  SQLUSMALLINT *rows;
+  my_bool      one_by_one;
 
   /* 
      we want to work with base table name - 
@@ -1029,11 +1683,16 @@ static SQLRETURN setpos_delete_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
     return SQL_ERROR;
   }
 
-  rowset_pos= 0;
   rowset_end= stmt->ard->array_size;
 
+  if (!(rows= (SQLUSMALLINT *)myodbc_malloc(rowset_end * sizeof(SQLUSMALLINT),
+                                            MYF(0))))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
   /* fetch all bookmark rows in the rowset to delete */
-  while (rowset_pos < rowset_end)
+  for (rowset_pos= 0; rowset_pos < rowset_end; ++rowset_pos)
   {
     if (arrec->data_ptr)
     {
@@ -1043,20 +1702,43 @@ static SQLRETURN setpos_delete_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
                                         arrec->octet_length, rowset_pos);
     }
 
-    curr_bookmark_index= atol((SQLCHAR *) TargetValuePtr);
-    dynQuery->length= query_length;
+    rows[rowset_pos]= (SQLUSMALLINT)atol((SQLCHAR *) TargetValuePtr);
+  }
 
-    /* append our WHERE clause to our DELETE statement */
-    nReturn = build_where_clause( stmt, dynQuery, (SQLUSMALLINT)curr_bookmark_index );
-    if (!SQL_SUCCEEDED( nReturn ))
-    {
-      return nReturn;
-    }
+  /* delete all of them with one statement if they can be found by a key */
+  nReturn= setpos_rows_by_key(stmt, dynQuery, rows, rowset_end, FALSE,
+                              &affected_rows);
+  if ((one_by_one= (nReturn == SQL_NO_DATA)))
+  {
+    nReturn= SQL_SUCCESS;
+  }
+  else if (!SQL_SUCCEEDED(nReturn))
+  {
+    x_free(rows);
+    return nReturn;
+  }
+
+  for (rowset_pos= 0; rowset_pos < rowset_end; ++rowset_pos)
+  {
+    curr_bookmark_index= rows[rowset_pos];
 
-    /* execute our DELETE statement */
-    if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+    if (one_by_one)
     {
-      affected_rows+= stmt->dbc->mysql.affected_rows;
+      dynQuery->length= query_length;
+
+      /* append our WHERE clause to our DELETE statement */
+      nReturn = build_where_clause( stmt, dynQuery, (SQLUSMALLINT)curr_bookmark_index );
+      if (!SQL_SUCCEEDED( nReturn ))
+      {
+        x_free(rows);
+        return nReturn;
+      }
+
+      /* execute our DELETE statement */
+      if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+      {
+        affected_rows+= stmt->dbc->mysql->affected_rows;
+      }
     }
     if (stmt->stmt_options.rowStatusPtr_ex)
     {
@@ -1066,8 +1748,8 @@ static SQLRETURN setpos_delete_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
     {
       stmt->ird->array_status_ptr[curr_bookmark_index]= SQL_ROW_DELETED;
     }
-    ++rowset_pos;
   }
+  x_free(rows);
 
   global_set_affected_rows(stmt, affected_rows);
   /* fix-up so fetching next rowset is correct */
@@ -1115,25 +1797,39 @@ static SQLRETURN setpos_delete(STMT *stmt, SQLUSMALLINT irow,
     rowset_pos= rowset_end= irow;
   }
 
-  /* process all desired rows in the rowset - we assume rowset_pos is valid */
-  do
+  /* the whole rowset is deleted with one statement if rows have a key */
+  nReturn= irow ? SQL_NO_DATA :
+           setpos_rows_by_key(stmt, dynQuery, NULL, rowset_end, FALSE,
+                              &affected_rows);
+
+  if (nReturn == SQL_NO_DATA)
   {
-    dynQuery->length= query_length;
+    nReturn= SQL_SUCCESS;
 
-    /* append our WHERE clause to our DELETE statement */
-    nReturn = build_where_clause( stmt, dynQuery, (SQLUSMALLINT)rowset_pos );
-    if (!SQL_SUCCEEDED( nReturn ))
+    /* process all desired rows in the rowset - we assume rowset_pos is valid */
+    do
     {
-      return nReturn;
-    }
+      dynQuery->length= query_length;
 
-    /* execute our DELETE statement */
-    if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
-    {
-      affected_rows+= stmt->dbc->mysql.affected_rows;
-    }
+      /* append our WHERE clause to our DELETE statement */
+      nReturn = build_where_clause( stmt, dynQuery, (SQLUSMALLINT)rowset_pos );
+      if (!SQL_SUCCEEDED( nReturn ))
+      {
+        return nReturn;
+      }
 
-  } while ( ++rowset_pos <= rowset_end );
+      /* execute our DELETE statement */
+      if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+      {
+        affected_rows+= stmt->dbc->mysql->affected_rows;
+      }
+
+    } while ( ++rowset_pos <= rowset_end );
+  }
+  else if (!SQL_SUCCEEDED(nReturn))
+  {
+    return nReturn;
+  }
 
   if (nReturn == SQL_SUCCESS)
   {
@@ -1164,6 +1860,8 @@ static SQLRETURN setpos_update_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
   DESCREC *arrec;
   SQLPOINTER TargetValuePtr= NULL;
   long curr_bookmark_index= 0;
+  SQLUSMALLINT *rows;
+  my_bool      one_by_one;
 
   if ( !(table_name= find_used_table(stmt)))
   {
@@ -1184,11 +1882,16 @@ static SQLRETURN setpos_update_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
     return SQL_ERROR;
   }
 
-  rowset_pos= 0;
   rowset_end= stmt->ard->array_size;
 
+  if (!(rows= (SQLUSMALLINT *)myodbc_malloc(rowset_end * sizeof(SQLUSMALLINT),
+                                            MYF(0))))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
   /* fetch all bookmark rows in the rowset to update */
-  while (rowset_pos < rowset_end )
+  for (rowset_pos= 0; rowset_pos < rowset_end; ++rowset_pos)
   {
     if (arrec->data_ptr)
     {
@@ -1198,28 +1901,62 @@ static SQLRETURN setpos_update_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
                                         arrec->octet_length, rowset_pos);
     }
 
-    curr_bookmark_index= atol((SQLCHAR *) TargetValuePtr);
+    rows[rowset_pos]= (SQLUSMALLINT)atol((SQLCHAR *) TargetValuePtr);
+  }
 
-    dynQuery->length= query_length;
-    nReturn= build_set_clause(stmt, curr_bookmark_index, dynQuery);
-    if (nReturn == ER_ALL_COLUMNS_IGNORED)
-    {
-      set_stmt_error(stmt, "21S02",
-                     "Degree of derived table does not match column list",
-                     0);
-      return SQL_ERROR;
-    }
-    else if (nReturn == SQL_ERROR)
-    {
-      return SQL_ERROR;
-    }
-    nReturn= build_where_clause(stmt, dynQuery, (SQLUSMALLINT)curr_bookmark_index);
-    if (!SQL_SUCCEEDED(nReturn))
-      return nReturn;
+  /* update all of them with one statement if they can be found by a key */
+  nReturn= setpos_rows_by_key(stmt, dynQuery, rows, rowset_end, TRUE,
+                              &affected);
+  if ((one_by_one= (nReturn == SQL_NO_DATA)))
+  {
+    nReturn= SQL_SUCCESS;
+  }
+  else if (nReturn == ER_ALL_COLUMNS_IGNORED)
+  {
+    x_free(rows);
+    set_stmt_error(stmt, "21S02",
+                   "Degree of derived table does not match column list",
+                   0);
+    return SQL_ERROR;
+  }
+  else if (!SQL_SUCCEEDED(nReturn))
+  {
+    x_free(rows);
+    return nReturn;
+  }
 
-    if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+  for (rowset_pos= 0; rowset_pos < rowset_end; ++rowset_pos)
+  {
+    curr_bookmark_index= rows[rowset_pos];
+
+    if (one_by_one)
     {
-      affected+= mysql_affected_rows(&stmt->dbc->mysql);
+      dynQuery->length= query_length;
+      nReturn= build_set_clause(stmt, curr_bookmark_index, dynQuery);
+      if (nReturn == ER_ALL_COLUMNS_IGNORED)
+      {
+        x_free(rows);
+        set_stmt_error(stmt, "21S02",
+                       "Degree of derived table does not match column list",
+                       0);
+        return SQL_ERROR;
+      }
+      else if (nReturn == SQL_ERROR)
+      {
+        x_free(rows);
+        return SQL_ERROR;
+      }
+      nReturn= build_where_clause(stmt, dynQuery, (SQLUSMALLINT)curr_bookmark_index);
+      if (!SQL_SUCCEEDED(nReturn))
+      {
+        x_free(rows);
+        return nReturn;
+      }
+
+      if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+      {
+        affected+= mysql_affected_rows(stmt->dbc->mysql);
+      }
     }
     if (stmt->stmt_options.rowStatusPtr_ex)
     {
@@ -1229,9 +1966,8 @@ static SQLRETURN setpos_update_bookmark(STMT *stmt, DYNAMIC_STRING *dynQuery)
     {
       stmt->ird->array_status_ptr[curr_bookmark_index]= SQL_ROW_UPDATED;
     }
-
-    ++rowset_pos; 
   }
+  x_free(rows);
 
   global_set_affected_rows(stmt, affected);
   return nReturn;
@@ -1269,42 +2005,61 @@ static SQLRETURN setpos_update(STMT *stmt, SQLUSMALLINT irow,
   else
       rowset_pos= rowset_end= irow;
 
-  do /* UPDATE, irow from current row set */
+  /* the whole rowset is updated with one statement if rows have a key */
+  nReturn= irow ? SQL_NO_DATA :
+           setpos_rows_by_key(stmt, dynQuery, NULL, rowset_end, TRUE,
+                              &affected);
+
+  if (nReturn == SQL_NO_DATA)
   {
-      dynQuery->length= query_length;
-      nReturn= build_set_clause(stmt,rowset_pos,dynQuery);
-      if (nReturn == ER_ALL_COLUMNS_IGNORED)
-      {
-        /*
-          If we're updating more than one row, having all columns ignored
-          is fine. If it's just one row, that's an error.
-        */
-        if (!irow)
+    nReturn= SQL_SUCCESS;
+
+    do /* UPDATE, irow from current row set */
+    {
+        dynQuery->length= query_length;
+        nReturn= build_set_clause(stmt,rowset_pos,dynQuery);
+        if (nReturn == ER_ALL_COLUMNS_IGNORED)
         {
-          nReturn= SQL_SUCCESS;
-          continue;
+          /*
+            If we're updating more than one row, having all columns ignored
+            is fine. If it's just one row, that's an error.
+          */
+          if (!irow)
+          {
+            nReturn= SQL_SUCCESS;
+            continue;
+          }
+          else
+          {
+            set_stmt_error(stmt, "21S02",
+                           "Degree of derived table does not match column list",
+                           0);
+            return SQL_ERROR;
+          }
         }
-        else
-        {
-          set_stmt_error(stmt, "21S02",
-                         "Degree of derived table does not match column list",
-                         0);
+        else if (nReturn == SQL_ERROR)
           return SQL_ERROR;
-        }
-      }
-      else if (nReturn == SQL_ERROR)
-        return SQL_ERROR;
 
-      nReturn= build_where_clause(stmt, dynQuery, (SQLUSMALLINT)rowset_pos);
-      if (!SQL_SUCCEEDED(nReturn))
-        return nReturn;
+        nReturn= build_where_clause(stmt, dynQuery, (SQLUSMALLINT)rowset_pos);
+        if (!SQL_SUCCEEDED(nReturn))
+          return nReturn;
 
-      if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
-      {
-        affected+= mysql_affected_rows(&stmt->dbc->mysql);
-      }
+        if ( !(nReturn= exec_stmt_query(stmt, dynQuery->str, dynQuery->length, FALSE)) )
+        {
+          affected+= mysql_affected_rows(stmt->dbc->mysql);
+        }
 
-  } while ( ++rowset_pos <= rowset_end );
+    } while ( ++rowset_pos <= rowset_end );
+  }
+  else if (nReturn == ER_ALL_COLUMNS_IGNORED)
+  {
+    /* Having all columns ignored is fine for the whole rowset */
+    nReturn= SQL_SUCCESS;
+  }
+  else if (!SQL_SUCCEEDED(nReturn))
+  {
+    return nReturn;
+  }
 
   if (nReturn == SQL_SUCCESS)
       nReturn= update_setpos_status(stmt, irow, affected, SQL_ROW_UPDATED);
@@ -1341,7 +2096,7 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
     SQLULEN      insert_count= 1;           /* num rows to insert - will be real value when row is 0 (all)  */
     SQLULEN      count= 0;                  /* current row */
     SQLLEN       length;
-    NET         *net= &stmt->dbc->mysql.net;
+    NET         *net= stmt_query_net(stmt);
     SQLUSMALLINT ncol;
     long i;
     SQLCHAR      *to;
@@ -1352,6 +2107,11 @@ static SQLRETURN batch_insert( STMT *stmt, SQLULEN irow, DYNAMIC_STRING *ext_que
     DESCREC *aprec= &aprec_, *iprec= &iprec_;
     SQLRETURN res;
 
+    if (net == NULL)
+    {
+      return set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+
     desc_rec_init_ipd(iprec);
 
     stmt->stmt_options.bookmark_insert= FALSE;
@@ -1681,11 +2441,16 @@ SQLRETURN SQL_API my_SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow,
                     return set_error(stmt,MYERR_S1000, alloc_error, 0);
                 }
 
-                myodbc_mutex_lock(&stmt->dbc->lock);
+                /*
+                  The result is stored, irow > num_rows() is refused above
+                  otherwise, so the connection need not be locked
+                */
                 --irow;
                 sqlRet= SQL_SUCCESS;
                 stmt->cursor_row= (long)(stmt->current_row+irow);
                 data_seek(stmt, (my_ulonglong)stmt->cursor_row);
+                /* Columns fetched directly go to the buffers of that row */
+                ssps_bind_direct(stmt, (uint)irow);
                 stmt->current_values= fetch_row(stmt);
                 reset_getdata_position(stmt);
                 if ( stmt->fix_fields )
@@ -1696,7 +2461,6 @@ SQLRETURN SQL_API my_SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow,
                  so the MYSQL_RES is in the state we expect.
                 */
                 data_seek(stmt, (my_ulonglong)stmt->cursor_row);
-                myodbc_mutex_unlock(&stmt->dbc->lock);
                 break;
             }
 
@@ -1820,6 +2584,7 @@ MySQLSetCursorName(SQLHSTMT hstmt, SQLCHAR *name, SQLSMALLINT len)
 {
   STMT *stmt= (STMT *) hstmt;
 
+  CHECK_ASYNC(stmt);
   CLEAR_STMT_ERROR(stmt);
 
   if (!name)
@@ -1874,6 +2639,7 @@ SQLRETURN SQL_API SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow,
                             SQLUSMALLINT fOption, SQLUSMALLINT fLock)
 {
     CHECK_HANDLE(hstmt);
+    CHECK_ASYNC((STMT *)hstmt);
 
     return my_SQLSetPos(hstmt,irow,fOption,fLock);
 }
@@ -1893,6 +2659,7 @@ SQLRETURN SQL_API SQLBulkOperations(SQLHSTMT  Handle, SQLSMALLINT Operation)
   SQLSETPOSIROW irow= 0;
 
   CHECK_HANDLE(Handle);
+  CHECK_ASYNC(stmt);
 
   CLEAR_STMT_ERROR(stmt);
 
@@ -1976,6 +2743,7 @@ SQLRETURN SQL_API SQLBulkOperations(SQLHSTMT  Handle, SQLSMALLINT Operation)
 SQLRETURN SQL_API SQLCloseCursor(SQLHSTMT Handle)
 {
     CHECK_HANDLE(Handle);
+    CHECK_ASYNC((STMT *)Handle);
 
     return  my_SQLFreeStmt(Handle, SQL_CLOSE);
 }
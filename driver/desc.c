@@ -55,7 +55,7 @@
 DESC *desc_alloc(STMT *stmt, SQLSMALLINT alloc_type,
                  desc_ref_type ref_type, desc_desc_type desc_type)
 {
-  DESC *desc= (DESC *)myodbc_malloc(sizeof(DESC), MYF(MY_ZEROFILL));
+  DESC *desc= (DESC *)handle_mem_alloc(SQL_HANDLE_DESC);
   if (!desc)
     return NULL;
   /*
@@ -65,14 +65,14 @@ DESC *desc_alloc(STMT *stmt, SQLSMALLINT alloc_type,
   */
   if (myodbc_init_dynamic_array(&desc->records, sizeof(DESCREC), 0, 0))
   {
-    x_free((char *)desc);
+    handle_mem_free(SQL_HANDLE_DESC, desc);
     return NULL;
   }
 
   if (myodbc_init_dynamic_array(&desc->bookmark, sizeof(DESCREC), 0, 0))
   {
     delete_dynamic(&desc->records);
-    x_free((char *)desc);
+    handle_mem_free(SQL_HANDLE_DESC, desc);
     return NULL;
   }
 
@@ -103,7 +103,7 @@ void desc_free(DESC *desc)
     desc_free_paramdata(desc);
   delete_dynamic(&desc->records);
   delete_dynamic(&desc->bookmark);
-  x_free(desc);
+  handle_mem_free(SQL_HANDLE_DESC, desc);
 }
 
 
@@ -972,6 +972,8 @@ MySQLSetDescField(SQLHDESC hdesc, SQLSMALLINT recnum, SQLSMALLINT fldid,
     }
   }
 
+  ++desc->generation;
+
   return SQL_SUCCESS;
 }
 
@@ -1019,6 +1021,7 @@ SQLRETURN MySQLCopyDesc(SQLHDESC SourceDescHandle, SQLHDESC TargetDescHandle)
   dest->count= src->count;
   dest->rows_processed_ptr= src->rows_processed_ptr;
   memcpy(&dest->error, &src->error, sizeof(MYERROR));
+  ++dest->generation;
 
   /* TODO consistency check on target, if needed (apd) */
 
@@ -83,10 +83,16 @@ void myodbc_init(void)
     thousands_sep=myodbc_strdup(tmp->thousands_sep,MYF(0));
     thousands_sep_length=strlen(thousands_sep);
     setlocale(LC_NUMERIC,default_locale);
+    numeric_locale_init();
 
     utf8_charset_info= get_charset_by_csname("utf8", MYF(MY_CS_PRIMARY),
                                              MYF(0));
   }
+  handle_mem_init();
+  pool_init();
+  async_init();
+  cancel_init();
+  ds_cache_init();
 }
 
 
@@ -98,9 +104,15 @@ void myodbc_end()
 {
   if (!--myodbc_inited)
   {
+    async_end();
+    cancel_end();
+    ds_cache_end();
+    pool_end();
+    handle_mem_end();
     x_free(decimal_point);
     x_free(default_locale);
     x_free(thousands_sep);
+    numeric_locale_end();
 
     /* my_thread_end_wait_time was added in 5.1.14 and 5.0.32 */
 #if !defined(NONTHREADSAFE) && \
@@ -243,6 +243,8 @@ typedef struct {
   DYNAMIC_ARRAY   records;
   MYERROR         error;
   struct tagSTMT *stmt;
+  /* changes with records, so cached conversion plans can be validated */
+  uint            generation;
 
   /* SQL_DESC_ALLOC_USER-specific */
   struct {
@@ -330,14 +332,17 @@ typedef struct {
 typedef struct stmt_options
 {
   SQLUINTEGER      cursor_type;
+  SQLUINTEGER      concurrency;
   SQLUINTEGER      simulateCursor;
   SQLULEN          max_length, max_rows;
+  SQLULEN          keyset_size;     /* 0 - the whole result */
   SQLULEN          query_timeout;
   SQLUSMALLINT    *rowStatusPtr_ex; /* set by SQLExtendedFetch */
   my_bool         retrieve_data;
   SQLUINTEGER     bookmarks;
   void            *bookmark_ptr;
   my_bool         bookmark_insert;
+  SQLUINTEGER     async_enable;
 } STMT_OPTIONS;
 
 
@@ -354,12 +359,46 @@ typedef struct	tagENV
 } ENV;
 
 
+/* Server-side prepared statement, kept by the connection for reuse */
+typedef struct ssps_cache_entry
+{
+  LIST          list;
+  MYSQL_STMT    *ssps;        /* NULL while it is used by a statement */
+  ulong         thread_id;    /* connection it has been prepared on */
+  uint          charset;
+  size_t        query_length;
+  char          *query;       /* trimmed text of the query, the key */
+} SSPS_CACHE_ENTRY;
+
+
+/* SHOW KEYS columns kept by the key cache, Table to Cardinality */
+#define TABLE_KEYS_FIELDS 7
+
+/* Entries kept by the key cache of a connection */
+#define KEY_CACHE_SIZE 128
+
+/*
+  Keys of a table, as read by SHOW KEYS. The entry, its names and values
+  are allocated in one block.
+*/
+typedef struct table_keys
+{
+  LIST          list;
+  time_t        expires;
+  size_t        size;         /* of the block */
+  char          *db;          /* key of the entry, along with the table */
+  char          *table;
+  uint          row_count;
+  char          **rows;       /* TABLE_KEYS_FIELDS values per row */
+} TABLE_KEYS;
+
+
 /* Connection handler */
 
 typedef struct tagDBC
 {
   ENV           *env;
-  MYSQL         mysql;
+  MYSQL         *mysql;
   LIST          *statements;
   LIST          *exp_desc; /* explicit descriptors */
   LIST          list;
@@ -368,6 +407,8 @@ typedef struct tagDBC
   FILE          *query_log;
   char          st_error_prefix[255];
   char          *database;
+  char          database_copy[NAME_LEN + 1]; /* returned to SQLGetInfo() and
+                                                SQLGetConnectAttr() */
   SQLUINTEGER   login_timeout;
   time_t        last_query_time;
   int           txn_isolation;
@@ -376,7 +417,15 @@ typedef struct tagDBC
   ulong         net_buffer_len;
   uint          commit_flag;
 #ifdef THREAD
+  /*
+    lock is held only while the connection is used for the protocol. State
+    of a statement is not guarded by it, a statement handle is used by one
+    thread at a time. The cached session state, database, is changed with
+    both lock and session_lock held, and read with either of them.
+  */
   myodbc_mutex_t lock;
+  myodbc_mutex_t session_lock;
+  myodbc_mutex_t handles_lock;      /* guards statements and exp_desc */
 #endif
 
   my_bool       unicode;            /* Whether SQL*ConnectW was used */
@@ -386,7 +435,27 @@ typedef struct tagDBC
   DataSource    *ds;                /* data source used to connect (parsed or stored) */
   SQLULEN       sql_select_limit;   /* value of the sql_select_limit currently set for a session
                                        (SQLULEN)(-1) if wasn't set */
+  SQLULEN       max_execution_time; /* @@max_execution_time set for the session,
+                                       in seconds, 0 if it is default */
   int           need_to_wakeup;      /* Connection have been put to the pool */
+  ulong         max_allowed_packet; /* @@max_allowed_packet of the session,
+                                       0 if it has not been read yet */
+  LIST          *ssps_cache;        /* SSPS_CACHE_ENTRY, most recently used
+                                       first */
+  uint          ssps_cache_count;
+#ifdef THREAD
+  myodbc_mutex_t ssps_cache_lock;
+#endif
+  LIST          *key_cache;         /* TABLE_KEYS, most recently used first */
+  uint          key_cache_count;
+#ifdef THREAD
+  myodbc_mutex_t key_cache_lock;
+#endif
+  struct readahead *readahead;      /* reader running on the connection */
+  struct page_ahead *page_ahead;    /* page query running on the connection */
+#ifdef THREAD
+  myodbc_mutex_t readahead_lock;    /* held while a reader starts or stops */
+#endif
 } DBC;
 
 
@@ -404,6 +473,21 @@ typedef struct limit
 
 } MY_LIMIT_CLAUSE;
 
+/* Next page of a scroller, read by a background thread while the
+   application fetches the current one */
+typedef struct page_ahead
+{
+  MYSQL               *mysql;
+  char                *query;
+  unsigned long       query_len;
+  unsigned long long  offset;     /* offset of the page in the whole result */
+  MYSQL_RES           *result;    /* NULL if the query failed */
+  my_bool             running;
+#ifdef THREAD
+  my_thread_handle    thread;
+#endif
+} MY_PAGE_AHEAD;
+
 typedef struct limit_scroller
 {
    char               *query, *offset_pos;
@@ -411,6 +495,15 @@ typedef struct limit_scroller
    unsigned long long start_offset;
    unsigned long long next_offset, total_rows, query_len;
 
+   /* Keyset pagination, if the query is ordered by a unique key: pages
+      are read as key_head <last key> key_tail LIMIT <row_count> */
+   char               *key_head, *key_tail;
+   uint               key_field;  /* the key in the result */
+   char               *key_last;  /* literal of the key of the last row */
+   unsigned long long key_offset; /* offset of the row after key_last */
+
+   MY_PAGE_AHEAD      *ahead;
+
 } MY_LIMIT_SCROLLER;
 
 /* Statement primary key handler for cursors */
@@ -438,6 +531,121 @@ enum OUT_PARAM_STATE
   OPS_STREAMS_PENDING
 };
 
+/* Converts one bound column for all rows gathered in the rowset */
+typedef void (*MY_COLUMN_CONVERTER)(struct tagSTMT *stmt, uint column,
+                                    DESCREC *arrec, uint rows);
+
+/* Rows of the current block, gathered for the columnar fetch path */
+typedef struct rowset
+{
+  MYSQL_ROW           *values;
+  unsigned long       *lengths;   /* rows * field_count */
+  SQLRETURN           *res;       /* per-row conversion result */
+  uint                alloc_rows, alloc_columns;
+} MY_ROWSET;
+
+/* Row of a forward-only result, copied out of libmysql buffers */
+typedef struct readahead_row
+{
+  MYSQL_ROW           values;
+  unsigned long       *lengths;
+  size_t              size;       /* bytes taken by the row */
+} MY_READAHEAD_ROW;
+
+/* Bounded ring of rows, filled by a background thread from a result of
+   mysql_use_result() and consumed by the fetch */
+typedef struct readahead
+{
+  MYSQL_RES           *result;
+  MY_READAHEAD_ROW    **rows;
+  uint                size, head, count;
+  size_t              bytes, max_bytes;
+  my_ulonglong        consumed;   /* rows handed out to the fetch */
+  MY_READAHEAD_ROW    *current;   /* row being fetched */
+  MYSQL_ROW           pending;    /* row read, but not copied to the ring */
+  my_bool             running, stop, eof;
+#ifdef THREAD
+  my_thread_handle    thread;
+  myodbc_mutex_t      lock;
+  myodbc_cond_t       filled, drained;
+#endif
+} MY_READAHEAD;
+
+/* Function of a statement executed by a worker thread */
+typedef SQLRETURN (*MY_ASYNC_RUN)(struct tagSTMT *stmt);
+
+typedef struct async_call
+{
+  MY_ASYNC_RUN        run;        /* NULL if there is no call */
+  void                *args;      /* copy of the arguments of the call */
+  size_t              args_length;
+  SQLRETURN           rc;         /* result, once done */
+  my_bool             started, done;
+  SQLPOINTER          callback, context; /* completion notification */
+  struct tagSTMT      *next;      /* next statement waiting for a worker */
+} MY_ASYNC_CALL;
+
+/* Timer of a query the driver enforces the timeout of, see cancel.c */
+typedef struct query_timer
+{
+  struct tagDBC       *dbc;
+  unsigned long       thread_id;  /* connection to kill the query of */
+  time_t              deadline;
+  my_bool             started, fired, killing;
+  struct query_timer  *next;
+} MY_QUERY_TIMER;
+
+/* What sql_get_data() needs to know about a result column */
+typedef struct column_plan
+{
+  MYSQL_FIELD         *field;
+  SQLSMALLINT         sql_type;       /* get_sql_data_type() of the field */
+  SQLSMALLINT         default_c_type; /* C type used for SQL_C_DEFAULT */
+  my_bool             binhex;         /* binary BLOB, SQL_C_CHAR gets hex */
+  CHARSET_INFO        *charset;       /* charset of the data, NULL if unknown */
+  MY_COLUMN_CONVERTER conv;           /* NULL if the column is not bound */
+} MY_COLUMN_PLAN;
+
+/*
+  Conversion plan of the current result. Column facts are derived once per
+  result, converters are chosen again only if the ARD has been changed.
+*/
+typedef struct conv_plan
+{
+  MY_COLUMN_PLAN      *columns;
+  uint                count, alloced;
+  MYSQL_RES           *result;        /* NULL if the plan is not valid */
+  uint                result_generation;
+  DESC                *ard;
+  uint                ard_generation;
+} MY_CONV_PLAN;
+
+/*
+  Rows of the current stored result by their numbers, for scrolling and
+  positioning without walking the list of rows. Built at the first seek.
+*/
+typedef struct row_index
+{
+  MYSQL_ROWS          **rows;
+  my_ulonglong        count, alloced;
+  MYSQL_RES           *result;        /* NULL if the index is not valid */
+} MY_ROW_INDEX;
+
+
+/*
+  Keyset of a dynamic cursor: rows are identified by the unique key of the
+  table, so that values of a rowset are refreshed by the key alone. The whole
+  query runs again only when a rowset leaves the keyset.
+*/
+typedef struct keyset
+{
+  MYSQL_RES           *result;        /* result the keyset is of, or NULL */
+  long                first_row;      /* first row of the keyset           */
+  int                 usable;         /* -1 not checked yet                */
+  uint                key_count;
+  uint                key_column[MY_MAX_PK_PARTS]; /* key fields of result */
+} MY_KEYSET;
+
 
 /* Main statement handler */
 
@@ -460,6 +668,10 @@ typedef struct tagSTMT
 
   MY_PARSED_QUERY	query, orig_query;
   DYNAMIC_ARRAY     *param_bind;
+  NET               query_net;  /* not connected, queries with parameters are
+                                   built in its buffer, see stmt_query_net() */
+  MY_QUERY_TEMPLATE query_template; /* query compiled by prepare() for
+                                       insert_params() */
 
   unsigned long     *lengths; /* used to set lengths if we shuffle field values
                          of the resultset of auxiliary query or if we fix_fields. */
@@ -502,8 +714,18 @@ typedef struct tagSTMT
 
   MYSQL_STMT *ssps;
   MYSQL_BIND *result_bind;
+  my_bool    *result_direct; /* columns fetched right into the ARD buffers */
+  SSPS_CACHE_ENTRY *ssps_entry; /* key to cache ssps with, NULL if it is not
+                                   to be cached */
 
   MY_LIMIT_SCROLLER scroller;
+  MY_ROWSET         rowset;
+  MY_CONV_PLAN      plan;
+  uint              result_generation; /* bumped as results come and go */
+  MY_ROW_INDEX      row_index;
+  MY_KEYSET         keyset;
+  MY_READAHEAD      *readahead;
+  MY_ASYNC_CALL     async;
 
   enum OUT_PARAM_STATE out_params_state;
 } STMT;
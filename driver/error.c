@@ -269,6 +269,9 @@ void translate_error(char *save_state, myodbc_errid errid, uint mysql_err)
         case CR_CONNECTION_ERROR:
         case CR_SERVER_GONE_ERROR:
         case CR_SERVER_LOST:
+#ifdef CR_SERVER_LOST_EXTENDED
+        case CR_SERVER_LOST_EXTENDED:
+#endif
             state= "08S01";
             break;
         case ER_MUST_CHANGE_PASSWORD_LOGIN:
@@ -365,19 +368,22 @@ void set_mem_error(MYSQL *mysql)
 */
 SQLRETURN handle_connection_error(STMT *stmt)
 {
-  unsigned int err= mysql_errno(&stmt->dbc->mysql);
+  unsigned int err= mysql_errno(stmt->dbc->mysql);
   switch (err) {
   case 0:  /* no error */
     return SQL_SUCCESS;
   case CR_SERVER_GONE_ERROR:
   case CR_SERVER_LOST:
-    return set_stmt_error(stmt, "08S01", mysql_error(&stmt->dbc->mysql), err);
+#ifdef CR_SERVER_LOST_EXTENDED
+  case CR_SERVER_LOST_EXTENDED:
+#endif
+    return set_stmt_error(stmt, "08S01", mysql_error(stmt->dbc->mysql), err);
   case CR_OUT_OF_MEMORY:
-    return set_stmt_error(stmt, "HY001", mysql_error(&stmt->dbc->mysql), err);
+    return set_stmt_error(stmt, "HY001", mysql_error(stmt->dbc->mysql), err);
   case CR_COMMANDS_OUT_OF_SYNC:
   case CR_UNKNOWN_ERROR:
   default:
-    return set_stmt_error(stmt, "HY000", mysql_error(&stmt->dbc->mysql), err);
+    return set_stmt_error(stmt, "HY000", mysql_error(stmt->dbc->mysql), err);
   }
 }
 
@@ -388,8 +394,17 @@ SQLRETURN handle_connection_error(STMT *stmt)
 */
 my_bool is_connection_lost(uint errcode)
 {
-  if (errcode==CR_SERVER_GONE_ERROR || errcode==CR_SERVER_LOST)
+  switch (errcode)
   {
+  case CR_SERVER_GONE_ERROR:
+  case CR_SERVER_LOST:
+#ifdef CR_SERVER_LOST_EXTENDED
+  case CR_SERVER_LOST_EXTENDED:
+#endif
+#ifdef ER_CLIENT_INTERACTION_TIMEOUT
+  /* Sent by the server before it closes a connection idle for too long */
+  case ER_CLIENT_INTERACTION_TIMEOUT:
+#endif
     return 1;
   }
 
@@ -28,17 +28,94 @@
 */
 
 #include "driver.h"
-#include <locale.h>
+#include "mysqld_error.h"
+
+
+/*
+  Checks if the token at the index is the keyword as a whole word.
+*/
+static my_bool token_is(MY_PARSED_QUERY *pq, uint index, const char *keyword)
+{
+  const char *token= get_token(pq, index);
+  int        length= (int)strlen(keyword);
+
+  return token != NULL && BYTES_LEFT(pq, token) >= length
+      && !myodbc_casecmp(token, keyword, length)
+      && (BYTES_LEFT(pq, token) == length
+       || (!isalnum((unsigned char)token[length]) && token[length] != '_'
+        && token[length] != '$'));
+}
+
+
+/*
+  Checks if the query that failed for a lost connection can be run once more
+  on a new one: a plain read that locks and writes nothing, outside of a
+  transaction, in a session the driver can set up again. server_status is
+  the status of the session before the query was sent, the connection may
+  have been lost with a transaction open.
+*/
+static my_bool can_retry_query(STMT *stmt, uint server_status)
+{
+  DBC *dbc= stmt->dbc;
+  uint i;
+
+  if (dbc->ds->liveness_check != LIVENESS_CHECK_RETRY
+   || !is_connection_lost(mysql_errno(dbc->mysql))
+   || !is_select_statement(&stmt->query)
+   || !(server_status & SERVER_STATUS_AUTOCOMMIT)
+   || (server_status & SERVER_STATUS_IN_TRANS)
+   || dbc->txn_isolation != DEFAULT_TXN_ISOLATION)
+  {
+    return FALSE;
+  }
+
+  /* SELECT ... INTO writes, FOR UPDATE/SHARE and LOCK IN SHARE MODE lock */
+  for (i= 1; i < TOKEN_COUNT(&stmt->query); ++i)
+  {
+    if (token_is(&stmt->query, i, "INTO")
+     || (token_is(&stmt->query, i - 1, "FOR")
+      && (token_is(&stmt->query, i, "UPDATE")
+       || token_is(&stmt->query, i, "SHARE")))
+     || (token_is(&stmt->query, i - 1, "LOCK")
+      && token_is(&stmt->query, i, "IN")))
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : frees the query to execute unless it is the query of the
+             statement, or has been built in the buffer of the statement
+*/
+static void free_query(STMT *stmt, char *query)
+{
+  if (query != GET_QUERY(&stmt->query)
+   && query != (char *)stmt->query_net.buff)
+  {
+    x_free(query);
+  }
+}
 
 
 /*
   @type    : myodbc3 internal
   @purpose : internal function to execute query and return result
-  frees query if query != stmt->query
+  frees query, unless free_query() keeps it
 */
 SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
 {
     int error= SQL_ERROR, native_error= 0;
+    uint hinted= 0;
+    SQLULEN timeout= stmt->stmt_options.query_timeout;
+    my_bool is_select= is_select_statement(&stmt->query);
+    MY_QUERY_TIMER timer;
+
+    timer.started= FALSE;
 
     if (!query)
     {
@@ -46,36 +123,64 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       goto skip_unlock_exit;
     }
 
-    if(!SQL_SUCCEEDED(set_sql_select_limit(stmt->dbc,
-                      stmt->stmt_options.max_rows, TRUE)))
+    if (query_length == 0)
+    {
+      query_length= strlen(query);
+    }
+
+    /* Limits of a query sent as text can come with the query, then session
+       variables are not touched */
+    if (!ssps_used(stmt))
+    {
+      char *hinted_query= add_limit_hints(stmt, query, &query_length, &hinted);
+
+      if (hinted_query != NULL)
+      {
+        free_query(stmt, query);
+        query= hinted_query;
+      }
+    }
+
+    /* @@max_execution_time applies to SELECT only, the timer below takes
+       care of other statements */
+    if ((!(hinted & HINT_SELECT_LIMIT)
+      && !SQL_SUCCEEDED(set_sql_select_limit(stmt->dbc,
+                          stmt->stmt_options.max_rows, TRUE)))
+     || (!(hinted & HINT_EXECUTION_TIME) && is_select
+      && !SQL_SUCCEEDED(set_max_execution_time(stmt->dbc,
+                          stmt->stmt_options.query_timeout, TRUE))))
     {
       /* The error is set for DBC, copy it into STMT */
       set_stmt_error(stmt, stmt->dbc->error.sqlstate,
                      stmt->dbc->error.message,
                      stmt->dbc->error.native_error);
 
-      /* if setting sql_select_limit fails, the query will probably fail anyway too */
+      /* if setting the limits fails, the query will probably fail anyway too */
       goto skip_unlock_exit;
     }
 
-    if (query_length == 0)
-    {
-      query_length= strlen(query);
-    }
-
     MYLOG_QUERY(stmt, query);
     myodbc_mutex_lock(&stmt->dbc->lock);
+    readahead_pause(stmt->dbc);
 
     if ( check_if_server_is_alive( stmt->dbc ) )
     {
       set_stmt_error( stmt, "08S01" /* "HYT00" */,
-                      mysql_error(&stmt->dbc->mysql),
-                      mysql_errno(&stmt->dbc->mysql));
+                      mysql_error(stmt->dbc->mysql),
+                      mysql_errno(stmt->dbc->mysql));
       translate_error(stmt->error.sqlstate, MYERR_08S01 /* S1000 */,
-                      mysql_errno(&stmt->dbc->mysql));
+                      mysql_errno(stmt->dbc->mysql));
       goto exit;
     }
 
+    /* The server enforces the timeout only for SELECT, and only since 5.7.8 */
+    if (timeout > 0 && timeout != (SQLULEN)-1
+     && (!is_minimum_version(stmt->dbc->mysql->server_version, "5.7.8")
+      || !is_select))
+    {
+      query_timer_start(&timer, stmt->dbc, timeout);
+    }
+
     /* Simplifying task so far - we will do "LIMIT" scrolling forward only
      * and when no musltiple statements is allowed - we can't now parse query
      * that well to detect multiple queries.
@@ -101,7 +206,7 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       scroller_move(stmt);
       MYLOG_QUERY(stmt, stmt->scroller.query);
 
-      native_error= mysql_real_query(&stmt->dbc->mysql, stmt->scroller.query,
+      native_error= mysql_real_query(stmt->dbc->mysql, stmt->scroller.query,
                                   (unsigned long)stmt->scroller.query_len);
     }
       /* Not using ssps for scroller so far. Relaxing a bit condition
@@ -130,24 +235,42 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
     }
     else
     {
+      uint server_status;
+
       MYLOG_QUERY(stmt, "Using direct execution");
       /* Need to close ps handler if it is open as our relsult will be generated
          by direct execution. and ps handler may create some chaos */
       ssps_close(stmt);
-      native_error= mysql_real_query(&stmt->dbc->mysql,query,query_length);
+      server_status= stmt->dbc->mysql->server_status;
+      native_error= mysql_real_query(stmt->dbc->mysql,query,query_length);
+
+      /* The limits are set again for the new session. A query timed out by
+         the driver is not retried, the time is up anyway */
+      if (native_error && !timer.started
+       && can_retry_query(stmt, server_status)
+       && myodbc_reconnect(stmt->dbc)
+       && ((hinted & HINT_SELECT_LIMIT)
+        || SQL_SUCCEEDED(set_sql_select_limit(stmt->dbc,
+                           stmt->stmt_options.max_rows, FALSE)))
+       && ((hinted & HINT_EXECUTION_TIME) || !is_select
+        || SQL_SUCCEEDED(set_max_execution_time(stmt->dbc, timeout, FALSE))))
+      {
+        MYLOG_QUERY(stmt, "Connection lost, running the query again");
+        native_error= mysql_real_query(stmt->dbc->mysql,query,query_length);
+      }
     }
 
     MYLOG_QUERY(stmt, "query has been executed");
 
     if (native_error)
     {
-      MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
-      set_stmt_error(stmt, "HY000", mysql_error(&stmt->dbc->mysql),
-                     mysql_errno(&stmt->dbc->mysql));
+      MYLOG_QUERY(stmt, mysql_error(stmt->dbc->mysql));
+      set_stmt_error(stmt, "HY000", mysql_error(stmt->dbc->mysql),
+                     mysql_errno(stmt->dbc->mysql));
 
       /* For some errors - translating to more appropriate status */
       translate_error(stmt->error.sqlstate, MYERR_S1000,
-                      mysql_errno(&stmt->dbc->mysql));
+                      mysql_errno(stmt->dbc->mysql));
       goto exit;
     }
 
@@ -156,8 +279,8 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
       /* Query was supposed to return result, but result is NULL*/
       if (returned_result(stmt))
       {
-        set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                mysql_errno(&stmt->dbc->mysql));
+        set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+                mysql_errno(stmt->dbc->mysql));
         goto exit;
       }
       else /* Query was not supposed to return a result */
@@ -189,8 +312,8 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
     {
       if (bind_result(stmt) || get_result(stmt))
       {
-          set_error(stmt, MYERR_S1000, mysql_error(&stmt->dbc->mysql),
-                  mysql_errno(&stmt->dbc->mysql));
+          set_error(stmt, MYERR_S1000, mysql_error(stmt->dbc->mysql),
+                  mysql_errno(stmt->dbc->mysql));
           goto exit;
       }
       /* Caching row counts for queries returning resultset as well */
@@ -201,14 +324,37 @@ SQLRETURN do_query(STMT *stmt,char *query, SQLULEN query_length)
     error= SQL_SUCCESS;
 
 exit:
+    if (query_timer_stop(&timer) && error != SQL_SUCCESS)
+    {
+      set_error(stmt, MYERR_HYT00, NULL, 0);
+    }
+
+    /* Prepared statements and keys cached before may be out of date */
+    if (error == SQL_SUCCESS
+      && (stmt->dbc->ssps_cache != NULL || stmt->dbc->key_cache != NULL)
+      && changes_schema(&stmt->query))
+    {
+      ssps_cache_free(stmt->dbc);
+      key_cache_free(stmt->dbc);
+    }
+
     myodbc_mutex_unlock(&stmt->dbc->lock);
 
-skip_unlock_exit:
-    if (query != GET_QUERY(&stmt->query))
+    /* Next pages are read in background, and by the key, if the query is
+       ordered by a unique one. The keys are looked up first, as that takes
+       the lock by itself */
+    if (error == SQL_SUCCESS && scroller_exists(stmt))
     {
-      x_free(query);
+      scroller_keyset_init(stmt);
+
+      myodbc_mutex_lock(&stmt->dbc->lock);
+      scroller_read_ahead(stmt);
+      myodbc_mutex_unlock(&stmt->dbc->lock);
     }
 
+skip_unlock_exit:
+    free_query(stmt, query);
+
     /*
       If the original query was modified, we reset stmt->query so that the
       next execution re-starts with the original query.
@@ -217,39 +363,153 @@ skip_unlock_exit:
     {
       copy_parsed_query(&stmt->orig_query, &stmt->query);
       reset_parsed_query(&stmt->orig_query, NULL, NULL, NULL);
+      RESET_TEMPLATE(&stmt->query_template);
     }
 
     return error;
 }
 
 
+/*
+  Upper bound of the length of a parameter value in the query text: quoted
+  and fully escaped, as insert_param() reserves for it, with a charset
+  introducer. Known for fixed size C types and for character or binary data
+  with a length in the indicator, 0 otherwise.
+*/
+static ulong param_max_width(DESC *apd, DESCREC *aprec, SQLULEN row)
+{
+  ulong width;
+
+  switch (aprec->concise_type)
+  {
+    case SQL_C_BIT:
+    case SQL_C_TINYINT:
+    case SQL_C_STINYINT:
+    case SQL_C_UTINYINT:
+      width= 4;
+      break;
+    case SQL_C_SHORT:
+    case SQL_C_SSHORT:
+    case SQL_C_USHORT:
+      width= 6;
+      break;
+    case SQL_C_LONG:
+    case SQL_C_SLONG:
+    case SQL_C_ULONG:
+      width= 11;
+      break;
+    case SQL_C_SBIGINT:
+    case SQL_C_UBIGINT:
+      width= 20;
+      break;
+    case SQL_C_FLOAT:
+    case SQL_C_DOUBLE:
+      width= 40;
+      break;
+    case SQL_C_DATE:
+    case SQL_C_TYPE_DATE:
+      width= 10;
+      break;
+    case SQL_C_TIME:
+    case SQL_C_TYPE_TIME:
+      width= 8;
+      break;
+    case SQL_C_TIMESTAMP:
+    case SQL_C_TYPE_TIMESTAMP:
+      width= 29;
+      break;
+    case SQL_C_CHAR:
+    case SQL_C_BINARY:
+      {
+        SQLLEN *octet_length_ptr;
+
+        if (aprec->octet_length_ptr == NULL)
+        {
+          return 0;
+        }
+
+        octet_length_ptr= ptr_offset_adjust(aprec->octet_length_ptr,
+                                            apd->bind_offset_ptr,
+                                            apd->bind_type,
+                                            sizeof(SQLLEN), row);
+        /* SQL_NTS, data at execution etc. */
+        if (*octet_length_ptr < 0)
+        {
+          return 0;
+        }
+
+        width= (ulong) *octet_length_ptr;
+        break;
+      }
+    default:
+      return 0;
+  }
+
+  return 2 * width + 2 + MY_CS_NAME_SIZE + 1;
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : insert sql params at parameter positions
   @param[in]      stmt        Statement
   @param[in]      row         Parameters row
-  @param[in,out]  finalquery  if NULL, final query is not copied
+  @param[in,out]  finalquery  if not NULL, set to the final query
   @param[in,out]  length      Length of the query. Pointed value is used as initial offset
-  @comment : it allocates and modifies finalquery (when finalquery!=NULL),
-             so passing stmt->query->query can lead to memory leak.
+  @comment : the query is built in the buffer of the statement, which
+             finalquery points to. It is valid until the next query of
+             the statement is built. The connection does not need to be
+             locked.
 */
 
 SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
                         SQLULEN *finalquery_length)
 {
-  char *query= GET_QUERY(&stmt->query), *to;
-  uint i,length, had_info= 0;
-  NET *net;
+  char *query= GET_QUERY(&stmt->query), *to= NULL;
+  uint i, had_info= 0;
+  NET *net= NULL;
+  MY_QUERY_TEMPLATE *tpl= &stmt->query_template;
+  MY_QUERY_SLICE *slice;
   SQLRETURN rc= SQL_SUCCESS;
 
-  int mutex_was_locked= myodbc_mutex_trylock(&stmt->dbc->lock);
+  /* Parameters of server side prepared statement are bound instead */
+  if (!ssps_used(stmt))
+  {
+    ulong width= 1;  /* terminating '\0' */
 
-  net= &stmt->dbc->mysql.net;
-  to= (char*) net->buff + (finalquery_length!= NULL ? *finalquery_length : 0);
+    if (!(net= stmt_query_net(stmt)))
+    {
+      goto memerror;
+    }
 
-  if (!stmt->dbc->ds->dont_use_set_locale)
-  {
-    setlocale(LC_NUMERIC, "C");  /* force use of '.' as decimal point */
+    /* The query could have been changed since prepare(), e.g. for
+       WHERE CURRENT OF */
+    if (!TEMPLATE_IS_FOR(tpl, &stmt->query)
+      && build_query_template(tpl, &stmt->query))
+    {
+      goto memerror;
+    }
+
+    assert(tpl->slice.elements == stmt->param_count + 1);
+
+    /* Growing the buffer once is enough unless some value is longer than
+       known in advance */
+    for (i= 0; i < stmt->param_count; ++i)
+    {
+      DESCREC *aprec= desc_get_rec(stmt->apd, i, FALSE);
+
+      if (aprec != NULL)
+      {
+        width+= param_max_width(stmt->apd, aprec, row);
+      }
+    }
+
+    to= (char*) net->buff + (finalquery_length!= NULL ? *finalquery_length : 0);
+
+    if (!(to= extend_buffer(net, to, tpl->literal_length + width)))
+    {
+      goto memerror;
+    }
   }
 
   if (adjust_param_bind_array(stmt) )
@@ -261,7 +521,6 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
   {
     DESCREC *aprec= desc_get_rec(stmt->apd, i, FALSE);
     DESCREC *iprec= desc_get_rec(stmt->ipd, i, FALSE);
-    char *pos;
     MYSQL_BIND * bind;
 
     if (stmt->dummy_state != ST_DUMMY_PREPARED &&
@@ -283,16 +542,14 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
     }
     else
     {
-      pos= get_param_pos(&stmt->query, i);
-      length= (uint) (pos-query);
+      slice= TEMPLATE_SLICE(tpl, i);
 
-      if ( !(to= add_to_buffer(net,to,query,length)) )
+      if ( !(to= add_to_buffer(net, to, query + slice->offset,
+                               slice->length)) )
       {
         goto memerror;
       }
 
-      query= pos+1;  /* Skip '?' */
-
       rc= insert_param(stmt, (uchar*)&to, stmt->apd, aprec, iprec, row);
     }
 
@@ -319,9 +576,10 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
 
   if (!ssps_used(stmt))
   {
-    length= (uint) (GET_QUERY_END(&stmt->query) - query);
+    slice= TEMPLATE_SLICE(tpl, stmt->param_count);
 
-    if ( !(to= add_to_buffer(net, to, query, length + 1)) )
+    if ( !(to= add_to_buffer(net, to, query + slice->offset,
+                             slice->length + 1)) )
     {
       goto memerror;
     }
@@ -333,41 +591,15 @@ SQLRETURN insert_params(STMT *stmt, SQLULEN row, char **finalquery,
 
     if (finalquery!=NULL)
     {
-      if ( !(to= (char*) myodbc_memdup((char*) net->buff,
-        (uint) (to - (char*) net->buff),MYF(0))) )
-      {
-        goto memerror;
-      }
-    }
-
-    if (finalquery!=NULL)
-    {
-      *finalquery= to;
+      *finalquery= (char*) net->buff;
     }
   }
 
-  if (!mutex_was_locked)
-  {
-    myodbc_mutex_unlock(&stmt->dbc->lock);
-  }
-
-  if (!stmt->dbc->ds->dont_use_set_locale)
-  {
-    setlocale(LC_NUMERIC,default_locale);
-  }
-
-
-
   return rc;
 
 memerror:      /* Too much data */
   rc= set_error(stmt,MYERR_S1001,NULL,4001);
 error:
-  /* ! was _already_ locked, when we tried to lock */
-  if (!mutex_was_locked)
-    myodbc_mutex_unlock(&stmt->dbc->lock);
-  if (!stmt->dbc->ds->dont_use_set_locale)
-    setlocale(LC_NUMERIC,default_locale);
   return rc;
 }
 
@@ -533,7 +765,7 @@ SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
 
 
         if (has_utf8_maxlen4 &&
-            !is_minimum_version(stmt->dbc->mysql.server_version, "5.5.3"))
+            !is_minimum_version(stmt->dbc->mysql->server_version, "5.5.3"))
         {
           return set_stmt_error(stmt, "HY000",
                                 "Server does not support 4-byte encoded "
@@ -580,28 +812,21 @@ SQLRETURN convert_c_type2str(STMT *stmt, SQLSMALLINT ctype, DESCREC *iprec,
         *res= buff;
         break;
     case SQL_C_FLOAT:
-      if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
-      {
-        sprintf(buff, "%.17e", *((float*) *res));
-      }
-      else
-      {
-        /* We should perpare this data for string comparison */
-        sprintf(buff, "%.15e", *((float*) *res));
-      }
-      *length= strlen(*res= buff);
-      break;
     case SQL_C_DOUBLE:
-      if ( iprec->concise_type != SQL_NUMERIC && iprec->concise_type != SQL_DECIMAL )
-      {
-        sprintf(buff,"%.17e",*((double*) *res));
-      }
-      else
       {
+        double value= ctype == SQL_C_FLOAT ? *((float*) *res) :
+                                             *((double*) *res);
         /* We should perpare this data for string comparison */
-        sprintf(buff,"%.15e",*((double*) *res));
+        my_bool exact= iprec->concise_type == SQL_NUMERIC ||
+                       iprec->concise_type == SQL_DECIMAL;
+
+        if (!(*length= myodbc_d2str(value, buff, exact)))
+        {
+          return set_stmt_error(stmt, "22003", "Numeric value out of range",
+                                0);
+        }
+        *res= buff;
       }
-      *length= strlen(*res= buff);
       break;
     case SQL_C_DATE:
     case SQL_C_TYPE_DATE:
@@ -769,7 +994,8 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
     char buff[128], *data= NULL;
     BOOL convert= FALSE, free_data= FALSE;
     DBC *dbc= stmt->dbc;
-    NET *net= &dbc->mysql.net;
+    /* Parameters are rendered in the buffer of the statement */
+    NET *net= &stmt->query_net;
     SQLLEN *octet_length_ptr= NULL;
     SQLLEN *indicator_ptr= NULL;
     SQLRETURN result= SQL_SUCCESS;
@@ -1214,7 +1440,7 @@ SQLRETURN insert_param(STMT *stmt, uchar *place4param, DESC* apd,
           goto memerror;
         }
 
-        to+= mysql_real_escape_string(&dbc->mysql, to, data, length);
+        to+= mysql_real_escape_string(dbc->mysql, to, data, length);
         to= add_to_buffer(net, to, "'", 1);
       }
     }
@@ -1291,8 +1517,14 @@ SQLRETURN do_my_pos_cursor( STMT *pStmt, STMT *pStmtCursor )
 
 SQLRETURN SQL_API SQLExecute(SQLHSTMT hstmt)
 {
+  SQLRETURN rc;
+
   CHECK_HANDLE(hstmt);
 
+  if (async_requested((STMT *)hstmt) &&
+      async_call((STMT *)hstmt, my_SQLExecute, NULL, 0, &rc))
+    return rc;
+
   return my_SQLExecute((STMT *)hstmt);
 }
 
@@ -1322,6 +1554,242 @@ BOOL map_error_to_param_status( SQLUSMALLINT *param_status_ptr, SQLRETURN rc)
 }
 
 
+/*
+  @type    : myodbc3 internal
+  @purpose : sends the multi-row INSERT built so far in the buffer of the
+             statement, the part of the query after the VALUES list is
+             appended to it in place
+*/
+static SQLRETURN send_insert_batch(STMT *stmt, SQLULEN batch_length,
+                                   const char *tail, ulong tail_length)
+{
+  NET  *net= &stmt->query_net;
+  char *to= add_to_buffer(net, (char *)net->buff + batch_length, tail,
+                          tail_length + 1);
+
+  if (to == NULL)
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  return do_query(stmt, (char *)net->buff, batch_length + tail_length);
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : checks if the batch that failed left nothing behind: no row was
+             reported as inserted, and the server is in a transaction, i.e.
+             the rows went to a transactional engine that rolled back the
+             statement. A deadlock or a lock wait timeout may have rolled back
+             the whole transaction, then the rows can't be sent once more.
+*/
+static my_bool batch_rolled_back(STMT *stmt)
+{
+  MYSQL        *mysql= stmt->dbc->mysql;
+  my_ulonglong  affected= mysql_affected_rows(mysql);
+
+  return (affected == 0 || affected == (my_ulonglong)~0)
+      && (mysql->server_status & SERVER_STATUS_IN_TRANS)
+      && stmt->error.native_error != ER_LOCK_DEADLOCK
+      && stmt->error.native_error != ER_LOCK_WAIT_TIMEOUT;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : executes INSERT with an array of parameters as few multi-row
+             INSERTs as max_length permits. VALUES list of each paramset is
+             appended to the list of the 1st paramset in the batch. If a
+             batch fails and batch_rolled_back() confirms nothing of it was
+             applied, its paramsets are executed again one by one to get the
+             status of each of them. Otherwise all paramsets of the batch get
+             its error, as sending them again could insert rows twice.
+*/
+static SQLRETURN execute_batched_insert(STMT *stmt, char *values_begin,
+                                        char *values_end, ulong max_length)
+{
+  NET          *net= &stmt->query_net;
+  ulong         prefix_length= (ulong)(values_begin - GET_QUERY(&stmt->query));
+  ulong         tail_length= (ulong)(GET_QUERY_END(&stmt->query) - values_end);
+  SQLULEN       row, i, length, batch_length= 0, batch_first= 0;
+  SQLULEN       single_until= 0;
+  uint          batch_rows= 0;
+  int           one_of_params_not_succeded= 0, all_parameters_failed= 1;
+  int           connection_failure= 0;
+  SQLRETURN     rc= SQL_SUCCESS, row_rc;
+  SQLUSMALLINT *param_operation_ptr, *param_status_ptr, *lastError= NULL;
+
+  for (row= 0; row <= stmt->apd->array_size; ++row)
+  {
+    my_bool send= row == stmt->apd->array_size;
+
+    if (!send)
+    {
+      param_operation_ptr= ptr_offset_adjust(stmt->apd->array_status_ptr,
+                                             NULL,
+                                             0/*SQL_BIND_BY_COLUMN*/,
+                                             sizeof(SQLUSMALLINT), row);
+      param_status_ptr= ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                          NULL,
+                                          0/*SQL_BIND_BY_COLUMN*/,
+                                          sizeof(SQLUSMALLINT), row);
+      if (stmt->ipd->rows_processed_ptr)
+        *stmt->ipd->rows_processed_ptr+= 1;
+
+      if (param_operation_ptr
+        && *param_operation_ptr == SQL_PARAM_IGNORE)
+      {
+        if (param_status_ptr)
+          *param_status_ptr= SQL_PARAM_UNUSED;
+
+        continue;
+      }
+
+      /* The paramset is built after the batch, as a complete query */
+      length= batch_rows ? batch_length + 1 : 0;
+      row_rc= insert_params(stmt, row, NULL, &length);
+
+      /*
+        If it doesn't fit or could not be built there, the batch is sent and
+        the paramset starts the next one. Paramsets of a failed batch are
+        sent alone.
+      */
+      if (batch_rows && (row <= single_until || !SQL_SUCCEEDED(row_rc)
+                         || length + 1 > max_length))
+      {
+        send= TRUE;
+      }
+      else
+      {
+        if (map_error_to_param_status(param_status_ptr, row_rc))
+        {
+          lastError= param_status_ptr;
+        }
+
+        if (row_rc != SQL_SUCCESS)
+        {
+          one_of_params_not_succeded= 1;
+        }
+
+        if (!SQL_SUCCEEDED(row_rc))
+        {
+          continue;
+        }
+
+        if (batch_rows == 0)
+        {
+          batch_length= length - tail_length;
+          batch_first= row;
+        }
+        else
+        {
+          /* Moving VALUES list of the paramset to the end of the batch */
+          char *values= (char*)net->buff + batch_length + 1 + prefix_length;
+          SQLULEN values_length= length - (batch_length + 1) - prefix_length
+                                 - tail_length;
+
+          net->buff[batch_length]= ',';
+          memmove(net->buff + batch_length + 1, values, values_length);
+          batch_length+= 1 + values_length;
+        }
+
+        ++batch_rows;
+        continue;
+      }
+    }
+
+    if (batch_rows == 0)
+    {
+      continue;
+    }
+
+    if (!connection_failure)
+    {
+      rc= send_insert_batch(stmt, batch_length, values_end, tail_length);
+    }
+    else
+    {
+      /* with broken connection we always return error for all next queries */
+      rc= SQL_ERROR;
+    }
+
+    if (is_connection_lost(stmt->error.native_error)
+      && handle_connection_error(stmt))
+    {
+      connection_failure= 1;
+    }
+
+    if (!SQL_SUCCEEDED(rc) && !connection_failure && batch_rows > 1
+      && batch_rolled_back(stmt))
+    {
+      /* Going back to the 1st paramset of the batch to send them one by one */
+      if (stmt->ipd->rows_processed_ptr)
+        *stmt->ipd->rows_processed_ptr-= row - batch_first
+                                         + (row < stmt->apd->array_size);
+      single_until= row;
+      row= batch_first - 1;
+      batch_rows= 0;
+      CLEAR_STMT_ERROR(stmt);
+      continue;
+    }
+
+    /* Paramsets that were sent get the status of their batch */
+    for (i= batch_first; i < row; ++i)
+    {
+      param_status_ptr= ptr_offset_adjust(stmt->ipd->array_status_ptr,
+                                          NULL,
+                                          0/*SQL_BIND_BY_COLUMN*/,
+                                          sizeof(SQLUSMALLINT), i);
+      if (param_status_ptr
+        && (*param_status_ptr == SQL_PARAM_SUCCESS
+          || *param_status_ptr == SQL_PARAM_SUCCESS_WITH_INFO)
+        && map_error_to_param_status(param_status_ptr, rc))
+      {
+        lastError= param_status_ptr;
+      }
+    }
+
+    if (rc != SQL_SUCCESS)
+    {
+      one_of_params_not_succeded= 1;
+    }
+    else
+    {
+      all_parameters_failed= 0;
+    }
+
+    batch_rows= 0;
+
+    /* Processing the paramset that did not make it into the batch again */
+    if (row < stmt->apd->array_size)
+    {
+      if (stmt->ipd->rows_processed_ptr)
+        *stmt->ipd->rows_processed_ptr-= 1;
+      --row;
+    }
+  }
+
+  /* Changing status for last detected error to SQL_PARAM_ERROR as we have
+     diagnostics for it */
+  if (lastError != NULL)
+  {
+    *lastError= SQL_PARAM_ERROR;
+  }
+
+  if (all_parameters_failed)
+  {
+    return SQL_ERROR;
+  }
+  else if (one_of_params_not_succeded != 0)
+  {
+    return SQL_SUCCESS_WITH_INFO;
+  }
+
+  return rc;
+}
+
+
 /*
   @type    : myodbc3 internal
   @purpose : executes a prepared statement, using the current values
@@ -1331,12 +1799,13 @@ BOOL map_error_to_param_status( SQLUSMALLINT *param_status_ptr, SQLRETURN rc)
 
 SQLRETURN my_SQLExecute( STMT *pStmt )
 {
-  char       *query, *cursor_pos;
+  char       *query, *cursor_pos, *values_begin, *values_end;
   int         dae_rec, is_select_stmt, one_of_params_not_succeded= 0;
   int         connection_failure= 0;
   STMT       *pStmtCursor = pStmt;
   SQLRETURN   rc;
   SQLULEN     row, length= 0;
+  ulong       max_length;
 
   SQLUSMALLINT *param_operation_ptr= NULL, *param_status_ptr= NULL, *lastError= NULL;
 
@@ -1398,15 +1867,32 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
     *pStmt->ipd->rows_processed_ptr= 0;
   }
 
-  /* Locking if we have params array for "SELECT" statemnt */
-  /* if param_count is zero, the rest probably are artifacts(not reset
-     attributes) from a previously executed statement. besides this lock
-     is not needed when there are no params*/
-  if (pStmt->param_count && pStmt->apd->array_size > 1 && is_select_stmt)
+  /*
+    Paramsets of INSERT ... VALUES are sent as multi-row INSERTs, if that is
+    enabled. It is not by default, as a failed batch that was not rolled back
+    can't tell which of its rows went in.
+  */
+  if (!is_select_stmt && pStmt->param_count && pStmt->apd->array_size > 1
+    && pStmt->dbc->ds->multi_row_inserts
+    && desc_find_dae_rec(pStmt->apd) < 0
+    && find_insert_values(&pStmt->query, &values_begin, &values_end)
+    && (max_length= get_max_allowed_packet(pStmt->dbc)) > 0)
   {
-    myodbc_mutex_lock(&pStmt->dbc->lock);
+    max_length= myodbc_min(max_length, pStmt->dbc->mysql->net.max_packet_size);
+
+    /* Only text protocol allows to change the query */
+    ssps_close(pStmt);
+
+    rc= execute_batched_insert(pStmt, values_begin, values_end, max_length);
+
+    if (pStmt->dummy_state == ST_DUMMY_PREPARED)
+      pStmt->dummy_state= ST_DUMMY_EXECUTED;
+
+    return rc;
   }
 
+  /* Paramsets of "SELECT" are joined with "UNION ALL" in the buffer of the
+     statement, so the connection is not locked for that */
   for (row= 0; row < pStmt->apd->array_size; ++row)
   {
     if ( pStmt->param_count )
@@ -1441,11 +1927,6 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
         if (param_status_ptr)
           *param_status_ptr= SQL_PARAM_UNUSED;
 
-        /* If this is last paramset - we will miss unlock */
-        if (pStmt->apd->array_size > 1 && is_select_stmt
-            && row == pStmt->apd->array_size - 1)
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-
         continue;
       }
 
@@ -1461,10 +1942,6 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
                               "with data at execution are not supported", 0);
           lastError= param_status_ptr;
 
-          /* unlocking since we do break*/
-          if (is_select_stmt)
-            myodbc_mutex_unlock(&pStmt->dbc->lock);
-
           one_of_params_not_succeded= 1;
 
           /* For other errors we continue processing of paramsets
@@ -1503,31 +1980,20 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
 
       if (!SQL_SUCCEEDED(rc))
       {
-        if (pStmt->apd->array_size > 1 && is_select_stmt
-          && row == pStmt->apd->array_size - 1)
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-
         continue/*return rc*/;
       }
 
       /* For "SELECT" statement constructing single statement using
          "UNION ALL" */
-      if (pStmt->apd->array_size > 1 && is_select_stmt)
+      if (pStmt->apd->array_size > 1 && is_select_stmt
+        && row < pStmt->apd->array_size - 1)
       {
-        if (row < pStmt->apd->array_size - 1)
-        {
-          const char * stmtsBinder= " UNION ALL ";
-          const ulong binderLength= strlen(stmtsBinder);
+        const char * stmtsBinder= " UNION ALL ";
+        const ulong binderLength= strlen(stmtsBinder);
 
-          add_to_buffer(&pStmt->dbc->mysql.net, (char*)pStmt->dbc->mysql.net.buff + length,
-                     stmtsBinder, binderLength);
-          length+= binderLength;
-        }
-        else
-        {
-          /* last select statement has been constructed - so releasing lock*/
-          myodbc_mutex_unlock(&pStmt->dbc->lock);
-        }
+        add_to_buffer(&pStmt->query_net, (char*)pStmt->query_net.buff + length,
+                   stmtsBinder, binderLength);
+        length+= binderLength;
       }
     }
 
@@ -1539,10 +2005,7 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
       }
       else
       {
-        if (query != GET_QUERY(&pStmt->query))
-        {
-          x_free(query);
-        }
+        free_query(pStmt, query);
 
         /*
           If the original query was modified, we reset stmt->query so that the
@@ -1551,6 +2014,7 @@ SQLRETURN my_SQLExecute( STMT *pStmt )
         if (GET_QUERY(&pStmt->orig_query))
         {
           copy_parsed_query(&pStmt->orig_query, &pStmt->query);
+          RESET_TEMPLATE(&pStmt->query_template);
           reset_parsed_query(&pStmt->orig_query, NULL, NULL, NULL);
         }
 
@@ -1773,6 +2237,7 @@ SQLRETURN SQL_API SQLParamData(SQLHSTMT hstmt, SQLPOINTER *prbgValue)
 
   /* We only check hstmt here */
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC(stmt);
 
   if (stmt->out_params_state != OPS_STREAMS_PENDING)
   {
@@ -1843,6 +2308,7 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
   DESCREC *aprec;
 
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC(stmt);
   CHECK_DATA_POINTER(stmt, rgbValue, cbValue);
   CHECK_STRLEN_OR_IND(stmt, rgbValue, cbValue);
 
@@ -1888,7 +2354,7 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 
 
 /**
-  Cancel the query by opening another connection and using KILL when called
+  Cancel the query by sending KILL over the control connection when called
   from another thread while the query lock is being held. Otherwise, treat as
   SQLFreeStmt(hstmt, SQL_CLOSE).
 
@@ -1898,56 +2364,47 @@ SQLRETURN SQL_API SQLPutData( SQLHSTMT      hstmt,
 */
 SQLRETURN SQL_API SQLCancel(SQLHSTMT hstmt)
 {
-  MYSQL *second= NULL;
-  int error;
+  int error, cancel;
   DBC *dbc;
 
   CHECK_HANDLE(hstmt);
 
   dbc= ((STMT *)hstmt)->dbc;
-  error= myodbc_mutex_trylock(&dbc->lock);
-
-  /* If there's no query going on, just close the statement. */
-  if (error == 0)
-  {
-    myodbc_mutex_unlock(&dbc->lock);
-    return my_SQLFreeStmt(hstmt, SQL_CLOSE);
-  }
-
-  /* If we got a non-BUSY error, it's just an error. */
-  if (error != EBUSY)
-    return set_stmt_error((STMT *)hstmt, "HY000",
-                          "Unable to get connection mutex status", error);
 
   /*
-    If the mutex was locked, we need to make a new connection and KILL the
-    ongoing query.
+    The asynchronous call of the statement is either ended here, or its query
+    is killed as the one of another thread.
   */
-  second= mysql_init(second);
-
-  /** @todo need to preserve and use ssl params */
+  cancel= async_cancel((STMT *)hstmt);
+  if (cancel == ASYNC_CANCEL_DONE)
+    return SQL_SUCCESS;
 
-  if (!mysql_real_connect(second, dbc->ds->server8, dbc->ds->uid8,
-                          dbc->ds->pwd8, NULL, dbc->ds->port,
-                          dbc->ds->socket8, 0))
+  if (cancel == ASYNC_CANCEL_NONE)
   {
-    /* We do not set the SQLSTATE here, per the ODBC spec. */
-    return SQL_ERROR;
-  }
+    error= myodbc_mutex_trylock(&dbc->lock);
 
-  {
-    char buff[40];
-    /* buff is always big enough because max length of %lu is 15 */
-    sprintf(buff, "KILL /*!50000 QUERY */ %lu", mysql_thread_id(&dbc->mysql));
-    if (mysql_real_query(second, buff, strlen(buff)))
+    /* If there's no query going on, just close the statement. */
+    if (error == 0)
     {
-      mysql_close(second);
-      /* We do not set the SQLSTATE here, per the ODBC spec. */
-      return SQL_ERROR;
+      myodbc_mutex_unlock(&dbc->lock);
+      return my_SQLFreeStmt(hstmt, SQL_CLOSE);
     }
+
+    /* If we got a non-BUSY error, it's just an error. */
+    if (error != EBUSY)
+      return set_stmt_error((STMT *)hstmt, "HY000",
+                            "Unable to get connection mutex status", error);
   }
 
-  mysql_close(second);
+  /*
+    If the mutex was locked, the ongoing query is killed over the control
+    connection to the server.
+  */
+  if (!kill_query(dbc, mysql_thread_id(dbc->mysql)))
+  {
+    /* We do not set the SQLSTATE here, per the ODBC spec. */
+    return SQL_ERROR;
+  }
 
   return SQL_SUCCESS;
 }
@@ -54,6 +54,109 @@ void myodbc_thread_key_create()
   pthread_key_create (&myodbc_thread_counter_key, 0);
 }
 #endif
+
+/*
+  Memory of freed statements and descriptors, kept for the next handles
+  instead of being returned to the allocator. Objects are linked through
+  their first bytes while they are on a list.
+*/
+#define HANDLE_MEM_KEPT_MAX 64
+
+typedef struct handle_mem_list
+{
+  void    *first;
+  uint    count;
+  size_t  size;
+} HANDLE_MEM_LIST;
+
+static HANDLE_MEM_LIST  stmt_mem= {NULL, 0, sizeof(STMT)};
+static HANDLE_MEM_LIST  desc_mem= {NULL, 0, sizeof(DESC)};
+static myodbc_mutex_t   handle_mem_lock;
+
+
+static HANDLE_MEM_LIST * handle_mem_list(SQLSMALLINT type)
+{
+  return type == SQL_HANDLE_STMT ? &stmt_mem : &desc_mem;
+}
+
+
+/**
+  Allocates zero filled memory for a statement or a descriptor.
+
+  @param[in]  type  SQL_HANDLE_STMT or SQL_HANDLE_DESC
+*/
+void * handle_mem_alloc(SQLSMALLINT type)
+{
+  HANDLE_MEM_LIST *list= handle_mem_list(type);
+  void            *mem;
+
+  myodbc_mutex_lock(&handle_mem_lock);
+  if ((mem= list->first))
+  {
+    list->first= *(void **)mem;
+    --list->count;
+  }
+  myodbc_mutex_unlock(&handle_mem_lock);
+
+  if (mem)
+  {
+    memset(mem, 0, list->size);
+    return mem;
+  }
+
+  return myodbc_malloc(list->size, MYF(MY_ZEROFILL));
+}
+
+
+/* Frees memory got from handle_mem_alloc(), keeping it for reuse */
+void handle_mem_free(SQLSMALLINT type, void *mem)
+{
+  HANDLE_MEM_LIST *list= handle_mem_list(type);
+
+  if (mem == NULL)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&handle_mem_lock);
+  if (list->count < HANDLE_MEM_KEPT_MAX)
+  {
+    *(void **)mem= list->first;
+    list->first= mem;
+    ++list->count;
+    mem= NULL;
+  }
+  myodbc_mutex_unlock(&handle_mem_lock);
+
+  x_free(mem);
+}
+
+
+void handle_mem_init(void)
+{
+  myodbc_mutex_init(&handle_mem_lock, NULL);
+}
+
+
+void handle_mem_end(void)
+{
+  HANDLE_MEM_LIST *lists[]= {&stmt_mem, &desc_mem};
+  uint            i;
+
+  for (i= 0; i < sizeof(lists) / sizeof(lists[0]); ++i)
+  {
+    while (lists[i]->first)
+    {
+      void *mem= lists[i]->first;
+      lists[i]->first= *(void **)mem;
+      x_free(mem);
+    }
+    lists[i]->count= 0;
+  }
+
+  myodbc_mutex_destroy(&handle_mem_lock);
+}
+
 /*
   @type    : myodbc3 internal
   @purpose : to allocate the environment handle and to maintain
@@ -173,6 +276,7 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
 {
     DBC *dbc;
     ENV *penv= (ENV *) henv;
+    MYSQL *mysql;
 
 #ifdef _UNIX_
     long *thread_count;
@@ -208,17 +312,29 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
                              "until ODBC version specified.", 0);
     }
 
+    /*
+      The handle is allocated apart from the DBC, so that an open connection
+      is passed to and taken from the pool by swapping the pointers
+    */
+    if (!(mysql= (MYSQL *)myodbc_malloc(sizeof(MYSQL), MYF(MY_ZEROFILL))))
+    {
+        *phdbc= SQL_NULL_HDBC;
+        return(set_env_error(henv,MYERR_S1001,NULL,0));
+    }
+
 #ifndef _UNIX_
     {
         HGLOBAL hdbc= GlobalAlloc(GMEM_MOVEABLE | GMEM_ZEROINIT, sizeof (DBC));
         if (!hdbc)
         {
+            x_free(mysql);
             *phdbc= SQL_NULL_HENV;
             return(my_GetLastError(henv));
         }
 
         if ((*phdbc= (SQLHDBC)GlobalLock(hdbc)) == SQL_NULL_HDBC)
         {
+            x_free(mysql);
             *phdbc= SQL_NULL_HENV;
             return(my_GetLastError(henv));
         }
@@ -226,6 +342,7 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
 #else
     if (!(*phdbc= (SQLHDBC) myodbc_malloc(sizeof(DBC),MYF(MY_ZEROFILL))))
     {
+        x_free(mysql);
         *phdbc= SQL_NULL_HDBC;
         return(set_env_error(henv,MYERR_S1001,NULL,0));
     }
@@ -238,16 +355,19 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
 #endif /* WIN32 */
 
     dbc= (DBC *) *phdbc;
-    dbc->mysql.net.vio= 0;     /* Marker if open */
+    dbc->mysql= mysql;
+    dbc->mysql->net.vio= 0;     /* Marker if open */
     dbc->commit_flag= 0;
     dbc->stmt_options.max_rows= dbc->stmt_options.max_length= 0L;
     dbc->stmt_options.cursor_type= SQL_CURSOR_FORWARD_ONLY;  /* ODBC default */
+    dbc->stmt_options.concurrency= SQL_CONCUR_READ_ONLY;     /* ODBC default */
     /* 
       Query timeout is unknown, assign with the first request in 
       get_constmt_attr. It might never be needed, so we are not getting it
       at the connect stage
     */
     dbc->stmt_options.query_timeout= (SQLULEN)-1;
+    dbc->stmt_options.async_enable= SQL_ASYNC_ENABLE_OFF;
     dbc->login_timeout= 0;
     dbc->last_query_time= (time_t) time((time_t*) 0);
     dbc->txn_isolation= DEFAULT_TXN_ISOLATION;
@@ -260,7 +380,18 @@ SQLRETURN SQL_API my_SQLAllocConnect(SQLHENV henv, SQLHDBC *phdbc)
     dbc->ansi_charset_info= dbc->cxn_charset_info= NULL;
     dbc->exp_desc= NULL;
     dbc->sql_select_limit= (SQLULEN) -1;
+    dbc->max_execution_time= 0;
+    dbc->max_allowed_packet= 0;
+    dbc->ssps_cache= NULL;
+    dbc->ssps_cache_count= 0;
+    dbc->key_cache= NULL;
+    dbc->key_cache_count= 0;
     myodbc_mutex_init(&dbc->lock,NULL);
+    myodbc_mutex_init(&dbc->session_lock,NULL);
+    myodbc_mutex_init(&dbc->handles_lock,NULL);
+    myodbc_mutex_init(&dbc->ssps_cache_lock,NULL);
+    myodbc_mutex_init(&dbc->key_cache_lock,NULL);
+    myodbc_mutex_init(&dbc->readahead_lock,NULL);
     myodbc_mutex_lock(&dbc->lock);
     myodbc_ov_init(penv->odbc_ver); /* Initialize based on ODBC version */
     myodbc_mutex_unlock(&dbc->lock);
@@ -314,7 +445,8 @@ int wakeup_connection(DBC *dbc)
 {
   DataSource *ds= dbc->ds;
 
-  if (mysql_change_user(&dbc->mysql, ds_get_utf8attr(ds->uid, &ds->uid8),
+  if (mysql_change_user(readahead_yield(dbc),
+                        ds_get_utf8attr(ds->uid, &ds->uid8),
                                      ds_get_utf8attr(ds->pwd, &ds->pwd8),
                                      ds_get_utf8attr(ds->database, &ds->database8)))
   {
@@ -339,12 +471,18 @@ SQLRETURN SQL_API my_SQLFreeConnect(SQLHDBC hdbc)
     myodbc_mutex_lock(&dbc->env->lock);
     dbc->env->connections= list_delete(dbc->env->connections,&dbc->list);
     myodbc_mutex_unlock(&dbc->env->lock);
+    x_free(dbc->mysql);
     x_free(dbc->database);
     if (dbc->ds)
     {
       ds_delete(dbc->ds);
     }
     myodbc_mutex_destroy(&dbc->lock);
+    myodbc_mutex_destroy(&dbc->session_lock);
+    myodbc_mutex_destroy(&dbc->handles_lock);
+    myodbc_mutex_destroy(&dbc->ssps_cache_lock);
+    myodbc_mutex_destroy(&dbc->key_cache_lock);
+    myodbc_mutex_destroy(&dbc->readahead_lock);
 
     free_explicit_descriptors(dbc);
 
@@ -481,7 +619,7 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
     GlobalFree(hstmt);
   }
 #else
-  *phstmt= (SQLHSTMT) myodbc_malloc(sizeof (STMT), MYF(MY_ZEROFILL | MY_WME));
+  *phstmt= (SQLHSTMT) handle_mem_alloc(SQL_HANDLE_STMT);
 #endif /* IS UNIX */
   if (*phstmt == SQL_NULL_HSTMT)
     goto error;
@@ -489,9 +627,10 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
   stmt= (STMT *) *phstmt;
   stmt->dbc= dbc;
 
-  myodbc_mutex_lock(&stmt->dbc->lock);
+  /* Not dbc->lock, which is held by a query running on the connection */
+  myodbc_mutex_lock(&dbc->handles_lock);
   dbc->statements= list_add(dbc->statements,&stmt->list);
-  myodbc_mutex_unlock(&stmt->dbc->lock);
+  myodbc_mutex_unlock(&dbc->handles_lock);
   stmt->list.data= stmt;
   stmt->stmt_options= dbc->stmt_options;
   stmt->state= ST_UNKNOWN;
@@ -499,6 +638,7 @@ SQLRETURN SQL_API my_SQLAllocStmt(SQLHDBC hdbc,SQLHSTMT *phstmt)
   myodbc_stpmov(stmt->error.sqlstate, "00000");
   init_parsed_query(&stmt->query);
   init_parsed_query(&stmt->orig_query);
+  init_query_template(&stmt->query_template);
 
   if (!dbc->ds->no_ssps && allocate_param_bind(&stmt->param_bind, 10))
   {
@@ -529,6 +669,7 @@ error:
   x_free(stmt->ipd);
   delete_parsed_query(&stmt->query);
   delete_parsed_query(&stmt->orig_query);
+  delete_query_template(&stmt->query_template);
   delete_param_bind(stmt->param_bind);
 
   return set_dbc_error(dbc, "HY001", "Memory allocation error", MYERR_S1001);
@@ -561,6 +702,14 @@ SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT hstmt,SQLUSMALLINT fOption)
 {
     CHECK_HANDLE(hstmt);
 
+    /* Only dropping the statement waits for the call running on it */
+    if (fOption != SQL_DROP)
+    {
+      CHECK_ASYNC((STMT *)hstmt);
+    }
+
+    async_wait((STMT *)hstmt);
+
     return my_SQLFreeStmt(hstmt,fOption);
 }
 
@@ -596,6 +745,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     {
       stmt->ard->records.elements= 0;
       stmt->ard->count= 0;
+      ++stmt->ard->generation;
       return SQL_SUCCESS;
     }
 
@@ -611,7 +761,9 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     /* reset data-at-exec state */
     stmt->dae_type= 0;
 
+    myodbc_mutex_lock(&stmt->dbc->lock);
     scroller_reset(stmt);
+    myodbc_mutex_unlock(&stmt->dbc->lock);
 
     if (fOption == SQL_RESET_PARAMS)
     {
@@ -621,6 +773,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
       }
       if (ssps_used(stmt))
       {
+        readahead_pause(stmt->dbc);
         mysql_stmt_reset(stmt->ssps);
       }
       /* remove all params and reset count to 0 (per spec) */
@@ -629,6 +782,8 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
       return SQL_SUCCESS;
     }
 
+    readahead_free(stmt);
+
     if (!stmt->fake_result)
     {
       if (clearAllResults)
@@ -655,6 +810,9 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     x_free(stmt->fields);
     x_free(stmt->result_array);
     x_free(stmt->lengths);
+    invalidate_conversion_plan(stmt);
+    invalidate_row_index(stmt);
+    invalidate_keyset(stmt);
     stmt->result= 0;
     stmt->fake_result= 0;
     stmt->fields= 0;
@@ -708,6 +866,7 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
     /* At this point, only MYSQL_RESET and SQL_DROP left out */
     reset_parsed_query(&stmt->orig_query, NULL, NULL, NULL);
     reset_parsed_query(&stmt->query, NULL, NULL, NULL);
+    RESET_TEMPLATE(&stmt->query_template);
 
     if (stmt->param_bind != NULL)
     {
@@ -741,16 +900,23 @@ SQLRETURN SQL_API my_SQLFreeStmtExtended(SQLHSTMT hstmt,SQLUSMALLINT fOption,
 
     delete_parsed_query(&stmt->query);
     delete_parsed_query(&stmt->orig_query);
+    delete_query_template(&stmt->query_template);
     delete_param_bind(stmt->param_bind);
+    free_rowset(stmt);
 
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    if (stmt->query_net.buff)
+    {
+      myodbc_net_end(&stmt->query_net);
+    }
+
+    myodbc_mutex_lock(&stmt->dbc->handles_lock);
     stmt->dbc->statements= list_delete(stmt->dbc->statements,&stmt->list);
-    myodbc_mutex_unlock(&stmt->dbc->lock);
+    myodbc_mutex_unlock(&stmt->dbc->handles_lock);
 #ifndef _UNIX_
     GlobalUnlock(GlobalHandle ((HGLOBAL) hstmt));
     GlobalFree(GlobalHandle((HGLOBAL) hstmt));
 #else
-    x_free(hstmt);
+    handle_mem_free(SQL_HANDLE_STMT, hstmt);
 #endif /* _UNIX_*/
     return SQL_SUCCESS;
 }
@@ -773,9 +939,9 @@ SQLRETURN my_SQLAllocDesc(SQLHDBC hdbc, SQLHANDLE *pdesc)
   /* add to this connection's list of explicit descriptors */
   e= (LIST *) myodbc_malloc(sizeof(LIST), MYF(0));
   e->data= desc;
-  myodbc_mutex_lock(&dbc->lock);
+  myodbc_mutex_lock(&dbc->handles_lock);
   dbc->exp_desc= list_add(dbc->exp_desc, e);
-  myodbc_mutex_unlock(&dbc->lock);
+  myodbc_mutex_unlock(&dbc->handles_lock);
 
   *pdesc= desc;
   return SQL_SUCCESS;
@@ -801,17 +967,17 @@ SQLRETURN my_SQLFreeDesc(SQLHANDLE hdesc)
                           "allocated descriptor handle.", MYERR_S1017);
 
   /* remove from DBC */
+  myodbc_mutex_lock(&dbc->handles_lock);
   for (ldesc= dbc->exp_desc; ldesc; ldesc= ldesc->next)
   {
     if (ldesc->data == desc)
     {
-      myodbc_mutex_lock(&dbc->lock);
       dbc->exp_desc= list_delete(dbc->exp_desc, ldesc);
-      myodbc_mutex_unlock(&dbc->lock);
-      x_free(ldesc);
       break;
     }
   }
+  myodbc_mutex_unlock(&dbc->handles_lock);
+  x_free(ldesc);
 
   /* reset all stmts it was on - to their implicit desc */
   for (lstmt= desc->exp.stmts; lstmt; lstmt= next)
@@ -924,6 +1090,7 @@ SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType,
             break;
 
         case SQL_HANDLE_STMT:
+            async_wait((STMT *)Handle);
             error= my_SQLFreeStmt((STMT *)Handle, SQL_DROP);
             break;
 
@@ -98,7 +98,20 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
 #endif
 
   case SQL_ASYNC_MODE:
+#ifdef THREAD
+    MYINFO_SET_ULONG(SQL_AM_STATEMENT);
+#else
     MYINFO_SET_ULONG(SQL_AM_NONE);
+#endif
+
+#ifdef SQL_ASYNC_NOTIFICATION
+  case SQL_ASYNC_NOTIFICATION:
+# ifdef THREAD
+    MYINFO_SET_ULONG(SQL_ASYNC_NOTIFICATION_CAPABLE);
+# else
+    MYINFO_SET_ULONG(SQL_ASYNC_NOTIFICATION_NOT_CAPABLE);
+# endif
+#endif
 
   case SQL_BATCH_ROW_COUNT:
     MYINFO_SET_ULONG(SQL_BRC_EXPLICIT);
@@ -130,7 +143,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                      0);
 
   case SQL_COLLATION_SEQ:
-    MYINFO_SET_STR(dbc->mysql.charset->name);
+    MYINFO_SET_STR(dbc->mysql->charset->name);
 
   case SQL_COLUMN_ALIAS:
     MYINFO_SET_STR("Y");
@@ -196,7 +209,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
 
   case SQL_CREATE_VIEW:
     /** @todo SQL_CV_LOCAL ? */
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_ULONG(SQL_CV_CREATE_VIEW | SQL_CV_CHECK_OPTION |
                        SQL_CV_CASCADED);
     else
@@ -227,7 +240,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
         return set_dbc_error(dbc, "HY000",
                              "SQLGetInfo() failed to return current catalog.",
                              0);
-    MYINFO_SET_STR(dbc->database ? dbc->database : "null");
+    MYINFO_SET_STR(current_catalog_copy(dbc, dbc->database_copy, "null"));
 
   case SQL_DATETIME_LITERALS:
     MYINFO_SET_ULONG(SQL_DL_SQL92_DATE | SQL_DL_SQL92_TIME |
@@ -238,7 +251,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
 
   case SQL_DBMS_VER:
     /** @todo technically this is not right: should be ##.##.#### */
-    MYINFO_SET_STR(dbc->mysql.server_version);
+    MYINFO_SET_STR(dbc->mysql->server_version);
 
   case SQL_DDL_INDEX:
     MYINFO_SET_ULONG(SQL_DI_CREATE_INDEX | SQL_DI_DROP_INDEX);
@@ -281,7 +294,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
     MYINFO_SET_ULONG(SQL_DT_DROP_TABLE | SQL_DT_CASCADE | SQL_DT_RESTRICT);
 
   case SQL_DROP_VIEW:
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_ULONG(SQL_DV_DROP_VIEW | SQL_DV_CASCADE | SQL_DV_RESTRICT);
     else
       MYINFO_SET_ULONG(0);
@@ -356,7 +369,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
       We have INFORMATION_SCHEMA.SCHEMATA, but we don't report it
       because the driver exposes databases (schema) as catalogs.
     */
-    if (is_minimum_version(dbc->mysql.server_version, "5.1"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.1"))
       MYINFO_SET_ULONG(SQL_ISV_CHARACTER_SETS | SQL_ISV_COLLATIONS |
                        SQL_ISV_COLUMN_PRIVILEGES | SQL_ISV_COLUMNS |
                        SQL_ISV_KEY_COLUMN_USAGE |
@@ -364,7 +377,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                        /* SQL_ISV_SCHEMATA | */ SQL_ISV_TABLE_CONSTRAINTS |
                        SQL_ISV_TABLE_PRIVILEGES | SQL_ISV_TABLES |
                        SQL_ISV_VIEWS);
-    else if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    else if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_ULONG(SQL_ISV_CHARACTER_SETS | SQL_ISV_COLLATIONS |
                        SQL_ISV_COLUMN_PRIVILEGES | SQL_ISV_COLUMNS |
                        SQL_ISV_KEY_COLUMN_USAGE | /* SQL_ISV_SCHEMATA | */
@@ -390,7 +403,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
      the MySQL Reference Manual (which is, in turn, generated from the source)
      with the pre-reserved ODBC keywords removed.
     */
-    if (is_minimum_version(dbc->mysql.server_version, "5.7"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.7"))
       MYINFO_SET_STR("ACCESSIBLE,ANALYZE,ASENSITIVE,BEFORE,BIGINT,BINARY,BLOB,"
                      "CALL,CHANGE,CONDITION,DATABASE,DATABASES,DAY_HOUR,"
                      "DAY_MICROSECOND,DAY_MINUTE,DAY_SECOND,DELAYED,"
@@ -415,7 +428,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                      "TINYBLOB,TINYINT,TINYTEXT,TRIGGER,UNDO,UNLOCK,UNSIGNED,"
                      "USE,UTC_DATE,UTC_TIME,UTC_TIMESTAMP,VARBINARY,"
                      "VARCHARACTER,WHILE,X509,XOR,YEAR_MONTH,ZEROFILL");
-    else if (is_minimum_version(dbc->mysql.server_version, "5.6"))
+    else if (is_minimum_version(dbc->mysql->server_version, "5.6"))
       MYINFO_SET_STR("ACCESSIBLE,ANALYZE,ASENSITIVE,BEFORE,BIGINT,BINARY,BLOB,"
                      "CALL,CHANGE,CONDITION,DATABASE,DATABASES,DAY_HOUR,"
                      "DAY_MICROSECOND,DAY_MINUTE,DAY_SECOND,DELAYED,"
@@ -440,7 +453,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                      "TINYBLOB,TINYINT,TINYTEXT,TRIGGER,UNDO,UNLOCK,UNSIGNED,"
                      "USE,UTC_DATE,UTC_TIME,UTC_TIMESTAMP,VARBINARY,"
                      "VARCHARACTER,WHILE,X509,XOR,YEAR_MONTH,ZEROFILL");
-    else if (is_minimum_version(dbc->mysql.server_version, "5.5"))
+    else if (is_minimum_version(dbc->mysql->server_version, "5.5"))
       MYINFO_SET_STR("ACCESSIBLE,ANALYZE,ASENSITIVE,BEFORE,BIGINT,BINARY,BLOB,"
                      "CALL,CHANGE,CONDITION,DATABASE,DATABASES,DAY_HOUR,"
                      "DAY_MICROSECOND,DAY_MINUTE,DAY_SECOND,DELAYED,"
@@ -463,7 +476,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                      "TINYBLOB,TINYINT,TINYTEXT,TRIGGER,UNDO,UNLOCK,UNSIGNED,"
                      "USE,UTC_DATE,UTC_TIME,UTC_TIMESTAMP,VARBINARY,"
                      "VARCHARACTER,WHILE,X509,XOR,YEAR_MONTH,ZEROFILL");
-    else if (is_minimum_version(dbc->mysql.server_version, "5.1"))
+    else if (is_minimum_version(dbc->mysql->server_version, "5.1"))
       MYINFO_SET_STR("ACCESSIBLE,ANALYZE,ASENSITIVE,BEFORE,BIGINT,BINARY,BLOB,"
                      "CALL,CHANGE,CONDITION,DATABASE,DATABASES,DAY_HOUR,"
                      "DAY_MICROSECOND,DAY_MINUTE,DAY_SECOND,DELAYED,"
@@ -485,7 +498,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
                      "TINYTEXT,TRIGGER,UNDO,UNLOCK,UNSIGNED,USE,UTC_DATE,"
                      "UTC_TIME,UTC_TIMESTAMP,VARBINARY,VARCHARACTER,WHILE,X509,"
                      "XOR,YEAR_MONTH,ZEROFILL");
-    else if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    else if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_STR("ANALYZE,ASENSITIVE,BEFORE,BIGINT,BINARY,BLOB,CALL,CHANGE,"
                      "CONDITION,DATABASE,DATABASES,DAY_HOUR,DAY_MICROSECOND,"
                      "DAY_MINUTE,DAY_SECOND,DELAYED,DETERMINISTIC,DISTINCTROW,"
@@ -570,7 +583,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
     MYINFO_SET_USHORT(NAME_LEN);
 
   case SQL_MAX_INDEX_SIZE:
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_USHORT(3072);
     else
       MYINFO_SET_USHORT(1024);
@@ -594,7 +607,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
     MYINFO_SET_USHORT(NAME_LEN);
 
   case SQL_MAX_TABLES_IN_SELECT:
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_USHORT(63);
     else
       MYINFO_SET_USHORT(31);
@@ -652,13 +665,13 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
     MYINFO_SET_ULONG(SQL_PAS_NO_BATCH);
 
   case SQL_PROCEDURE_TERM:
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_STR("stored procedure");
     else
       MYINFO_SET_STR("");
 
   case SQL_PROCEDURES:
-    if (is_minimum_version(dbc->mysql.server_version, "5.0"))
+    if (is_minimum_version(dbc->mysql->server_version, "5.0"))
       MYINFO_SET_STR("Y");
     else
       MYINFO_SET_STR("N");
@@ -693,7 +706,7 @@ MySQLGetInfo(SQLHDBC hdbc, SQLUSMALLINT fInfoType,
     MYINFO_SET_STR("\\");
 
   case SQL_SERVER_NAME:
-    MYINFO_SET_STR(dbc->mysql.host_info);
+    MYINFO_SET_STR(dbc->mysql->host_info);
 
   case SQL_SPECIAL_CHARACTERS:
     /* We can handle anything but / and \xff. */
@@ -1028,6 +1041,7 @@ SQLRETURN SQL_API MySQLGetTypeInfo(SQLHSTMT hstmt, SQLSMALLINT fSqlType)
   STMT *stmt= (STMT *)hstmt;
   uint i;
 
+  CHECK_ASYNC(stmt);
   my_SQLFreeStmt(hstmt, MYSQL_RESET);
 
   /* use ODBC2 types if called with ODBC3 types on an ODBC2 handle */
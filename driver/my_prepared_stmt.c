@@ -29,6 +29,7 @@
 
 #include "driver.h"
 #include "errmsg.h"
+#include <ctype.h>
 
 
 /* {{{ my_l_to_a() -I- */
@@ -52,7 +53,11 @@ static char * my_ul_to_a(char * buf, size_t buf_size, unsigned long long a)
 /* {{{ my_f_to_a() -I- */
 static char * my_f_to_a(char * buf, size_t buf_size, double a)
 {
-	myodbc_snprintf(buf, buf_size, "%f", a);
+	/* Same as "%f", but always with '.' as the decimal point */
+	if (a > -1e15 && a < 1e15)
+		my_fcvt(a, 6, buf, NULL);
+	else
+		my_gcvt(a, MY_GCVT_ARG_DOUBLE, (int)buf_size - 1, buf, NULL);
 	return buf;
 }
 /* }}} */
@@ -61,7 +66,7 @@ static char * my_f_to_a(char * buf, size_t buf_size, double a)
 /* {{{ ssps_init() -I- */
 void ssps_init(STMT *stmt)
 {
-  stmt->ssps= mysql_stmt_init(&stmt->dbc->mysql);
+  stmt->ssps= mysql_stmt_init(stmt->dbc->mysql);
 
   stmt->result_bind= 0;
 }
@@ -273,6 +278,11 @@ void free_result_bind(STMT *stmt)
     /* buffer was allocated for each column */
     for (i= 0; i < field_cnt; i++)
     {
+      /* Columns bound directly point to the application buffers */
+      if (stmt->result_direct && stmt->result_direct[i])
+      {
+        stmt->result_bind[i].buffer= stmt->array[i];
+      }
       x_free(stmt->result_bind[i].buffer);
 
       if (stmt->lengths)
@@ -284,26 +294,225 @@ void free_result_bind(STMT *stmt)
     x_free(stmt->result_bind);
     stmt->result_bind= 0;
 
+    x_free(stmt->result_direct);
+    stmt->result_direct= 0;
+
     x_free(stmt->array);
     stmt->array= 0;
   }
 }
 
 
+/* {{{ ssps_cache_entry_free() -I- */
+static void ssps_cache_entry_free(SSPS_CACHE_ENTRY *entry)
+{
+  if (entry->ssps != NULL)
+  {
+    mysql_stmt_close(entry->ssps);
+  }
+
+  x_free(entry);
+}
+/* }}} */
+
+
+/*
+  Puts the statement prepared by stmt to the connection cache, evicting the
+  least recently used one if the cache is full. Returns FALSE if it can't be
+  cached, and has to be closed.
+  The statement is reset on the server, that drops its result, cursor and
+  long data. Its binds point to buffers of stmt, so they are cleared and the
+  next owner has to bind them again.
+*/
+static BOOL ssps_cache_put(STMT *stmt)
+{
+  DBC              *dbc= stmt->dbc;
+  MYSQL_STMT       *ssps= stmt->ssps;
+  SSPS_CACHE_ENTRY *entry= stmt->ssps_entry, *evicted= NULL;
+  LIST             *last;
+
+  if (entry == NULL || dbc->ds->ssps_cache_size == 0
+    || entry->thread_id != mysql_thread_id(dbc->mysql)
+    || mysql_stmt_reset(ssps))
+  {
+    return FALSE;
+  }
+
+  if (ssps->params != NULL)
+  {
+    memset(ssps->params, 0, sizeof(MYSQL_BIND) * ssps->param_count);
+  }
+  if (ssps->bind != NULL)
+  {
+    memset(ssps->bind, 0, sizeof(MYSQL_BIND) * ssps->field_count);
+  }
+  ssps->bind_param_done= 0;
+  ssps->bind_result_done= 0;
+
+  entry->ssps= ssps;
+  stmt->ssps_entry= NULL;
+
+  myodbc_mutex_lock(&dbc->ssps_cache_lock);
+
+  dbc->ssps_cache= list_add(dbc->ssps_cache, &entry->list);
+
+  if (++dbc->ssps_cache_count > dbc->ds->ssps_cache_size)
+  {
+    for (last= dbc->ssps_cache; last->next; last= last->next);
+
+    dbc->ssps_cache= list_delete(dbc->ssps_cache, last);
+    --dbc->ssps_cache_count;
+    evicted= (SSPS_CACHE_ENTRY *)last->data;
+  }
+
+  myodbc_mutex_unlock(&dbc->ssps_cache_lock);
+
+  if (evicted != NULL)
+  {
+    ssps_cache_entry_free(evicted);
+  }
+
+  return TRUE;
+}
+
+
+/*
+  Looks up the connection cache for the statement prepared for the query.
+  If there is one, it becomes stmt->ssps and TRUE is returned. Otherwise
+  stmt gets the key to cache its statement with, once it is closed.
+*/
+BOOL ssps_cache_take(STMT *stmt, const char *query, size_t query_length)
+{
+  DBC              *dbc= stmt->dbc;
+  SSPS_CACHE_ENTRY *entry, *found= NULL;
+  LIST             *element, *next, *stale= NULL;
+  ulong             thread_id= mysql_thread_id(dbc->mysql);
+  uint              charset= dbc->cxn_charset_info->number;
+
+  x_free(stmt->ssps_entry);
+  stmt->ssps_entry= NULL;
+
+  if (dbc->ds->ssps_cache_size == 0)
+  {
+    return FALSE;
+  }
+
+  /* Leading and trailing spaces do not make queries different */
+  while (query_length && isspace((unsigned char)*query))
+  {
+    ++query;
+    --query_length;
+  }
+  while (query_length && isspace((unsigned char)query[query_length - 1]))
+  {
+    --query_length;
+  }
+
+  myodbc_mutex_lock(&dbc->ssps_cache_lock);
+
+  for (element= dbc->ssps_cache; element; element= next)
+  {
+    next= element->next;
+    entry= (SSPS_CACHE_ENTRY *)element->data;
+
+    /* Statements of the connection that was lost can't be used anymore */
+    if (entry->thread_id != thread_id)
+    {
+      dbc->ssps_cache= list_delete(dbc->ssps_cache, element);
+      --dbc->ssps_cache_count;
+      stale= list_add(stale, element);
+    }
+    else if (found == NULL && entry->charset == charset
+          && entry->query_length == query_length
+          && memcmp(entry->query, query, query_length) == 0)
+    {
+      dbc->ssps_cache= list_delete(dbc->ssps_cache, element);
+      --dbc->ssps_cache_count;
+      found= entry;
+    }
+  }
+
+  myodbc_mutex_unlock(&dbc->ssps_cache_lock);
+
+  for (element= stale; element; element= next)
+  {
+    next= element->next;
+    ssps_cache_entry_free((SSPS_CACHE_ENTRY *)element->data);
+  }
+
+  if (found != NULL)
+  {
+    stmt->ssps= found->ssps;
+    stmt->result_bind= 0;
+    found->ssps= NULL;
+    stmt->ssps_entry= found;
+
+    return TRUE;
+  }
+
+  /* The key is allocated along with the entry */
+  if ((entry= myodbc_malloc(sizeof(SSPS_CACHE_ENTRY) + query_length + 1,
+                            MYF(0))))
+  {
+    entry->list.data= entry;
+    entry->ssps= NULL;
+    entry->thread_id= thread_id;
+    entry->charset= charset;
+    entry->query_length= query_length;
+    entry->query= (char *)(entry + 1);
+    memcpy(entry->query, query, query_length);
+    entry->query[query_length]= '\0';
+  }
+  stmt->ssps_entry= entry;
+
+  return FALSE;
+}
+
+
+/*
+  Closes all statements cached by the connection. Done when they may have
+  become stale, or the connection is about to be closed.
+*/
+void ssps_cache_free(DBC *dbc)
+{
+  LIST *element, *next, *cache;
+
+  myodbc_mutex_lock(&dbc->ssps_cache_lock);
+  cache= dbc->ssps_cache;
+  dbc->ssps_cache= NULL;
+  dbc->ssps_cache_count= 0;
+  myodbc_mutex_unlock(&dbc->ssps_cache_lock);
+
+  for (element= cache; element; element= next)
+  {
+    next= element->next;
+    ssps_cache_entry_free((SSPS_CACHE_ENTRY *)element->data);
+  }
+}
+
+
 void ssps_close(STMT *stmt)
 {
   if (stmt->ssps != NULL)
   {
+    /* Freeing or closing the statement is sent to the server */
+    readahead_pause(stmt->dbc);
     free_result_bind(stmt);
 
-    /*
-      No need to check the result of this operation.
-      It can fail because the connection to the server is lost, which
-      is still ok because the memory is freed anyway.
-    */
-    mysql_stmt_close(stmt->ssps);
+    if (!ssps_cache_put(stmt))
+    {
+      /*
+        No need to check the result of this operation.
+        It can fail because the connection to the server is lost, which
+        is still ok because the memory is freed anyway.
+      */
+      mysql_stmt_close(stmt->ssps);
+    }
     stmt->ssps= NULL;
   }
+
+  x_free(stmt->ssps_entry);
+  stmt->ssps_entry= NULL;
 }
 
 
@@ -557,6 +766,8 @@ int ssps_bind_result(STMT *stmt)
                                               MYF(MY_ZEROFILL));
     stmt->array=        (MYSQL_ROW)myodbc_malloc(sizeof(char*)*num_fields,
                                               MYF(MY_ZEROFILL));
+    stmt->result_direct= (my_bool*)myodbc_malloc(sizeof(my_bool)*num_fields,
+                                              MYF(MY_ZEROFILL));
 
     for (i= 0; i < num_fields; ++i)
     {
@@ -597,6 +808,107 @@ int ssps_bind_result(STMT *stmt)
 }
 
 
+/*
+  Checks if the value of the column can be fetched by libmysql right into the
+  application buffer, i.e. if the bound C type has exactly the representation
+  of the value on the wire.
+*/
+static BOOL direct_bind_possible(MYSQL_BIND *bind, SQLSMALLINT c_type)
+{
+  if (bind->buffer == NULL
+    || bind->buffer_length != bind_length(c_type, 0))
+  {
+    return FALSE;
+  }
+
+  switch (c_type)
+  {
+    case SQL_C_LONG:
+    case SQL_C_SLONG:
+      return bind->buffer_type == MYSQL_TYPE_LONG && !bind->is_unsigned;
+    case SQL_C_ULONG:
+      return bind->buffer_type == MYSQL_TYPE_LONG && bind->is_unsigned;
+    case SQL_C_SBIGINT:
+      return bind->buffer_type == MYSQL_TYPE_LONGLONG && !bind->is_unsigned;
+    case SQL_C_UBIGINT:
+      return bind->buffer_type == MYSQL_TYPE_LONGLONG && bind->is_unsigned;
+    case SQL_C_FLOAT:
+      return bind->buffer_type == MYSQL_TYPE_FLOAT;
+    case SQL_C_DOUBLE:
+      return bind->buffer_type == MYSQL_TYPE_DOUBLE;
+  }
+
+  return FALSE;
+}
+
+
+/* {{{ ssps_bind_direct() -I- */
+/*
+  Points result buffers of fixed-width columns, bound with the C type
+  matching the wire representation, to the application buffers of the row
+  rownum of the rowset. fill_fetch_buffers() then only sets the indicators
+  for those columns. Only read-only forward-only cursors are served that
+  way, since positioned operations need fetched values to stay intact, and
+  SQLSetPos is not refused for the other concurrencies.
+  Binding is only refreshed if any of buffers has changed, so fetching
+  single rows into the same buffers costs nothing.
+*/
+void ssps_bind_direct(STMT *stmt, uint rownum)
+{
+  const unsigned int  num_fields= field_count(stmt);
+  unsigned int        i;
+  BOOL                allowed, changed= FALSE;
+
+  if (!ssps_used(stmt) || num_fields == 0 || ssps_bind_result(stmt))
+  {
+    return;
+  }
+
+  allowed= stmt->stmt_options.concurrency == SQL_CONCUR_READ_ONLY
+        && stmt->stmt_options.cursor_type == SQL_CURSOR_FORWARD_ONLY
+        && stmt->out_params_state == OPS_UNKNOWN
+        && !IS_PS_OUT_PARAMS(stmt);
+
+  for (i= 0; i < num_fields; ++i)
+  {
+    MYSQL_BIND *bind= &stmt->result_bind[i];
+    DESCREC    *arrec= NULL;
+    void       *target= NULL;
+
+    if (allowed && i < (uint)stmt->ard->count)
+    {
+      arrec= desc_get_rec(stmt->ard, i, FALSE);
+    }
+
+    if (arrec && arrec->data_ptr
+      && direct_bind_possible(bind, arrec->concise_type))
+    {
+      target= ptr_offset_adjust(arrec->data_ptr, stmt->ard->bind_offset_ptr,
+                                stmt->ard->bind_type, arrec->octet_length,
+                                rownum);
+    }
+    else if (stmt->result_direct[i])
+    {
+      target= stmt->array[i];
+    }
+
+    if (target != NULL && target != bind->buffer)
+    {
+      bind->buffer= target;
+      changed= TRUE;
+    }
+
+    stmt->result_direct[i]= target != NULL && target != stmt->array[i];
+  }
+
+  if (changed)
+  {
+    mysql_stmt_bind_result(stmt->ssps, stmt->result_bind);
+  }
+}
+/* }}} */
+
+
 BOOL ssps_0buffers_truncated_only(STMT *stmt)
 {
   if (stmt->fix_fields == NULL)
@@ -791,8 +1103,9 @@ long double ssps_get_double(STMT *stmt, ulong column_number, char *value, ulong
     case MYSQL_TYPE_VAR_STRING:
     {
       char buf[50];
-      long double ret = strtold(ssps_get_string(stmt, column_number, value,
-                                                &length, buf), NULL);
+      long double ret = myodbc_strtold(ssps_get_string(stmt, column_number,
+                                                       value, &length, buf),
+                                       NULL);
       return ret;
     }
 
@@ -817,6 +1130,38 @@ long double ssps_get_double(STMT *stmt, ulong column_number, char *value, ulong
 }
 
 
+/* {{{ ssps_get_timestamp() -I- */
+/*
+  Fills ts from MYSQL_TIME of the date, datetime or timestamp column, same
+  way str_to_ts() does from its string representation.
+*/
+int ssps_get_timestamp(STMT *stmt, ulong column_number,
+                       SQL_TIMESTAMP_STRUCT *ts, int zeroToMin)
+{
+  MYSQL_TIME *t= (MYSQL_TIME *)stmt->result_bind[column_number].buffer;
+
+  if (t->month == 0 || t->day == 0)
+  {
+    if (!zeroToMin) /* Don't convert invalid */
+      return SQLTS_NULL_DATE;
+  }
+
+  if (ts != NULL)
+  {
+    ts->year=     t->year;
+    ts->month=    t->month ? t->month : 1;
+    ts->day=      t->day ? t->day : 1;
+    ts->hour=     t->hour;
+    ts->minute=   t->minute;
+    ts->second=   t->second;
+    ts->fraction= (SQLUINTEGER)t->second_part * 1000;
+  }
+
+  return 0;
+}
+/* }}} */
+
+
 /* {{{ ssps_get_int64() -I- */
 long long ssps_get_int64(STMT *stmt, ulong column_number, char *value, ulong length)
 {
@@ -940,6 +1285,8 @@ long long ssps_get_int64(STMT *stmt, ulong column_number, char *value, ulong len
 SQLRETURN ssps_send_long_data(STMT *stmt, unsigned int param_number, const char *chunk,
                             unsigned long length)
 {
+  readahead_pause(stmt->dbc);
+
   if ( mysql_stmt_send_long_data(stmt->ssps, param_number, chunk, length))
   {
     uint err= mysql_stmt_errno(stmt->ssps);
@@ -57,7 +57,7 @@ BOOL returned_result(STMT *stmt)
   }
   else
   {
-    return mysql_field_count(&stmt->dbc->mysql) > 0 ;
+    return mysql_field_count(stmt->dbc->mysql) > 0 ;
   }
 }
 
@@ -73,6 +73,7 @@ my_bool free_current_result(STMT *stmt)
       res= mysql_stmt_free_result(stmt->ssps);
     }
     free_internal_result_buffers(stmt);
+    readahead_free(stmt);
     /* We need to always free stmt->result because SSPS keep metadata there */
     if (stmt->fake_result)
     {
@@ -81,6 +82,9 @@ my_bool free_current_result(STMT *stmt)
     else
       mysql_free_result(stmt->result);
 
+    invalidate_conversion_plan(stmt);
+    invalidate_row_index(stmt);
+    invalidate_keyset(stmt);
     stmt->result= NULL;
   }
   return res;
@@ -96,22 +100,33 @@ MYSQL_RES * stmt_get_result(STMT *stmt, BOOL force_use)
   /* We can't use USE_RESULT because SQLRowCount will fail in this case! */
   if (if_forward_cache(stmt) || force_use)
   {
-    return mysql_use_result(&stmt->dbc->mysql);
+    return mysql_use_result(stmt->dbc->mysql);
   }
   else
   {
-    return mysql_store_result(&stmt->dbc->mysql);
+    return mysql_store_result(stmt->dbc->mysql);
   }
 }
 
 
-/* For text protocol this get result itself as well. Besides for text protocol
-   we need to use/store each resultset of multiple resultsets */
-MYSQL_RES * get_result_metadata(STMT *stmt, BOOL force_use)
+/* Frees the current result of the statement, before it gets the next one */
+static void drop_result(STMT *stmt)
 {
   free_internal_result_buffers(stmt);
+  readahead_free(stmt);
   /* just a precaution, mysql_free_result checks for NULL anywat */
   mysql_free_result(stmt->result);
+  invalidate_conversion_plan(stmt);
+  invalidate_row_index(stmt);
+  invalidate_keyset(stmt);
+}
+
+
+/* For text protocol this get result itself as well. Besides for text protocol
+   we need to use/store each resultset of multiple resultsets */
+MYSQL_RES * get_result_metadata(STMT *stmt, BOOL force_use)
+{
+  drop_result(stmt);
 
   if (ssps_used(stmt))
   {
@@ -158,7 +173,7 @@ unsigned int field_count(STMT *stmt)
   {
     return stmt->result && stmt->result->field_count > 0 ?
       stmt->result->field_count :
-      mysql_field_count(&stmt->dbc->mysql);
+      mysql_field_count(stmt->dbc->mysql);
   }
 }
 
@@ -172,7 +187,7 @@ my_ulonglong affected_rows(STMT *stmt)
   else
   {
     /* In some cases in c/odbc it cannot be used instead of mysql_num_rows */
-    return mysql_affected_rows(&stmt->dbc->mysql);
+    return mysql_affected_rows(stmt->dbc->mysql);
   }
 }
 
@@ -197,6 +212,11 @@ my_ulonglong num_rows(STMT *stmt)
   {
     return  offset + mysql_stmt_num_rows(stmt->ssps);
   }
+  else if (stmt->readahead)
+  {
+    /* Rows read ahead are not fetched yet */
+    return offset + stmt->readahead->consumed;
+  }
   else
   {
     return offset + mysql_num_rows(stmt->result);
@@ -226,6 +246,11 @@ MYSQL_ROW fetch_row(STMT *stmt)
   }
   else
   {
+    if (readahead_wanted(stmt))
+    {
+      return readahead_fetch(stmt);
+    }
+
     return mysql_fetch_row(stmt->result);
   }
 }
@@ -239,7 +264,7 @@ unsigned long* fetch_lengths(STMT *stmt)
   }
   else
   {
-    return mysql_fetch_lengths(stmt->result);
+    return readahead_lengths(stmt);
   }
 }
 
@@ -257,12 +282,117 @@ MYSQL_ROW_OFFSET row_seek(STMT *stmt, MYSQL_ROW_OFFSET offset)
 }
 
 
+/**
+  Mark the row index of the statement as outdated. Has to be called whenever
+  the result is freed or replaced.
+*/
+void invalidate_row_index(STMT *stmt)
+{
+  stmt->row_index.result= NULL;
+  stmt->row_index.count= 0;
+}
+
+
+/* Index is valid for the current result if it has not been changed since
+   the index was built - catalog functions drop rows of the results */
+static my_bool row_index_valid(STMT *stmt)
+{
+  MY_ROW_INDEX *index= &stmt->row_index;
+
+  return index->result == stmt->result
+      && index->count == stmt->result->row_count
+      && index->count > 0
+      && index->rows[0] == stmt->result->data->data;
+}
+
+
+/**
+  Build the row index for the current stored result.
+
+  @return TRUE on allocation error
+*/
+static my_bool build_row_index(STMT *stmt)
+{
+  MY_ROW_INDEX *index= &stmt->row_index;
+  MYSQL_ROWS   *row;
+  my_ulonglong  count= stmt->result->row_count;
+
+  invalidate_row_index(stmt);
+
+  if (count > index->alloced)
+  {
+    MYSQL_ROWS **rows= (MYSQL_ROWS **)myodbc_realloc(index->rows,
+                                          (size_t)count * sizeof(MYSQL_ROWS *),
+                                          MYF(MY_ALLOW_ZERO_PTR));
+    if (rows == NULL)
+    {
+      return TRUE;
+    }
+
+    index->rows= rows;
+    index->alloced= count;
+  }
+
+  for (row= stmt->result->data->data; row && index->count < count;
+       row= row->next)
+  {
+    index->rows[index->count++]= row;
+  }
+
+  /* row_count does not agree with the list, walking it is the only way */
+  if (index->count != count)
+  {
+    invalidate_row_index(stmt);
+    return TRUE;
+  }
+
+  index->result= stmt->result;
+
+  return FALSE;
+}
+
+
+/**
+  Get the row of the current stored result by its number without walking
+  the list of rows, unless memory for the index can't be allocated.
+
+  @return NULL if the row number is past the end of the result
+*/
+MYSQL_ROWS * stored_row(STMT *stmt, my_ulonglong row_num)
+{
+  MYSQL_ROWS *row= stmt->result->data->data;
+
+  if (row_num == 0 || row_num >= stmt->result->row_count)
+  {
+    return row_num == 0 ? row : NULL;
+  }
+
+  if (row_index_valid(stmt) || !build_row_index(stmt))
+  {
+    return stmt->row_index.rows[row_num];
+  }
+
+  for (; row && row_num > 0; --row_num)
+  {
+    row= row->next;
+  }
+
+  return row;
+}
+
+
 void data_seek(STMT *stmt, my_ulonglong offset)
 {
   if (ssps_used(stmt))
   {
     mysql_stmt_data_seek(stmt->ssps, offset);
   }
+  else if (stmt->result->data != NULL)
+  {
+    /* What mysql_data_seek() does, just without walking rows */
+    stmt->result->current_row= 0;
+    stmt->result->data_cursor= stored_row(stmt, offset);
+  }
   else
   {
     mysql_data_seek(stmt->result, offset);
@@ -289,11 +419,12 @@ int next_result(STMT *stmt)
 
   if (ssps_used(stmt))
   {
+    readahead_pause(stmt->dbc);
     return mysql_stmt_next_result(stmt->ssps);
   }
   else
   {
-    return mysql_next_result(&stmt->dbc->mysql);
+    return mysql_next_result(readahead_yield(stmt->dbc));
   }
 }
 
@@ -365,6 +496,18 @@ BOOL is_null(STMT *stmt, ulong column_number, char *value)
   }
 }
 
+/* SELECT without parameters is also worth preparing on the server if the
+   connection keeps prepared statements - that costs a round trip only once,
+   and its result comes in binary, not requiring parsing of values. Prefetch
+   option, though, requires text protocol */
+static BOOL binary_result_wanted(STMT *stmt)
+{
+  return stmt->dbc->ds->ssps_cache_size > 0
+      && stmt->dbc->ds->cursor_prefetch_number == 0
+      && is_select_statement(&stmt->query);
+}
+
+
 /* Prepares statement depending on connection option either on a client or
    on a server. Returns SQLRETURN result code since preparing on client or
    server can produce errors, memory allocation to name one.  */
@@ -389,26 +532,42 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
   ssps_close(stmt);
   stmt->param_count= PARAM_COUNT(&stmt->query);
   /* Trusting our parsing we are not using prepared statments unsless there are
-     actually parameter markers in it */
-  if (!stmt->dbc->ds->no_ssps && PARAM_COUNT(&stmt->query) && !IS_BATCH(&stmt->query)
-    && preparable_on_server(&stmt->query, stmt->dbc->mysql.server_version))
+     actually parameter markers in it, or binary result is wanted */
+  if (!stmt->dbc->ds->no_ssps && !IS_BATCH(&stmt->query)
+    && (PARAM_COUNT(&stmt->query) || binary_result_wanted(stmt))
+    && preparable_on_server(&stmt->query, stmt->dbc->mysql->server_version))
   {
-    MYLOG_QUERY(stmt, "Using prepared statement");
-    ssps_init(stmt);
+    /* The connection may keep the statement prepared for the same query */
+    BOOL cached= !get_cursor_name(&stmt->query)
+                 && ssps_cache_take(stmt, query, query_length);
+
+    MYLOG_QUERY(stmt, cached ? "Using cached prepared statement"
+                             : "Using prepared statement");
+    if (!cached)
+    {
+      myodbc_mutex_lock(&stmt->dbc->lock);
+      readahead_pause(stmt->dbc);
+      ssps_init(stmt);
+    }
 
     /* If the query is in the form of "WHERE CURRENT OF" - we do not need to prepare
        it at the moment */
     if (!get_cursor_name(&stmt->query))
     {
-      if (mysql_stmt_prepare(stmt->ssps, query, query_length))
+      if (!cached && mysql_stmt_prepare(stmt->ssps, query, query_length))
       {
-        MYLOG_QUERY(stmt, mysql_error(&stmt->dbc->mysql));
+        MYLOG_QUERY(stmt, mysql_error(stmt->dbc->mysql));
 
-        set_stmt_error(stmt,"HY000",mysql_error(&stmt->dbc->mysql),
-                       mysql_errno(&stmt->dbc->mysql));
+        /* Not to be cached */
+        x_free(stmt->ssps_entry);
+        stmt->ssps_entry= NULL;
+
+        set_stmt_error(stmt,"HY000",mysql_error(stmt->dbc->mysql),
+                       mysql_errno(stmt->dbc->mysql));
         translate_error(stmt->error.sqlstate,MYERR_S1000,
-                        mysql_errno(&stmt->dbc->mysql));
+                        mysql_errno(stmt->dbc->mysql));
 
+        myodbc_mutex_unlock(&stmt->dbc->lock);
         return SQL_ERROR;
       }
 
@@ -427,6 +586,19 @@ SQLRETURN prepare(STMT *stmt, char * query, SQLINTEGER query_length)
       }
     /*assert(stmt->param_count==PARAM_COUNT(&stmt->query));*/
     }
+
+    if (!cached)
+    {
+      myodbc_mutex_unlock(&stmt->dbc->lock);
+    }
+  }
+
+  /* Query built on the client is compiled once for all its executions */
+  RESET_TEMPLATE(&stmt->query_template);
+  if (!ssps_used(stmt) && PARAM_COUNT(&stmt->query) > 0
+    && build_query_template(&stmt->query_template, &stmt->query))
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
   }
 
   {
@@ -515,11 +687,18 @@ SQLRETURN send_long_data (STMT *stmt, unsigned int param_num, DESCREC * aprec, c
 
 
 /*------------------- Scrolled cursor related stuff -------------------*/
+/* Called under dbc->lock, which the page read ahead is waited for under */
 void scroller_reset(STMT *stmt)
 {
+  page_ahead_free(stmt);
   x_free(stmt->scroller.query);
+  x_free(stmt->scroller.key_head);
+  x_free(stmt->scroller.key_tail);
+  x_free(stmt->scroller.key_last);
   stmt->scroller.next_offset= 0;
   stmt->scroller.query= stmt->scroller.offset_pos= NULL;
+  stmt->scroller.key_head= stmt->scroller.key_tail= NULL;
+  stmt->scroller.key_last= NULL;
 }
 
 /* @param[in]     selected  - prefetch value in datatsource selected by user
@@ -590,7 +769,7 @@ void scroller_create(STMT * stmt, char *query, SQLULEN query_len)
 
   stmt->scroller.next_offset= myodbc_max(limit.offset, 0);
 
-  /*extend_buffer(&stmt->dbc->mysql.net, stmt->query_end, len2add);*/
+  /*extend_buffer(&stmt->dbc->mysql->net, stmt->query_end, len2add);*/
   stmt->scroller.query_len= query_len + len2add;
   stmt->scroller.query= (char*)myodbc_malloc((size_t)stmt->scroller.query_len + 1,
                                           MYF(MY_ZEROFILL));
@@ -629,49 +808,644 @@ unsigned long long scroller_move(STMT * stmt)
 }
 
 
-SQLRETURN scroller_prefetch(STMT * stmt)
+/* Number of rows in the page at the offset, 0 if the page is past the rows
+   to fetch. scroller initialization makes impossible row_count to be >
+   stmt's max_rows */
+static unsigned int scroller_page_rows(STMT *stmt, unsigned long long offset)
 {
+  unsigned long long end= stmt->scroller.total_rows + stmt->scroller.start_offset;
+
   if (stmt->scroller.total_rows > 0
-      && stmt->scroller.next_offset >= (stmt->scroller.total_rows + stmt->scroller.start_offset))
+      && offset + stmt->scroller.row_count > end)
   {
-    /* (stmt->scroller.next_offset - stmt->scroller.row_count) - current offset,
-       0 minimum. scroller initialization makes impossible row_count to be > 
-       stmt's max_rows */
-     long long count= stmt->scroller.total_rows -
-      (stmt->scroller.next_offset - stmt->scroller.row_count - stmt->scroller.start_offset);
+    return offset < end ? (unsigned int)(end - offset) : 0;
+  }
 
-    if (count > 0)
-    {
-      myodbc_snprintf(stmt->scroller.offset_pos + MAX64_BUFF_SIZE, MAX32_BUFF_SIZE,
-              "%*u", MAX32_BUFF_SIZE - 1, (unsigned long)count);
-      stmt->scroller.offset_pos[MAX64_BUFF_SIZE + MAX32_BUFF_SIZE - 1] = ' ';
-    }
-    else
+  return stmt->scroller.row_count;
+}
+
+
+/* Query of the page at the offset. Pages right after the last one read are
+   read by the key, if the query allows that, others with the offset */
+static char * scroller_page_query(STMT *stmt, unsigned long long offset,
+                                  unsigned int count, unsigned long *length)
+{
+  MY_LIMIT_SCROLLER *scroller= &stmt->scroller;
+  char              *query, *pos;
+
+  if (scroller->key_last != NULL && scroller->key_offset == offset)
+  {
+    size_t head_len= strlen(scroller->key_head),
+           last_len= strlen(scroller->key_last),
+           tail_len= strlen(scroller->key_tail);
+
+    if (!(query= (char *)myodbc_malloc(head_len + last_len + tail_len
+                                       + 7/*" LIMIT "*/ + MAX32_BUFF_SIZE,
+                                       MYF(0))))
     {
-      return SQL_NO_DATA;
+      return NULL;
     }
+
+    memcpy(query, scroller->key_head, head_len);
+    memcpy(query + head_len, scroller->key_last, last_len);
+    memcpy(query + head_len + last_len, scroller->key_tail, tail_len);
+    pos= query + head_len + last_len + tail_len;
+    *length= (unsigned long)(pos - query)
+           + myodbc_snprintf(pos, 7 + MAX32_BUFF_SIZE, " LIMIT %u", count);
+
+    return query;
+  }
+
+  if (!(query= (char *)myodbc_malloc((size_t)scroller->query_len + 1, MYF(0))))
+  {
+    return NULL;
   }
 
-  MYLOG_QUERY(stmt, stmt->scroller.query);
+  memcpy(query, scroller->query, (size_t)scroller->query_len + 1);
+  pos= query + (scroller->offset_pos - scroller->query);
+
+  myodbc_snprintf(pos, MAX64_BUFF_SIZE, "%*llu", MAX64_BUFF_SIZE - 1, offset);
+  pos[MAX64_BUFF_SIZE - 1]= ',';
+  myodbc_snprintf(pos + MAX64_BUFF_SIZE, MAX32_BUFF_SIZE, "%*u",
+                  MAX32_BUFF_SIZE - 1, count);
+  pos[MAX64_BUFF_SIZE + MAX32_BUFF_SIZE - 1]= ' ';
+
+  *length= (unsigned long)scroller->query_len;
 
+  return query;
+}
+
+
+SQLRETURN scroller_prefetch(STMT * stmt)
+{
+  /* scroller_move() has already made the page current */
+  unsigned long long offset= stmt->scroller.next_offset - stmt->scroller.row_count;
+  unsigned int       count= scroller_page_rows(stmt, offset);
+  unsigned long      length;
+  MYSQL_RES          *page;
+  char               *query;
+
+  if (count == 0)
+  {
+    return SQL_NO_DATA;
+  }
+
+  /* The page thread is waited for and started under the lock */
   myodbc_mutex_lock(&stmt->dbc->lock);
 
-  if (exec_stmt_query(stmt, stmt->scroller.query,
-                        (unsigned long)stmt->scroller.query_len, FALSE))
+  /* The page has been read while the application fetched the previous one */
+  if ((page= page_ahead_take(stmt, offset)) != NULL)
   {
+    MYLOG_QUERY(stmt, "Using the page read ahead");
+    drop_result(stmt);
+    stmt->result= page;
+    scroller_read_ahead(stmt);
     myodbc_mutex_unlock(&stmt->dbc->lock);
+
+    return SQL_SUCCESS;
+  }
+
+  if (!(query= scroller_page_query(stmt, offset, count, &length)))
+  {
+    myodbc_mutex_unlock(&stmt->dbc->lock);
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  MYLOG_QUERY(stmt, query);
+
+  if (exec_stmt_query(stmt, query, length, FALSE))
+  {
+    myodbc_mutex_unlock(&stmt->dbc->lock);
+    x_free(query);
     return SQL_ERROR;
   }
 
+  x_free(query);
+
   get_result_metadata(stmt, FALSE);
 
   /* I think there is no need to do fix_result_types here */
+  scroller_read_ahead(stmt);
+
   myodbc_mutex_unlock(&stmt->dbc->lock);
 
   return SQL_SUCCESS;
 }
 
 
+/*
+  Starts reading the page after the current one in background, if the
+  current one is stored and full. Remembers the key of its last row for
+  the query of the next page before that. Called under dbc->lock.
+*/
+void scroller_read_ahead(STMT *stmt)
+{
+  MY_LIMIT_SCROLLER *scroller= &stmt->scroller;
+  unsigned long long offset= scroller->next_offset;
+  unsigned long      length;
+  my_ulonglong       rows;
+  unsigned int       count;
+  char               *query;
+
+  if (stmt->result == NULL || stmt->result->data == NULL)
+  {
+    return;
+  }
+
+  rows= mysql_num_rows(stmt->result);
+
+  if (scroller->key_head != NULL)
+  {
+    x_free(scroller->key_last);
+    scroller->key_last= NULL;
+
+    if (rows > 0)
+    {
+      MYSQL_ROW_OFFSET  position= row_tell(stmt);
+      MYSQL_ROW         values;
+      unsigned long     *lengths;
+      MYSQL_FIELD       *field= stmt->result->fields + scroller->key_field;
+
+      data_seek(stmt, rows - 1);
+      values=  mysql_fetch_row(stmt->result);
+      lengths= mysql_fetch_lengths(stmt->result);
+
+      if (values && values[scroller->key_field] &&
+          (scroller->key_last= (char *)myodbc_malloc(
+                             lengths[scroller->key_field] * 2 + 3, MYF(0))))
+      {
+        char *to= scroller->key_last;
+
+        if (IS_NUM(field->type))
+        {
+          memcpy(to, values[scroller->key_field], lengths[scroller->key_field]);
+          to+= lengths[scroller->key_field];
+        }
+        else
+        {
+          /* Nothing else may use the connection meanwhile */
+          readahead_pause(stmt->dbc);
+          *to++= '\'';
+          to+= mysql_real_escape_string(stmt->dbc->mysql, to,
+                                        values[scroller->key_field],
+                                        lengths[scroller->key_field]);
+          *to++= '\'';
+        }
+        *to= '\0';
+
+        scroller->key_offset= offset - scroller->row_count + rows;
+      }
+
+      row_seek(stmt, position);
+    }
+  }
+
+  /* Fewer rows than asked for - there are no more */
+  if (rows < scroller_page_rows(stmt, offset - scroller->row_count)
+   || (count= scroller_page_rows(stmt, offset)) == 0)
+  {
+    return;
+  }
+
+  if ((query= scroller_page_query(stmt, offset, count, &length)))
+  {
+    page_ahead_start(stmt, query, length, offset);
+  }
+}
+
+
+#define IS_NAME_CHAR(c) (isalnum((uchar)(c)) || (c) == '_' || (c) == '$' \
+                         || (uchar)(c) >= 0x80)
+
+/* Checks if the word is at the position, and is not a part of a longer one */
+static BOOL is_word_at(const char *pos, const char *begin, const char *end,
+                       const char *word)
+{
+  size_t len= strlen(word);
+
+  return (pos == begin || !IS_NAME_CHAR(pos[-1]))
+      && (size_t)(end - pos) >= len && !myodbc_casecmp(pos, word, (uint)len)
+      && (pos + len == end || !IS_NAME_CHAR(pos[len]));
+}
+
+
+/*
+  Finds WHERE and ORDER BY of a SELECT from a single table, outside of quotes,
+  comments and parentheses. Returns FALSE if the query is not like that or
+  has clauses keyset pagination can't be used with.
+*/
+static BOOL find_order_clause(const char *query, const char *end,
+                              const char **where, const char **order)
+{
+  static const char *other[]= {"GROUP", "HAVING", "WINDOW", "UNION", "JOIN",
+                               "STRAIGHT_JOIN", "INTO", "PROCEDURE", NULL};
+  const char *pos, *from= NULL;
+  int        depth= 0, i;
+
+  *where= *order= NULL;
+
+  for (pos= query; pos < end; ++pos)
+  {
+    if (*pos == '\'' || *pos == '"' || *pos == '`')
+    {
+      char quote= *pos;
+
+      for (++pos; pos < end && *pos != quote; ++pos)
+      {
+        if (*pos == '\\' && quote != '`')
+        {
+          ++pos;
+        }
+      }
+
+      if (pos >= end)
+      {
+        return FALSE;
+      }
+    }
+    else if (*pos == '/' && pos + 1 < end && pos[1] == '*')
+    {
+      /* Versioned comments are executed */
+      if (pos + 2 < end && pos[2] == '!')
+      {
+        return FALSE;
+      }
+
+      for (pos+= 2; pos + 1 < end && !(pos[0] == '*' && pos[1] == '/'); ++pos);
+
+      if (pos + 1 >= end)
+      {
+        return FALSE;
+      }
+      ++pos;
+    }
+    else if (*pos == '#' || (*pos == '-' && pos + 2 < end && pos[1] == '-'
+                             && isspace((uchar)pos[2])))
+    {
+      while (pos < end && *pos != '\n')
+      {
+        ++pos;
+      }
+    }
+    else if (*pos == '(')
+    {
+      ++depth;
+    }
+    else if (*pos == ')')
+    {
+      --depth;
+    }
+    else if (depth > 0)
+    {
+      continue;
+    }
+    else if (*pos == ',' && from && !*where && !*order)
+    {
+      /* More than one table */
+      return FALSE;
+    }
+    else if (IS_NAME_CHAR(*pos) && (pos == query || !IS_NAME_CHAR(pos[-1])))
+    {
+      if (is_word_at(pos, query, end, "FROM"))
+      {
+        if (from)
+        {
+          return FALSE;
+        }
+        from= pos;
+      }
+      else if (is_word_at(pos, query, end, "WHERE"))
+      {
+        if (!from || *where || *order)
+        {
+          return FALSE;
+        }
+        *where= pos;
+      }
+      else if (is_word_at(pos, query, end, "ORDER"))
+      {
+        if (!from || *order)
+        {
+          return FALSE;
+        }
+        *order= pos;
+      }
+      else
+      {
+        for (i= 0; other[i]; ++i)
+        {
+          if (is_word_at(pos, query, end, other[i]))
+          {
+            return FALSE;
+          }
+        }
+      }
+
+      while (pos + 1 < end && IS_NAME_CHAR(pos[1]))
+      {
+        ++pos;
+      }
+    }
+  }
+
+  return depth == 0 && *order != NULL;
+}
+
+
+/* Reads a name, quoted or not. Returns the position after it, or NULL */
+static const char * read_name(const char *pos, const char *end, char *name)
+{
+  size_t len= 0;
+
+  if (pos < end && *pos == '`')
+  {
+    for (++pos; pos < end; ++pos)
+    {
+      if (*pos == '`')
+      {
+        if (pos + 1 == end || pos[1] != '`')
+        {
+          break;
+        }
+        ++pos;
+      }
+
+      if (len == NAME_LEN)
+      {
+        return NULL;
+      }
+      name[len++]= *pos;
+    }
+
+    if (pos == end)
+    {
+      return NULL;
+    }
+    ++pos;
+  }
+  else
+  {
+    while (pos < end && IS_NAME_CHAR(*pos))
+    {
+      if (len == NAME_LEN)
+      {
+        return NULL;
+      }
+      name[len++]= *pos++;
+    }
+  }
+
+  name[len]= '\0';
+
+  return len > 0 ? pos : NULL;
+}
+
+
+/* Reads "ORDER BY [table.]column [ASC|DESC]" up to the end of the query */
+static BOOL read_order_key(const char *order, const char *end,
+                           char *table, char *column, BOOL *desc)
+{
+  const char *pos= order + 5;
+
+  while (pos < end && isspace((uchar)*pos))
+  {
+    ++pos;
+  }
+
+  if (!is_word_at(pos, order, end, "BY"))
+  {
+    return FALSE;
+  }
+
+  for (pos+= 2; pos < end && isspace((uchar)*pos); ++pos);
+
+  if (!(pos= read_name(pos, end, column)))
+  {
+    return FALSE;
+  }
+
+  table[0]= '\0';
+
+  if (pos < end && *pos == '.')
+  {
+    strcpy(table, column);
+
+    if (!(pos= read_name(pos + 1, end, column)))
+    {
+      return FALSE;
+    }
+  }
+
+  while (pos < end && isspace((uchar)*pos))
+  {
+    ++pos;
+  }
+
+  *desc= is_word_at(pos, order, end, "DESC");
+
+  if (*desc || is_word_at(pos, order, end, "ASC"))
+  {
+    while (pos < end && IS_NAME_CHAR(*pos))
+    {
+      ++pos;
+    }
+  }
+
+  while (pos < end && (isspace((uchar)*pos) || *pos == ';'))
+  {
+    ++pos;
+  }
+
+  return pos == end;
+}
+
+
+/* Checks if the values of the field can be compared as their text is */
+static BOOL keyset_type(MYSQL_FIELD *field)
+{
+  switch (field->type)
+  {
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIME:
+      return TRUE;
+    case MYSQL_TYPE_STRING:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_VARCHAR:
+      return field->charsetnr != BINARY_CHARSET_NUMBER;
+    default:
+      return FALSE;
+  }
+}
+
+
+/* Checks if the column alone is a unique key of the table */
+static BOOL unique_key_column(STMT *stmt, MYSQL_FIELD *field)
+{
+  TABLE_KEYS *keys= table_keys_get(stmt, field->db,
+                                   field->db ? (uint)strlen(field->db) : 0,
+                                   field->org_table,
+                                   (uint)strlen(field->org_table));
+  BOOL       found= FALSE;
+  uint       i, j;
+
+  if (keys == NULL)
+  {
+    return FALSE;
+  }
+
+  for (i= 0; i < keys->row_count && !found; ++i)
+  {
+    char **row= keys->rows + i * TABLE_KEYS_FIELDS;
+
+    /* Non_unique, Seq_in_index, Column_name */
+    if (row[1] && row[1][0] == '0' && row[3] && !strcmp(row[3], "1")
+     && row[4] && !myodbc_strcasecmp(row[4], field->org_name))
+    {
+      found= TRUE;
+
+      for (j= 0; j < keys->row_count; ++j)
+      {
+        char **part= keys->rows + j * TABLE_KEYS_FIELDS;
+
+        if (j != i && part[2] && row[2] && !strcmp(part[2], row[2]))
+        {
+          found= FALSE;
+        }
+      }
+    }
+  }
+
+  x_free(keys);
+
+  return found;
+}
+
+
+/*
+  Prepares reading pages after the first one by the key of their first row
+  instead of the offset, so that deep pages cost the server as much as the
+  first one. Has to be called once the first page is stored. Only queries
+  from a single table, ordered by a column that alone is a unique key, and
+  that column is in the result, are read that way.
+*/
+void scroller_keyset_init(STMT *stmt)
+{
+  MY_LIMIT_SCROLLER *scroller= &stmt->scroller;
+  const char        *query= scroller->query, *end= scroller->offset_pos - 7,
+                    *rest, *where, *order;
+  char              table[NAME_LEN + 1], column[NAME_LEN + 1];
+  BOOL              desc;
+  MYSQL_FIELD       *field= NULL;
+  DYNAMIC_STRING    head, tail;
+  uint              i;
+
+  /* Single page */
+  if (stmt->result == NULL || stmt->result->data == NULL
+   || mysql_num_rows(stmt->result) <
+        scroller_page_rows(stmt, scroller->next_offset - scroller->row_count))
+  {
+    return;
+  }
+
+  /* Nothing may follow the LIMIT */
+  for (rest= scroller->offset_pos + MAX64_BUFF_SIZE + MAX32_BUFF_SIZE - 1;
+       rest < query + scroller->query_len; ++rest)
+  {
+    if (*rest && *rest != ';' && !isspace((uchar)*rest))
+    {
+      return;
+    }
+  }
+
+  if (!find_order_clause(query, end, &where, &order)
+   || !read_order_key(order, end, table, column, &desc))
+  {
+    return;
+  }
+
+  /* ORDER BY may refer to an alias, and only a column can be compared in
+     WHERE */
+  for (i= 0; i < stmt->result->field_count; ++i)
+  {
+    MYSQL_FIELD *candidate= stmt->result->fields + i;
+
+    if (!myodbc_strcasecmp(candidate->name, column))
+    {
+      if (field != NULL)
+      {
+        return;
+      }
+      field= candidate;
+      scroller->key_field= i;
+    }
+  }
+
+  if (field == NULL || !field->org_name || myodbc_strcasecmp(field->org_name, column)
+   || !field->table || !*field->table || !field->org_table || !*field->org_table
+   || (*table && myodbc_strcasecmp(field->table, table))
+   || !(field->flags & NOT_NULL_FLAG) || !keyset_type(field)
+   || !unique_key_column(stmt, field))
+  {
+    return;
+  }
+
+  if (init_dynamic_string(&head, "", 1024, 1024))
+  {
+    return;
+  }
+
+  if (init_dynamic_string(&tail, " ", 256, 256))
+  {
+    dynstr_free(&head);
+    return;
+  }
+
+  if (where)
+  {
+    dynstr_append_mem(&head, query, where + 5 - query);
+    dynstr_append_mem(&head, " (", 2);
+    dynstr_append_mem(&head, where + 5, order - where - 5);
+    dynstr_append_mem(&head, ") AND ", 6);
+  }
+  else
+  {
+    dynstr_append_mem(&head, query, order - query);
+    dynstr_append_mem(&head, " WHERE ", 7);
+  }
+
+  dynstr_append_quoted_name(&head, field->table);
+  dynstr_append_mem(&head, ".", 1);
+  dynstr_append_quoted_name(&head, field->org_name);
+  dynstr_append_mem(&head, desc ? " < " : " > ", 3);
+
+  /* LIMIT goes after the ORDER BY, its end is trimmed */
+  for (rest= end; rest > order && (isspace((uchar)rest[-1]) || rest[-1] == ';');
+       --rest);
+  dynstr_append_mem(&tail, order, rest - order);
+
+  scroller->key_head= myodbc_strdup(head.str, MYF(0));
+  scroller->key_tail= myodbc_strdup(tail.str, MYF(0));
+
+  dynstr_free(&head);
+  dynstr_free(&tail);
+
+  if (scroller->key_head == NULL || scroller->key_tail == NULL)
+  {
+    x_free(scroller->key_head);
+    x_free(scroller->key_tail);
+    scroller->key_head= scroller->key_tail= NULL;
+  }
+}
+
 
 BOOL scrollable(STMT * stmt, char * query, char * query_end)
 {
@@ -40,12 +40,19 @@
 */
 
 #define if_dynamic_cursor(st) ((st)->stmt_options.cursor_type == SQL_CURSOR_DYNAMIC)
-#define if_forward_cache(st) ((st)->stmt_options.cursor_type == SQL_CURSOR_FORWARD_ONLY && \
-			     (st)->dbc->ds->dont_cache_result)
-#define is_connected(dbc)    ((dbc)->mysql.net.vio)
-#define trans_supported(db) ((db)->mysql.server_capabilities & CLIENT_TRANSACTIONS)
-#define autocommit_on(db) ((db)->mysql.server_status & SERVER_STATUS_AUTOCOMMIT)
-#define is_no_backslashes_escape_mode(db) ((db)->mysql.server_status & SERVER_STATUS_NO_BACKSLASH_ESCAPES)
+/* Rows of a result are stored on the client, read as they are fetched, or
+   read ahead in background */
+#define RESULT_STORED   0
+#define RESULT_USED     1
+#define RESULT_STREAMED 2
+#define result_mode(st) ((st)->stmt_options.cursor_type != SQL_CURSOR_FORWARD_ONLY ? RESULT_STORED : \
+                         (st)->dbc->ds->readahead_rows > 0 ? RESULT_STREAMED : \
+                         (st)->dbc->ds->dont_cache_result ? RESULT_USED : RESULT_STORED)
+#define if_forward_cache(st) (result_mode(st) != RESULT_STORED)
+#define is_connected(dbc)    ((dbc)->mysql->net.vio)
+#define trans_supported(db) ((db)->mysql->server_capabilities & CLIENT_TRANSACTIONS)
+#define autocommit_on(db) ((db)->mysql->server_status & SERVER_STATUS_AUTOCOMMIT)
+#define is_no_backslashes_escape_mode(db) ((db)->mysql->server_status & SERVER_STATUS_NO_BACKSLASH_ESCAPES)
 #define reset_ptr(x) {if (x) x= 0;}
 #define digit(A) ((int) (A - '0'))
 
@@ -68,6 +75,11 @@
 #define SQLTS_NULL_DATE -1
 #define SQLTS_BAD_DATE -2
 
+/* Fields with date part, fetched into MYSQL_TIME by prepared statements */
+#define IS_DATE_FIELD(field) ((field)->type == MYSQL_TYPE_DATE \
+                           || (field)->type == MYSQL_TYPE_DATETIME \
+                           || (field)->type == MYSQL_TYPE_TIMESTAMP)
+
 /* Sizes of buffer for converion of 4 and 8 bytes integer values*/
 #define MAX32_BUFF_SIZE 11
 #define MAX64_BUFF_SIZE 21
@@ -156,6 +168,7 @@ char *    add_to_buffer (NET *net,char *to,const char *from,ulong length);
 void reset_getdata_position   (STMT *stmt);
 
 SQLRETURN set_sql_select_limit(DBC *dbc, SQLULEN new_value, my_bool reqLock);
+ulong     get_max_allowed_packet(DBC *dbc);
 SQLRETURN exec_stmt_query(STMT *stmt, const char *query, SQLULEN query_length,
                            my_bool reqLock);
 
@@ -177,7 +190,7 @@ SQLRETURN copy_binhex_result(STMT *stmt,
 			     ulong src_length);
 SQLRETURN copy_wchar_result(STMT *stmt,
                             SQLWCHAR *rgbValue, SQLINTEGER cbValueMax,
-                            SQLLEN *pcbValue, MYSQL_FIELD *field, char *src,
+                            SQLLEN *pcbValue, CHARSET_INFO *from_cs, char *src,
                             long src_length);
 
 SQLRETURN set_dbc_error   (DBC *dbc, char *state,const char *message,uint errcode);
@@ -280,11 +293,18 @@ void myodbc_end();
 my_bool myodbc_net_realloc(NET *net, size_t length);
 void myodbc_net_end(NET *net);
 my_bool set_dynamic_result        (STMT *stmt);
+my_bool refresh_dynamic_rows      (STMT *stmt, long first_row, long rows);
 void    set_current_cursor_data   (STMT *stmt,SQLUINTEGER irow);
+my_bool keyset_refresh            (STMT *stmt, long first_row, long rows);
+void    invalidate_keyset         (STMT *stmt);
+TABLE_KEYS *table_keys_get        (STMT *stmt, const char *db, uint db_len,
+                                   const char *table, uint table_len);
+void    key_cache_free            (DBC *dbc);
 my_bool is_minimum_version        (const char *server_version,const char *version);
 int     myodbc_strcasecmp         (const char *s, const char *t);
 int     myodbc_casecmp            (const char *s, const char *t, uint len);
 my_bool reget_current_catalog     (DBC *dbc);
+char *  current_catalog_copy      (DBC *dbc, char *to, const char *none);
 
 ulong   myodbc_escape_string      (MYSQL *mysql, char *to, ulong to_length,
                                   const char *from, ulong length, int escape_id);
@@ -352,9 +372,14 @@ const char *get_fractional_part   (const char * str, int len,
                                   SQLUINTEGER * fraction);
 /* Convert MySQL timestamp to full ANSI timestamp format. */
 char *          complete_timestamp  (const char * value, ulong length, char buff[21]);
+void            numeric_locale_init        (void);
+void            numeric_locale_end         (void);
 long double     myodbc_strtold             (const char *nptr, char **endptr);
+size_t          myodbc_d2str               (double value, char *buff,
+                                            my_bool exact_numeric);
 char *          extend_buffer       (NET *net, char *to, ulong length);
 char *          add_to_buffer       (NET *net,char *to,const char *from,ulong length);
+NET *           stmt_query_net      (STMT *stmt);
 MY_LIMIT_CLAUSE find_position4limit (CHARSET_INFO* cs, char *query,
                                     char * query_end);
 BOOL            myodbc_isspace      (CHARSET_INFO* cs, const char * begin, const char *end);
@@ -368,6 +393,14 @@ int           got_out_parameters  (STMT *stmt);
 const char    get_identifier_quote(STMT *stmt);
 SQLULEN get_query_timeout(STMT *stmt);
 SQLRETURN set_query_timeout(STMT *stmt, SQLULEN new_value);
+SQLRETURN set_max_execution_time(DBC *dbc, SQLULEN timeout, my_bool req_lock);
+
+/* Limits put into the query by add_limit_hints() */
+#define HINT_SELECT_LIMIT   1
+#define HINT_EXECUTION_TIME 2
+
+char *    add_limit_hints(STMT *stmt, const char *query, SQLULEN *query_length,
+                          uint *hinted);
 int get_session_variable(STMT *stmt, const char *var, char *result);
 
 /* handle.c*/
@@ -378,19 +411,27 @@ int           reset_connection        (DBC *dbc);
 /* Actions taken when connection is taken from the pool */
 int           wakeup_connection       (DBC *dbc);
 #define WAKEUP_CONN_IF_NEEDED(dbc) if (dbc->need_to_wakeup && wakeup_connection(dbc)) return SQL_ERROR
+void          handle_mem_init         (void);
+void          handle_mem_end          (void);
+void *        handle_mem_alloc        (SQLSMALLINT type);
+void          handle_mem_free         (SQLSMALLINT type, void *mem);
 
 /*results.c*/
 long long     binary2numeric        (long long *dst, char *src, uint srcLen);
 void          fill_ird_data_lengths (DESC *ird, ulong *lengths, uint fields);
+void          free_rowset           (STMT *stmt);
+void          invalidate_conversion_plan(STMT *stmt);
+MY_COLUMN_PLAN *get_column_plan     (STMT *stmt, uint column);
+my_bool       bind_conversion_plan  (STMT *stmt);
 
 /* Functions to work with prepared and regular statements  */
 
 #ifdef SERVER_PS_OUT_PARAMS
-# define IS_PS_OUT_PARAMS(_stmt) ((_stmt)->dbc->mysql.server_status & SERVER_PS_OUT_PARAMS)
+# define IS_PS_OUT_PARAMS(_stmt) ((_stmt)->dbc->mysql->server_status & SERVER_PS_OUT_PARAMS)
 #else
 /* In case if driver is built against old libmysl. In fact is not quite
    correct */
-# define IS_PS_OUT_PARAMS(_stmt) (ssps_used(_stmt) && is_call_procedure(&_stmt->query) && !mysql_more_results(&(_stmt)->dbc->mysql))
+# define IS_PS_OUT_PARAMS(_stmt) (ssps_used(_stmt) && is_call_procedure(&_stmt->query) && !mysql_more_results((_stmt)->dbc->mysql))
 #endif
 
 /* my_stmt.c */
@@ -409,6 +450,8 @@ unsigned long*    fetch_lengths       (STMT *stmt);
 MYSQL_ROW_OFFSET  row_seek            (STMT *stmt, MYSQL_ROW_OFFSET offset);
 void              data_seek           (STMT *stmt, my_ulonglong offset);
 MYSQL_ROW_OFFSET  row_tell            (STMT *stmt);
+MYSQL_ROWS *      stored_row          (STMT *stmt, my_ulonglong row_num);
+void              invalidate_row_index(STMT *stmt);
 int               next_result         (STMT *stmt);
 SQLRETURN         send_long_data      (STMT *stmt, unsigned int param_num, DESCREC * aprec,
                                       const char *chunk, unsigned long length);
@@ -434,6 +477,8 @@ void          scroller_create     (STMT * stmt, char *query, SQLULEN len);
 unsigned long long  scroller_move (STMT * stmt);
 
 SQLRETURN     scroller_prefetch   (STMT * stmt);
+void          scroller_keyset_init(STMT * stmt);
+void          scroller_read_ahead (STMT * stmt);
 BOOL          scrollable          (STMT * stmt, char * query, char * query_end);
 
 /* my_prepared_stmt.c */
@@ -441,9 +486,13 @@ void        ssps_init             (STMT *stmt);
 BOOL        ssps_get_out_params   (STMT *stmt);
 int         ssps_get_result       (STMT *stmt);
 void        ssps_close            (STMT *stmt);
+BOOL        ssps_cache_take       (STMT *stmt, const char *query,
+                                  size_t query_length);
+void        ssps_cache_free       (DBC *dbc);
 SQLRETURN   ssps_fetch_chunk      (STMT *stmt, char *dest, unsigned long dest_bytes,
                                   unsigned long *avail_bytes);
 int         ssps_bind_result      (STMT *stmt);
+void        ssps_bind_direct      (STMT *stmt, uint rownum);
 void        free_result_bind      (STMT *stmt);
 BOOL        ssps_0buffers_truncated_only(STMT *stmt);
 long long   ssps_get_int64        (STMT *stmt, ulong column_number, char *value,
@@ -452,12 +501,58 @@ long double ssps_get_double       (STMT *stmt, ulong column_number, char *value,
                                   ulong length);
 char *      ssps_get_string       (STMT *stmt, ulong column_number, char *value,
                                   ulong *length, char * buffer);
+int         ssps_get_timestamp    (STMT *stmt, ulong column_number,
+                                  SQL_TIMESTAMP_STRUCT *ts, int zeroToMin);
 SQLRETURN   ssps_send_long_data   (STMT *stmt, unsigned int param_num, const char *chunk,
                                   unsigned long length);
 MYSQL_BIND * get_param_bind       (STMT *stmt, unsigned int param_number, int reset);
 
+/* readahead.c */
+BOOL            readahead_wanted  (STMT *stmt);
+MYSQL_ROW       readahead_fetch   (STMT *stmt);
+unsigned long * readahead_lengths (STMT *stmt);
+void            readahead_pause   (DBC *dbc);
+MYSQL *         readahead_yield   (DBC *dbc);
+void            readahead_free    (STMT *stmt);
+void            page_ahead_start  (STMT *stmt, char *query,
+                                   unsigned long query_len,
+                                   unsigned long long offset);
+MYSQL_RES *     page_ahead_take   (STMT *stmt, unsigned long long offset);
+void            page_ahead_free   (STMT *stmt);
+
+/* async.c */
+#define ASYNC_CANCEL_NONE 0 /* no asynchronous call */
+#define ASYNC_CANCEL_DONE 1 /* call canceled or finished already */
+#define ASYNC_CANCEL_KILL 2 /* call running, its query is to be killed */
+
+void async_init       (void);
+void async_end        (void);
+BOOL async_requested  (STMT *stmt);
+BOOL async_call       (STMT *stmt, MY_ASYNC_RUN run, const void *args,
+                       size_t args_length, SQLRETURN *rc);
+int  async_cancel     (STMT *stmt);
+void async_wait       (STMT *stmt);
+
+/* pool.c */
+void       pool_init      (void);
+void       pool_end       (void);
+SQLWCHAR * pool_key       (DataSource *ds, size_t *key_len);
+BOOL       pool_checkout  (DBC *dbc, DataSource *ds);
+BOOL       pool_checkin   (DBC *dbc);
+
+/* cancel.c */
+void cancel_init        (void);
+void cancel_end         (void);
+BOOL kill_query         (DBC *dbc, unsigned long thread_id);
+void query_timer_start  (MY_QUERY_TIMER *timer, DBC *dbc, SQLULEN timeout);
+BOOL query_timer_stop   (MY_QUERY_TIMER *timer);
+
 /* connect.c */
 void free_connection_stmts(DBC *dbc);
+void myodbc_set_connect_options(DBC *dbc, MYSQL *mysql, DataSource *ds);
+BOOL myodbc_reconnect(DBC *dbc);
+void ds_cache_init(void);
+void ds_cache_end(void);
 
 #ifdef __WIN__
 #define cmp_database(A,B) myodbc_strcasecmp((const char *)(A),(const char *)(B))
@@ -516,6 +611,11 @@ void free_connection_stmts(DBC *dbc);
 
 #define CHECK_HANDLE(h) if (h == NULL) return SQL_INVALID_HANDLE
 
+/* Until the function a statement executes asynchronously returns the result
+   of the call, the statement can't be used by other functions */
+#define CHECK_ASYNC(S) if ((S)->async.run != NULL) \
+                         return set_error(S, MYERR_S1010, NULL, 0)
+
 #define CHECK_DATA_POINTER(S, D, C) if (D == NULL && C != 0 && C != SQL_DEFAULT_PARAM && C != SQL_NULL_DATA) \
                                    return set_stmt_error(S, "HY009", "Invalid use of NULL pointer", 0);
 
@@ -44,9 +44,13 @@ static SQLRETURN set_constmt_attr(SQLSMALLINT  HandleType,
     switch (Attribute)
     {
         case SQL_ATTR_ASYNC_ENABLE:
+#ifdef THREAD
+            options->async_enable= (SQLUINTEGER)(SQLULEN)ValuePtr;
+#else
             if (ValuePtr == (SQLPOINTER) SQL_ASYNC_ENABLE_ON)
                 return set_handle_error(HandleType,Handle,MYERR_01S02,
                                         "Doesn't support asynchronous, changed to default",0);
+#endif
             break;
 
         case SQL_ATTR_CURSOR_SENSITIVITY:
@@ -141,7 +145,13 @@ static SQLRETURN set_constmt_attr(SQLSMALLINT  HandleType,
             break;
 
         case SQL_ATTR_KEYSET_SIZE:
+            options->keyset_size= (SQLULEN) ValuePtr;
+            break;
+
         case SQL_ATTR_CONCURRENCY:
+            options->concurrency= (SQLUINTEGER)(SQLULEN)ValuePtr;
+            break;
+
         case SQL_ATTR_NOSCAN:
         default:
             /* ignored */
@@ -167,7 +177,7 @@ get_constmt_attr(SQLSMALLINT  HandleType,
     switch (Attribute)
     {
         case SQL_ATTR_ASYNC_ENABLE:
-            *((SQLUINTEGER *) ValuePtr)= SQL_ASYNC_ENABLE_OFF;
+            *((SQLUINTEGER *) ValuePtr)= options->async_enable;
             break;
 
         case SQL_ATTR_CURSOR_SENSITIVITY:
@@ -212,11 +222,11 @@ get_constmt_attr(SQLSMALLINT  HandleType,
             break;
 
         case SQL_ATTR_CONCURRENCY:
-            *((SQLUINTEGER *) ValuePtr)= SQL_CONCUR_READ_ONLY;
+            *((SQLUINTEGER *) ValuePtr)= options->concurrency;
             break;
 
         case SQL_KEYSET_SIZE:
-            *((SQLUINTEGER *) ValuePtr)= 0L;
+            *((SQLULEN *) ValuePtr)= options->keyset_size;
             break;
 
         case SQL_NOSCAN:
@@ -335,16 +345,21 @@ MySQLSetConnectAttr(SQLHDBC hdbc, SQLINTEGER Attribute,
         myodbc_mutex_lock(&dbc->lock);
         if (is_connected(dbc))
         {
-          if (mysql_select_db(&dbc->mysql,(char*) db))
+          if (mysql_select_db(readahead_yield(dbc), (char*) db))
           {
-            set_conn_error(dbc,MYERR_S1000,mysql_error(&dbc->mysql),mysql_errno(&dbc->mysql));
+            set_conn_error(dbc,MYERR_S1000,mysql_error(dbc->mysql),mysql_errno(dbc->mysql));
             myodbc_mutex_unlock(&dbc->lock);
             return SQL_ERROR;
           }
         }
+        myodbc_mutex_lock(&dbc->session_lock);
         x_free(dbc->database);
         dbc->database= myodbc_strdup(db,MYF(MY_WME));
+        myodbc_mutex_unlock(&dbc->session_lock);
         myodbc_mutex_unlock(&dbc->lock);
+
+        /* Cached statements may refer to tables of the previous database */
+        ssps_cache_free(dbc);
       }
       break;
 
@@ -482,13 +497,15 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
 
   case SQL_ATTR_CONNECTION_DEAD:
     /* If waking up fails - we return "connection is dead", no matter what really the reason is */
+    myodbc_mutex_lock(&dbc->lock);
     if (dbc->need_to_wakeup != 0 && wakeup_connection(dbc)
-      || dbc->need_to_wakeup == 0 && mysql_ping(&dbc->mysql) &&
-        (mysql_errno(&dbc->mysql) == CR_SERVER_LOST ||
-         mysql_errno(&dbc->mysql) == CR_SERVER_GONE_ERROR))
+      || dbc->need_to_wakeup == 0 && mysql_ping(readahead_yield(dbc)) &&
+        (mysql_errno(dbc->mysql) == CR_SERVER_LOST ||
+         mysql_errno(dbc->mysql) == CR_SERVER_GONE_ERROR))
       *((SQLUINTEGER *)num_attr)= SQL_CD_TRUE;
     else
       *((SQLUINTEGER *)num_attr)= SQL_CD_FALSE;
+    myodbc_mutex_unlock(&dbc->lock);
     break;
 
   case SQL_ATTR_CONNECTION_TIMEOUT:
@@ -504,7 +521,8 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
     }
     else if (is_connected(dbc))
     {
-      *char_attr= (SQLCHAR *)(dbc->database ? dbc->database : "null");
+      *char_attr= (SQLCHAR *)current_catalog_copy(dbc, dbc->database_copy,
+                                                  "null");
     }
     else
     {
@@ -526,7 +544,7 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
     break;
 
   case SQL_ATTR_PACKET_SIZE:
-    *((SQLUINTEGER *)num_attr)= dbc->mysql.net.max_packet;
+    *((SQLUINTEGER *)num_attr)= dbc->mysql->net.max_packet;
     break;
 
   case SQL_ATTR_TXN_ISOLATION:
@@ -556,7 +574,7 @@ MySQLGetConnectAttr(SQLHDBC hdbc, SQLINTEGER attrib, SQLCHAR **char_attr,
         MYSQL_RES *res;
         MYSQL_ROW  row;
 
-        if ((res= mysql_store_result(&dbc->mysql)) &&
+        if ((res= mysql_store_result(dbc->mysql)) &&
             (row= mysql_fetch_row(res)))
         {
           if (strncmp(row[0], "READ-UNCOMMITTED", 16) == 0) {
@@ -600,6 +618,7 @@ MySQLSetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
     SQLRETURN result= SQL_SUCCESS;
     STMT_OPTIONS *options= &stmt->stmt_options;
 
+    CHECK_ASYNC(stmt);
     CLEAR_STMT_ERROR(stmt);
 
     switch (Attribute)
@@ -770,6 +789,17 @@ MySQLSetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
             options->simulateCursor= (SQLUINTEGER)(SQLULEN)ValuePtr;
             break;
 
+#ifdef SQL_ATTR_ASYNC_STMT_PCALLBACK
+        /* Set by the driver manager for the notification of completion */
+        case SQL_ATTR_ASYNC_STMT_PCALLBACK:
+            stmt->async.callback= ValuePtr;
+            break;
+
+        case SQL_ATTR_ASYNC_STMT_PCONTEXT:
+            stmt->async.context= ValuePtr;
+            break;
+#endif
+
             /*
               3.x driver doesn't support any statement attributes
               at connection level, but to make sure all 2.x apps
@@ -799,6 +829,8 @@ MySQLGetStmtAttr(SQLHSTMT hstmt, SQLINTEGER Attribute, SQLPOINTER ValuePtr,
     SQLINTEGER vparam= 0;
     SQLINTEGER len;
 
+    CHECK_ASYNC(stmt);
+
     if (!ValuePtr)
         ValuePtr= &vparam;
 
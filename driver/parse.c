@@ -68,6 +68,11 @@ static const MY_STRING current=    {"CURRENT"  , 7, 7};
 static const MY_STRING of=         {"OF"       , 2, 2};
 static const MY_STRING limit=      {"LIMIT"    , 5, 5};
 static const MY_STRING optimize=   {"OPTIMIZE" , 8, 8};
+static const MY_STRING values=     {"VALUES"   , 6, 6};
+static const MY_STRING value=      {"VALUE"    , 5, 5};
+static const MY_STRING alter=      {"ALTER"    , 5, 5};
+static const MY_STRING rename_=    {"RENAME"   , 6, 6};
+static const MY_STRING truncate_=  {"TRUNCATE" , 8, 8};
 
 static const MY_SYNTAX_MARKERS ansi_syntax_markers= {/*quote*/
                                               {
@@ -237,6 +242,69 @@ int copy_parsed_query(MY_PARSED_QUERY* src, MY_PARSED_QUERY *target)
 }
 
 
+MY_QUERY_TEMPLATE * init_query_template(MY_QUERY_TEMPLATE *tpl)
+{
+  if (tpl != NULL)
+  {
+    tpl->query=          NULL;
+    tpl->literal_length= 0;
+
+    myodbc_init_dynamic_array(&tpl->slice, sizeof(MY_QUERY_SLICE), 10, 10);
+  }
+
+  return tpl;
+}
+
+
+/* Cuts the parsed query into literal slices around its parameter markers.
+   Returns TRUE on memory allocation error, leaving the template unusable */
+BOOL build_query_template(MY_QUERY_TEMPLATE *tpl, MY_PARSED_QUERY *pq)
+{
+  MY_QUERY_SLICE slice;
+  char *from= GET_QUERY(pq), *to;
+  uint i;
+
+  RESET_TEMPLATE(tpl);
+  reset_dynamic(&tpl->slice);
+  tpl->literal_length= 0;
+
+  if (from == NULL)
+  {
+    return FALSE;
+  }
+
+  for (i= 0; i <= PARAM_COUNT(pq); ++i)
+  {
+    to= i < PARAM_COUNT(pq) ? get_param_pos(pq, i) : GET_QUERY_END(pq);
+
+    slice.offset= (uint)(from - GET_QUERY(pq));
+    slice.length= (uint)(to - from);
+
+    if (push_dynamic(&tpl->slice, (uchar *)&slice))
+    {
+      return TRUE;
+    }
+
+    tpl->literal_length+= slice.length;
+    from= to + 1;  /* Skip '?' */
+  }
+
+  tpl->query= GET_QUERY(pq);
+
+  return FALSE;
+}
+
+
+void delete_query_template(MY_QUERY_TEMPLATE *tpl)
+{
+  if (tpl)
+  {
+    RESET_TEMPLATE(tpl);
+    delete_dynamic(&tpl->slice);
+  }
+}
+
+
 MY_PARSER * init_parser(MY_PARSER * parser, MY_PARSED_QUERY *pq)
 {
   parser->query=  pq;
@@ -538,6 +606,150 @@ BOOL stmt_returns_result(const MY_PARSED_QUERY *query)
 }
 
 
+/* Returns TRUE if the statement may change tables or the default database,
+   i.e. what prepared statements have been prepared against */
+BOOL changes_schema(MY_PARSED_QUERY *pq)
+{
+  char *first;
+
+  if (IS_BATCH(pq))
+  {
+    return TRUE;
+  }
+
+  if (TOKEN_COUNT(pq) == 0)
+  {
+    return FALSE;
+  }
+
+  first= get_token(pq, 0);
+
+  return pq->query_type == myqtUse
+      || case_compare(pq, first, &create)
+      || case_compare(pq, first, &alter)
+      || case_compare(pq, first, &drop)
+      || case_compare(pq, first, &rename_)
+      || case_compare(pq, first, &truncate_);
+}
+
+
+/* Installs position next after the parenthesis closing the one at the
+   current position. Returns FALSE if it is not closed */
+static BOOL skip_parenthesized(MY_PARSER *parser)
+{
+  int depth= 0;
+
+  while (END_NOT_REACHED(parser))
+  {
+    if (open_quote(parser, is_quote(parser)))
+    {
+      step_char(parser);
+      find_closing_quote(parser);
+      CLOSE_QUOTE(parser);
+      continue;
+    }
+
+    if (*parser->pos == '(')
+    {
+      ++depth;
+    }
+    else if (*parser->pos == ')' && --depth == 0)
+    {
+      step_char(parser);
+      return TRUE;
+    }
+
+    step_char(parser);
+  }
+
+  return FALSE;
+}
+
+
+/**
+  Find the VALUES list of an INSERT, from the opening parenthesis of its
+  first row to the closing one of the last row. Such list can be repeated
+  to insert more rows with one query only if all parameter markers of the
+  query are inside it.
+
+  @param[in]  pq      Parsed query
+  @param[out] begin   Beginning of the list
+  @param[out] end     The character next after the list
+
+  @return TRUE if the query has such list
+*/
+BOOL find_insert_values(MY_PARSED_QUERY *pq, char **begin, char **end)
+{
+  MY_PARSER parser;
+  uint      i, j;
+
+  if (pq->query_type != myqtInsert || IS_BATCH(pq) || PARAM_COUNT(pq) == 0)
+  {
+    return FALSE;
+  }
+
+  for (i= 1; i < TOKEN_COUNT(pq); ++i)
+  {
+    char *token= get_token(pq, i);
+    const MY_STRING *keyword= case_compare(pq, token, &values) ? &values :
+                              case_compare(pq, token, &value)  ? &value :
+                                                                 NULL;
+    if (keyword == NULL)
+    {
+      continue;
+    }
+
+    init_parser(&parser, pq);
+    parser.pos= token + keyword->bytes;
+    get_ctype(&parser);
+
+    if (skip_spaces(&parser) || *parser.pos != '(')
+    {
+      continue;
+    }
+
+    *begin= parser.pos;
+
+    /* The list can have more than one row already */
+    do
+    {
+      if (!skip_parenthesized(&parser))
+      {
+        return FALSE;
+      }
+
+      *end= parser.pos;
+
+      if (skip_spaces(&parser) || *parser.pos != ',')
+      {
+        break;
+      }
+
+      step_char(&parser);
+
+      if (skip_spaces(&parser) || *parser.pos != '(')
+      {
+        return FALSE;
+      }
+    } while (TRUE);
+
+    for (j= 0; j < PARAM_COUNT(pq); ++j)
+    {
+      char *pos= get_param_pos(pq, j);
+
+      if (pos < *begin || pos >= *end)
+      {
+        return FALSE;
+      }
+    }
+
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
 /* TRUE if end has been reached */
 BOOL skip_spaces(MY_PARSER *parser)
 {
@@ -128,6 +128,23 @@ typedef struct parsed_query
 } MY_PARSED_QUERY;
 
 
+/* Part of the query between parameter markers, relative to the query */
+typedef struct query_slice
+{
+  uint offset;
+  uint length;
+} MY_QUERY_SLICE;
+
+/* Parsed query compiled for repeated building with parameter values: the
+   literal slices only have to be copied, with values put in between */
+typedef struct query_template
+{
+  const char    *query;         /* query the slices were cut from, or NULL */
+  DYNAMIC_ARRAY slice;          /* param count + 1 of MY_QUERY_SLICE       */
+  ulong         literal_length; /* total length of the slices              */
+} MY_QUERY_TEMPLATE;
+
+
 typedef struct parser
 {
   char              *pos;
@@ -157,6 +174,17 @@ int               copy_parsed_query(MY_PARSED_QUERY *src,
 #define PARAM_COUNT(pq) (pq)->param_pos.elements
 #define IS_BATCH(pq) ((pq)->is_batch != NULL)
 
+MY_QUERY_TEMPLATE * init_query_template(MY_QUERY_TEMPLATE *tpl);
+BOOL                build_query_template(MY_QUERY_TEMPLATE *tpl,
+                                         MY_PARSED_QUERY *pq);
+void                delete_query_template(MY_QUERY_TEMPLATE *tpl);
+
+/* Template is usable if it was built for the query being executed */
+#define TEMPLATE_IS_FOR(tpl, pq) ((tpl)->query != NULL &&\
+                                  (tpl)->query == GET_QUERY(pq))
+#define RESET_TEMPLATE(tpl) (tpl)->query= NULL
+#define TEMPLATE_SLICE(tpl, index) (((MY_QUERY_SLICE *)(tpl)->slice.buffer) + (index))
+
 char * get_token(MY_PARSED_QUERY *pq, uint index);
 char * get_param_pos(MY_PARSED_QUERY *pq, uint index);
 
@@ -216,6 +244,9 @@ BOOL        is_create_function      (const SQLCHAR * query);
 BOOL        is_use_db               (const SQLCHAR * query);
 BOOL        is_call_procedure       (const MY_PARSED_QUERY *query);
 BOOL        stmt_returns_result     (const MY_PARSED_QUERY *query);
+BOOL        changes_schema          (MY_PARSED_QUERY *pq);
+BOOL        find_insert_values      (MY_PARSED_QUERY *pq, char **begin,
+                                     char **end);
 
 BOOL        remove_braces           (MY_PARSER *query);
 
@@ -0,0 +1,542 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  pool.c
+  @brief Driver-side pool of open connections.
+
+  With POOL_MAX_IDLE set, SQLDisconnect() resets the session and keeps the
+  connection open instead of closing it, and the next connect with the same
+  data source takes it instead of doing the whole handshake again.
+  Connections are pooled by the serialized data source, so everything that
+  affects the connection, credentials included, has to match.
+
+  The reset is COM_RESET_CONNECTION where the client library has it, and
+  mysql_change_user() with the same credentials otherwise. The settings the
+  driver makes after connecting are made again by myodbc_do_connect(), as
+  for a new connection.
+
+  A background thread pings connections that have been idle for
+  POOL_PING_INTERVAL seconds, and closes those idle for POOL_IDLE_TIMEOUT
+  seconds, except for the POOL_MIN_IDLE most recently used of each pool.
+*/
+
+#include "driver.h"
+
+
+typedef struct pool_conn
+{
+  MYSQL             *mysql;       /* allocated as DBC.mysql is */
+  time_t            idle_since;   /* when it was put to the pool */
+  time_t            checked;      /* when it was last seen alive */
+  struct pool       *pool;
+  struct pool_conn  *next;
+} MY_POOL_CONN;
+
+typedef struct pool
+{
+  SQLWCHAR          *key;         /* serialized data source */
+  size_t            key_len;
+  my_bool           unicode;
+  MY_POOL_CONN      *idle;        /* most recently used first */
+  uint              idle_count;
+  uint              max_idle, min_idle, idle_timeout, ping_interval;
+  struct pool       *next;
+} MY_POOL;
+
+
+static MY_POOL         *pools= NULL;
+static myodbc_mutex_t   pool_lock;
+
+#ifdef THREAD
+static myodbc_cond_t    pool_wakeup;
+static my_thread_handle pool_thread;
+static my_bool          pool_thread_running= FALSE;
+static my_bool          pool_stop= FALSE;
+#endif
+
+
+/* Serializes the data source to the key of its pool */
+SQLWCHAR * pool_key(DataSource *ds, size_t *key_len)
+{
+  size_t    len= ds_to_kvpair_len(ds) + 1;
+  SQLWCHAR  *key= (SQLWCHAR *)myodbc_malloc(len * sizeof(SQLWCHAR), MYF(0));
+
+  if (key == NULL)
+  {
+    return NULL;
+  }
+
+  if (ds_to_kvpair(ds, key, len, ';') == -1)
+  {
+    x_free(key);
+    return NULL;
+  }
+
+  *key_len= sqlwcharlen(key);
+  return key;
+}
+
+
+/* Finds the pool of the key, creating it if asked to. Called under lock */
+static MY_POOL * find_pool(SQLWCHAR *key, size_t key_len, my_bool unicode,
+                           DataSource *ds, my_bool create)
+{
+  MY_POOL *pool;
+
+  for (pool= pools; pool; pool= pool->next)
+  {
+    if (pool->unicode == unicode && pool->key_len == key_len &&
+        !memcmp(pool->key, key, key_len * sizeof(SQLWCHAR)))
+    {
+      return pool;
+    }
+  }
+
+  if (!create ||
+      !(pool= (MY_POOL *)myodbc_malloc(sizeof(MY_POOL), MYF(MY_ZEROFILL))))
+  {
+    return NULL;
+  }
+
+  if (!(pool->key= (SQLWCHAR *)myodbc_memdup((char *)key,
+                                             (key_len + 1) * sizeof(SQLWCHAR),
+                                             MYF(0))))
+  {
+    x_free(pool);
+    return NULL;
+  }
+
+  pool->key_len=       key_len;
+  pool->unicode=       unicode;
+  pool->max_idle=      ds->pool_max_idle;
+  pool->min_idle=      ds->pool_min_idle;
+  pool->idle_timeout=  ds->pool_idle_timeout;
+  pool->ping_interval= ds->pool_ping_interval;
+  pool->next=          pools;
+  pools= pool;
+
+  return pool;
+}
+
+
+static void close_pool_conn(MY_POOL_CONN *conn)
+{
+  mysql_close(conn->mysql);
+  x_free(conn->mysql);
+  x_free(conn);
+}
+
+
+/* Puts the connection back keeping the list ordered. Called under lock */
+static void return_pool_conn(MY_POOL_CONN *conn)
+{
+  MY_POOL       *pool= conn->pool;
+  MY_POOL_CONN  **pos= &pool->idle;
+
+  while (*pos && (*pos)->idle_since >= conn->idle_since)
+  {
+    pos= &(*pos)->next;
+  }
+
+  conn->next= *pos;
+  *pos= conn;
+  ++pool->idle_count;
+}
+
+
+#ifdef THREAD
+
+/* Body of the thread pinging and evicting idle connections */
+static void * maintain_pools(void *arg)
+{
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&pool_lock);
+
+  while (!pool_stop)
+  {
+    MY_POOL       *pool;
+    MY_POOL_CONN  *to_ping= NULL, *to_close= NULL, *alive= NULL, *conn, *next;
+    time_t        now= time(NULL);
+
+    /* Take the connections out, so that nobody uses them meanwhile */
+    for (pool= pools; pool; pool= pool->next)
+    {
+      MY_POOL_CONN **pos= &pool->idle;
+      uint         kept= 0;
+
+      while ((conn= *pos))
+      {
+        if (pool->idle_timeout && kept >= pool->min_idle &&
+            now - conn->idle_since >= (time_t)pool->idle_timeout)
+        {
+          *pos= conn->next;
+          conn->next= to_close;
+          to_close= conn;
+          --pool->idle_count;
+        }
+        else if (pool->ping_interval &&
+                 now - conn->checked >= (time_t)pool->ping_interval)
+        {
+          *pos= conn->next;
+          conn->next= to_ping;
+          to_ping= conn;
+          --pool->idle_count;
+          ++kept;
+        }
+        else
+        {
+          pos= &conn->next;
+          ++kept;
+        }
+      }
+    }
+
+    if (to_ping || to_close)
+    {
+      myodbc_mutex_unlock(&pool_lock);
+
+      for (conn= to_close; conn; conn= next)
+      {
+        next= conn->next;
+        close_pool_conn(conn);
+      }
+
+      to_close= NULL;
+      for (conn= to_ping; conn; conn= next)
+      {
+        next= conn->next;
+
+        if (mysql_ping(conn->mysql))
+        {
+          close_pool_conn(conn);
+        }
+        else
+        {
+          conn->checked= time(NULL);
+          conn->next= alive;
+          alive= conn;
+        }
+      }
+
+      myodbc_mutex_lock(&pool_lock);
+
+      /* Connections put to the pool meanwhile may have filled it up */
+      for (conn= alive; conn; conn= next)
+      {
+        next= conn->next;
+
+        if (conn->pool->idle_count < conn->pool->max_idle)
+        {
+          return_pool_conn(conn);
+        }
+        else
+        {
+          conn->next= to_close;
+          to_close= conn;
+        }
+      }
+
+      if (to_close)
+      {
+        myodbc_mutex_unlock(&pool_lock);
+
+        for (conn= to_close; conn; conn= next)
+        {
+          next= conn->next;
+          close_pool_conn(conn);
+        }
+
+        myodbc_mutex_lock(&pool_lock);
+      }
+    }
+
+    if (!pool_stop)
+    {
+      myodbc_cond_timedwait(&pool_wakeup, &pool_lock, 1000);
+    }
+  }
+
+  myodbc_mutex_unlock(&pool_lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+#endif /* THREAD */
+
+
+void pool_init(void)
+{
+  myodbc_mutex_init(&pool_lock, NULL);
+#ifdef THREAD
+  myodbc_cond_init(&pool_wakeup);
+  pool_stop= FALSE;
+#endif
+}
+
+
+/*
+  Closes all idle connections. Connections in use are closed by
+  SQLDisconnect() as usual, since their pools are gone.
+*/
+void pool_end(void)
+{
+  MY_POOL *pool, *next_pool;
+
+#ifdef THREAD
+  myodbc_mutex_lock(&pool_lock);
+  pool_stop= TRUE;
+  myodbc_cond_broadcast(&pool_wakeup);
+  myodbc_mutex_unlock(&pool_lock);
+
+# ifdef _WIN32
+  /*
+    This is called from DllMain(), where the thread can not be waited for.
+    It exits on its own, and the connections go with the process.
+  */
+  if (pool_thread_running)
+  {
+    return;
+  }
+# else
+  if (pool_thread_running)
+  {
+    my_thread_join(&pool_thread, NULL);
+    pool_thread_running= FALSE;
+  }
+# endif
+#endif
+
+  for (pool= pools; pool; pool= next_pool)
+  {
+    MY_POOL_CONN *conn, *next;
+
+    next_pool= pool->next;
+
+    for (conn= pool->idle; conn; conn= next)
+    {
+      next= conn->next;
+      close_pool_conn(conn);
+    }
+
+    x_free(pool->key);
+    x_free(pool);
+  }
+  pools= NULL;
+
+#ifdef THREAD
+  myodbc_cond_destroy(&pool_wakeup);
+#endif
+  myodbc_mutex_destroy(&pool_lock);
+}
+
+
+/*
+  Takes an idle connection for the data source from the pool into
+  dbc->mysql, replacing the handle initialized there, which is not connected
+  yet. Returns FALSE if there is none, and dbc->mysql is left as it was.
+*/
+BOOL pool_checkout(DBC *dbc, DataSource *ds)
+{
+  MY_POOL       *pool;
+  MY_POOL_CONN  *conn;
+  SQLWCHAR      *key;
+  size_t        key_len;
+  BOOL          found= FALSE;
+
+  if (!ds->pool_max_idle || !(key= pool_key(ds, &key_len)))
+  {
+    return FALSE;
+  }
+
+  while (TRUE)
+  {
+    conn= NULL;
+
+    myodbc_mutex_lock(&pool_lock);
+    if ((pool= find_pool(key, key_len, dbc->unicode, ds, FALSE)) &&
+        (conn= pool->idle))
+    {
+      pool->idle= conn->next;
+      --pool->idle_count;
+    }
+    myodbc_mutex_unlock(&pool_lock);
+
+    if (conn == NULL)
+    {
+      break;
+    }
+
+    /* Not checked for too long, which is the case without the thread */
+    if (pool->ping_interval &&
+        time(NULL) - conn->checked >= (time_t)pool->ping_interval &&
+        mysql_ping(conn->mysql))
+    {
+      close_pool_conn(conn);
+      continue;
+    }
+
+    /* Handles are swapped, a MYSQL may point to itself and is never copied */
+    mysql_close(dbc->mysql);
+    x_free(dbc->mysql);
+    dbc->mysql= conn->mysql;
+    x_free(conn);
+    found= TRUE;
+    break;
+  }
+
+  x_free(key);
+  return found;
+}
+
+
+/*
+  Resets the session of the connection to the state it had after connect.
+  Returns FALSE if that fails. Called under dbc->lock.
+*/
+static BOOL reset_pool_conn(DBC *dbc)
+{
+  DataSource    *ds= dbc->ds;
+  const char    *database;
+
+  readahead_pause(dbc);
+
+#if MYSQL_VERSION_ID >= 50703
+  if (mysql_reset_connection(dbc->mysql))
+#else
+  if (wakeup_connection(dbc))
+#endif
+  {
+    return FALSE;
+  }
+
+  /* The reset keeps the current database, so it has to be the initial one */
+  database= ds_get_utf8attr(ds->database, &ds->database8);
+  if (database && *database)
+  {
+    if ((!dbc->mysql->db || strcmp(dbc->mysql->db, database)) &&
+        mysql_select_db(dbc->mysql, database))
+    {
+      return FALSE;
+    }
+  }
+  else if (dbc->mysql->db)
+  {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/*
+  Resets the session of the connection and puts it to the pool. Returns
+  FALSE if the connection can not be pooled and has to be closed. All
+  statements of the connection have to be freed already.
+*/
+BOOL pool_checkin(DBC *dbc)
+{
+  DataSource    *ds= dbc->ds;
+  MY_POOL       *pool;
+  MY_POOL_CONN  *conn;
+  SQLWCHAR      *key;
+  size_t        key_len;
+  BOOL          reset;
+
+  if (ds == NULL || !ds->pool_max_idle)
+  {
+    return FALSE;
+  }
+
+  myodbc_mutex_lock(&dbc->lock);
+  reset= reset_pool_conn(dbc);
+  myodbc_mutex_unlock(&dbc->lock);
+
+  if (!reset)
+  {
+    return FALSE;
+  }
+
+  if (!(key= pool_key(ds, &key_len)))
+  {
+    return FALSE;
+  }
+
+  if (!(conn= (MY_POOL_CONN *)myodbc_malloc(sizeof(MY_POOL_CONN), MYF(0))))
+  {
+    x_free(key);
+    return FALSE;
+  }
+
+  /* The handle left to the DBC, for it to be connected again */
+  if (!(conn->mysql= (MYSQL *)myodbc_malloc(sizeof(MYSQL), MYF(MY_ZEROFILL))))
+  {
+    x_free(conn);
+    x_free(key);
+    return FALSE;
+  }
+
+  myodbc_mutex_lock(&pool_lock);
+
+  if (!(pool= find_pool(key, key_len, dbc->unicode, ds, TRUE)) ||
+      pool->idle_count >= pool->max_idle)
+  {
+    myodbc_mutex_unlock(&pool_lock);
+    x_free(conn->mysql);
+    x_free(conn);
+    x_free(key);
+    return FALSE;
+  }
+
+  /* The connection belongs to the pool now, the DBC gets the spare handle */
+  {
+    MYSQL *spare= conn->mysql;
+
+    conn->mysql= dbc->mysql;
+    dbc->mysql= spare;
+  }
+  conn->idle_since= conn->checked= time(NULL);
+  conn->pool= pool;
+  conn->next= pool->idle;
+  pool->idle= conn;
+  ++pool->idle_count;
+
+#ifdef THREAD
+  if (!pool_thread_running && !pool_stop &&
+      (pool->ping_interval || pool->idle_timeout))
+  {
+    pool_thread_running= !my_thread_create(&pool_thread, NULL,
+                                           maintain_pools, NULL);
+  }
+#endif
+
+  myodbc_mutex_unlock(&pool_lock);
+
+  x_free(key);
+
+  return TRUE;
+}
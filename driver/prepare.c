@@ -273,6 +273,7 @@ SQLRETURN SQL_API SQLSetParam(SQLHSTMT        hstmt,
                               SQLLEN *        pcbValue)
 {
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC((STMT *)hstmt);
 
   return my_SQLBindParameter(hstmt, ipar, SQL_PARAM_INPUT_OUTPUT, fCType, 
                              fSqlType, cbColDef, ibScale, rgbValue, 
@@ -297,6 +298,7 @@ SQLRETURN SQL_API SQLBindParameter( SQLHSTMT        hstmt,
                                     SQLLEN *        pcbValue )
 {
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC((STMT *)hstmt);
 
   return my_SQLBindParameter(hstmt, ipar, fParamType, fCType, fSqlType,
                              cbColDef, ibScale, rgbValue, cbValueMax, pcbValue);
@@ -320,6 +322,7 @@ SQLRETURN SQL_API SQLDescribeParam( SQLHSTMT        hstmt,
 
     /* It is needed only in one case, but we won't make exceptions */
     CHECK_HANDLE(hstmt);
+    CHECK_ASYNC(stmt);
 
     if (pfSqlType)
         *pfSqlType= SQL_VARCHAR;
@@ -354,6 +357,7 @@ SQLRETURN SQL_API SQLParamOptions( SQLHSTMT     hstmt,
   STMT *stmt= (STMT *)hstmt;
 
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC(stmt);
 
   rc= stmt_SQLSetDescField(stmt, stmt->apd, 0, SQL_DESC_ARRAY_SIZE,
                            (SQLPOINTER)crow, buflen);
@@ -394,6 +398,7 @@ SQLRETURN SQL_API SQLNumParams(SQLHSTMT hstmt, SQLSMALLINT *pcpar)
   STMT *stmt= (STMT *)hstmt;
 
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC(stmt);
 
   if (pcpar)
     *pcpar= stmt->param_count;
@@ -415,6 +420,7 @@ SQLRETURN SQL_API SQLSetScrollOptions(  SQLHSTMT        hstmt,
     STMT *stmt= (STMT *)hstmt;
 
     CHECK_HANDLE(hstmt);
+    CHECK_ASYNC(stmt);
 
     return stmt_SQLSetDescField(stmt, stmt->ard, 0, SQL_DESC_ARRAY_SIZE,
                                 (SQLPOINTER)(SQLUINTEGER)crowRowset,
@@ -0,0 +1,552 @@
+/*
+  Copyright (c) 2018-Present MongoDB Inc.
+
+  The MySQL Connector/ODBC is licensed under the terms of the GPLv2
+  <http://www.gnu.org/licenses/old-licenses/gpl-2.0.html>, like most
+  MySQL Connectors. There are special exceptions to the terms and
+  conditions of the GPLv2 as it is applied to this software, see the
+  FLOSS License Exception
+  <http://www.mysql.com/about/legal/licensing/foss-exception.html>.
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published
+  by the Free Software Foundation; version 2 of the License.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+  or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+  for more details.
+
+  You should have received a copy of the GNU General Public License along
+  with this program; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+/**
+  @file  readahead.c
+  @brief Background reading of forward-only results.
+
+  A forward-only result is either stored on the client, or read from the
+  socket with mysql_use_result() as the application fetches it ("Don't
+  cache results"), or, if READAHEAD_ROWS is set, streamed: a background
+  thread reads the rows and puts their copies into a bounded ring, so
+  network I/O overlaps with the conversion of the rows already read.
+  READAHEAD_SIZE additionally limits the memory the ring can take.
+
+  The thread is the only user of the connection while it runs. Before
+  anything else is sent to the server, readahead_pause() stops it (calls
+  made on the MYSQL directly get it from readahead_yield()), and the
+  rest of the result is read synchronously once the ring is drained, just
+  as it would be without read-ahead. Threads are started and stopped under
+  dbc->readahead_lock, so that whoever pauses them returns only once they
+  are done with the connection.
+
+  The LIMIT scroller of the "Prefetch from server by ... rows" option
+  reads its next page the same way: once the current page is stored, a
+  thread runs the query of the next one and stores its result, which the
+  scroller takes when the application gets to the page. readahead_pause()
+  waits for that query to finish. dbc->page_ahead is guarded by
+  dbc->readahead_lock as dbc->readahead is.
+*/
+
+#include "driver.h"
+
+
+/*
+  Checks if rows of the current result of the statement are to be read in
+  background.
+*/
+BOOL readahead_wanted(STMT *stmt)
+{
+#ifdef THREAD
+  return result_mode(stmt) == RESULT_STREAMED && stmt->result != NULL
+      && !ssps_used(stmt)
+      && !stmt->fake_result && !stmt->result_array
+      && !scroller_exists(stmt);
+#else
+  return FALSE;
+#endif
+}
+
+
+#ifdef THREAD
+
+/* Copies the row into a single allocation that can outlive the next fetch */
+static MY_READAHEAD_ROW * copy_row(MYSQL_ROW values, unsigned long *lengths,
+                                   uint field_count)
+{
+  MY_READAHEAD_ROW *row;
+  size_t            size= sizeof(MY_READAHEAD_ROW)
+                        + field_count * (sizeof(char *) + sizeof(unsigned long));
+  char              *data;
+  uint              i;
+
+  for (i= 0; i < field_count; ++i)
+  {
+    if (values[i])
+    {
+      size+= lengths[i] + 1;
+    }
+  }
+
+  if (!(row= (MY_READAHEAD_ROW *)myodbc_malloc(size, MYF(0))))
+  {
+    return NULL;
+  }
+
+  row->values=  (MYSQL_ROW)(row + 1);
+  row->lengths= (unsigned long *)(row->values + field_count);
+  row->size=    size;
+  data=         (char *)(row->lengths + field_count);
+
+  for (i= 0; i < field_count; ++i)
+  {
+    row->lengths[i]= lengths[i];
+
+    if (values[i])
+    {
+      memcpy(data, values[i], lengths[i]);
+      data[lengths[i]]= '\0';
+      row->values[i]= data;
+      data+= lengths[i] + 1;
+    }
+    else
+    {
+      row->values[i]= NULL;
+    }
+  }
+
+  return row;
+}
+
+
+static my_bool ring_full(MY_READAHEAD *ra)
+{
+  return ra->count == ra->size
+      || (ra->max_bytes && ra->count && ra->bytes >= ra->max_bytes);
+}
+
+
+/* Body of the read-ahead thread */
+static void * read_rows(void *arg)
+{
+  MY_READAHEAD *ra= (MY_READAHEAD *)arg;
+  uint          field_count= mysql_num_fields(ra->result);
+
+  mysql_thread_init();
+
+  myodbc_mutex_lock(&ra->lock);
+
+  while (!ra->stop)
+  {
+    MYSQL_ROW         values;
+    MY_READAHEAD_ROW  *row= NULL;
+
+    if (ring_full(ra))
+    {
+      myodbc_cond_wait(&ra->drained, &ra->lock);
+      continue;
+    }
+
+    myodbc_mutex_unlock(&ra->lock);
+
+    if ((values= mysql_fetch_row(ra->result)))
+    {
+      row= copy_row(values, mysql_fetch_lengths(ra->result), field_count);
+    }
+
+    myodbc_mutex_lock(&ra->lock);
+
+    if (!values)
+    {
+      ra->eof= TRUE;
+      break;
+    }
+
+    if (!row)
+    {
+      /* Out of memory. The row stays in libmysql buffers until the next
+         mysql_fetch_row(), so the fetch takes it from there and reads the
+         rest of the result synchronously */
+      ra->pending= values;
+      break;
+    }
+
+    ra->rows[(ra->head + ra->count) % ra->size]= row;
+    ++ra->count;
+    ra->bytes+= row->size;
+
+    myodbc_cond_signal(&ra->filled);
+  }
+
+  ra->running= FALSE;
+  myodbc_cond_broadcast(&ra->filled);
+  myodbc_mutex_unlock(&ra->lock);
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+
+/*
+  Stops the thread of the ring, if it is still running. Called under
+  dbc->readahead_lock, so the thread is joined once, and nobody gets the
+  connection before it is.
+*/
+static void readahead_stop(DBC *dbc, MY_READAHEAD *ra)
+{
+  my_bool joinable;
+
+  myodbc_mutex_lock(&ra->lock);
+  joinable= !ra->stop;
+  ra->stop= TRUE;
+  myodbc_cond_broadcast(&ra->drained);
+  myodbc_mutex_unlock(&ra->lock);
+
+  if (joinable)
+  {
+    my_thread_join(&ra->thread, NULL);
+  }
+
+  if (dbc->readahead == ra)
+  {
+    dbc->readahead= NULL;
+  }
+}
+
+
+/* Stops whatever reads from the connection, under dbc->readahead_lock */
+static void pause_readers(DBC *dbc)
+{
+  if (dbc->readahead)
+  {
+    readahead_stop(dbc, dbc->readahead);
+  }
+
+  if (dbc->page_ahead)
+  {
+    MY_PAGE_AHEAD *page= dbc->page_ahead;
+
+    my_thread_join(&page->thread, NULL);
+    page->running= FALSE;
+    dbc->page_ahead= NULL;
+  }
+}
+
+
+/* Allocates the ring for the current result and starts the thread */
+static MY_READAHEAD * readahead_start(STMT *stmt)
+{
+  DataSource   *ds= stmt->dbc->ds;
+  MY_READAHEAD *ra= (MY_READAHEAD *)myodbc_malloc(sizeof(MY_READAHEAD),
+                                                  MYF(MY_ZEROFILL));
+
+  if (ra == NULL)
+  {
+    return NULL;
+  }
+
+  ra->result=    stmt->result;
+  ra->size=      ds->readahead_rows;
+  ra->max_bytes= (size_t)ds->readahead_size * 1024;
+  ra->running=   TRUE;
+
+  if (!(ra->rows= (MY_READAHEAD_ROW **)myodbc_malloc(sizeof(MY_READAHEAD_ROW *)
+                                                     * ra->size, MYF(0))))
+  {
+    x_free(ra);
+    return NULL;
+  }
+
+  myodbc_mutex_init(&ra->lock, NULL);
+  myodbc_cond_init(&ra->filled);
+  myodbc_cond_init(&ra->drained);
+
+  /* Only one result at a time can be read from the connection */
+  myodbc_mutex_lock(&stmt->dbc->readahead_lock);
+  pause_readers(stmt->dbc);
+
+  if (my_thread_create(&ra->thread, NULL, read_rows, ra))
+  {
+    myodbc_mutex_unlock(&stmt->dbc->readahead_lock);
+    myodbc_cond_destroy(&ra->drained);
+    myodbc_cond_destroy(&ra->filled);
+    myodbc_mutex_destroy(&ra->lock);
+    x_free(ra->rows);
+    x_free(ra);
+    return NULL;
+  }
+
+  stmt->readahead= ra;
+  stmt->dbc->readahead= ra;
+  myodbc_mutex_unlock(&stmt->dbc->readahead_lock);
+
+  return ra;
+}
+
+
+#endif /* THREAD */
+
+
+/*
+  Stops reading ahead of the result being read from the connection, if
+  there is one. The rows already in the ring are still fetched from there.
+  Returns once the thread is done with the connection, also if another
+  thread is stopping it at the same time.
+*/
+void readahead_pause(DBC *dbc)
+{
+#ifdef THREAD
+  myodbc_mutex_lock(&dbc->readahead_lock);
+  pause_readers(dbc);
+  myodbc_mutex_unlock(&dbc->readahead_lock);
+#endif
+}
+
+
+/*
+  Returns the connection for a call that sends to the server, once nothing
+  reads from it in background. Whatever isn't sent by do_query() gets the
+  connection here.
+*/
+MYSQL * readahead_yield(DBC *dbc)
+{
+  readahead_pause(dbc);
+  return dbc->mysql;
+}
+
+
+/*
+  Returns the next row of the result, starting the read-ahead thread with
+  the first row.
+*/
+MYSQL_ROW readahead_fetch(STMT *stmt)
+{
+#ifdef THREAD
+  MY_READAHEAD *ra= stmt->readahead;
+  MYSQL_ROW     values;
+
+  if (ra == NULL && !(ra= readahead_start(stmt)))
+  {
+    return mysql_fetch_row(stmt->result);
+  }
+
+  myodbc_mutex_lock(&ra->lock);
+
+  if (ra->current)
+  {
+    x_free(ra->current);
+    ra->current= NULL;
+  }
+
+  while (ra->count == 0 && ra->running)
+  {
+    myodbc_cond_wait(&ra->filled, &ra->lock);
+  }
+
+  if (ra->count > 0)
+  {
+    ra->current= ra->rows[ra->head];
+    ra->head= (ra->head + 1) % ra->size;
+    --ra->count;
+    ra->bytes-= ra->current->size;
+    ++ra->consumed;
+
+    myodbc_cond_signal(&ra->drained);
+    myodbc_mutex_unlock(&ra->lock);
+
+    return ra->current->values;
+  }
+
+  myodbc_mutex_unlock(&ra->lock);
+
+  /* The thread is done, either at the end of the result or paused */
+  if (ra->pending)
+  {
+    values= ra->pending;
+    ra->pending= NULL;
+  }
+  else if (ra->eof || !(values= mysql_fetch_row(stmt->result)))
+  {
+    return NULL;
+  }
+
+  ++ra->consumed;
+  return values;
+#else
+  return mysql_fetch_row(stmt->result);
+#endif
+}
+
+
+/* Lengths of the values of the row returned by readahead_fetch() */
+unsigned long * readahead_lengths(STMT *stmt)
+{
+  if (stmt->readahead && stmt->readahead->current)
+  {
+    return stmt->readahead->current->lengths;
+  }
+
+  return mysql_fetch_lengths(stmt->result);
+}
+
+
+/*
+  Stops the thread and frees the ring of the statement. Has to be called
+  before its result is freed.
+*/
+void readahead_free(STMT *stmt)
+{
+#ifdef THREAD
+  MY_READAHEAD *ra= stmt->readahead;
+
+  if (ra == NULL)
+  {
+    return;
+  }
+
+  myodbc_mutex_lock(&stmt->dbc->readahead_lock);
+  readahead_stop(stmt->dbc, ra);
+  myodbc_mutex_unlock(&stmt->dbc->readahead_lock);
+
+  while (ra->count > 0)
+  {
+    x_free(ra->rows[ra->head]);
+    ra->head= (ra->head + 1) % ra->size;
+    --ra->count;
+  }
+
+  x_free(ra->current);
+  x_free(ra->rows);
+
+  myodbc_cond_destroy(&ra->drained);
+  myodbc_cond_destroy(&ra->filled);
+  myodbc_mutex_destroy(&ra->lock);
+
+  x_free(ra);
+  stmt->readahead= NULL;
+#endif
+}
+
+
+#ifdef THREAD
+
+/* Body of the thread reading the next page of a scroller */
+static void * read_page(void *arg)
+{
+  MY_PAGE_AHEAD *page= (MY_PAGE_AHEAD *)arg;
+
+  mysql_thread_init();
+
+  if (!mysql_real_query(page->mysql, page->query, page->query_len))
+  {
+    page->result= mysql_store_result(page->mysql);
+  }
+
+  mysql_thread_end();
+
+  return NULL;
+}
+
+#endif /* THREAD */
+
+
+/*
+  Starts reading the page of the scroller of the statement at the offset in
+  background. Takes the query, which is freed with the page. Called under
+  dbc->lock, as are page_ahead_take() and page_ahead_free().
+*/
+void page_ahead_start(STMT *stmt, char *query, unsigned long query_len,
+                      unsigned long long offset)
+{
+#ifdef THREAD
+  MY_PAGE_AHEAD *page;
+
+  page_ahead_free(stmt);
+
+  if (!(page= (MY_PAGE_AHEAD *)myodbc_malloc(sizeof(MY_PAGE_AHEAD),
+                                             MYF(MY_ZEROFILL))))
+  {
+    x_free(query);
+    return;
+  }
+
+  page->mysql=     stmt->dbc->mysql;
+  page->query=     query;
+  page->query_len= query_len;
+  page->offset=    offset;
+  page->running=   TRUE;
+
+  /* Only one query at a time can run on the connection */
+  myodbc_mutex_lock(&stmt->dbc->readahead_lock);
+  pause_readers(stmt->dbc);
+
+  if (my_thread_create(&page->thread, NULL, read_page, page))
+  {
+    myodbc_mutex_unlock(&stmt->dbc->readahead_lock);
+    x_free(page->query);
+    x_free(page);
+    return;
+  }
+
+  stmt->scroller.ahead= page;
+  stmt->dbc->page_ahead= page;
+  myodbc_mutex_unlock(&stmt->dbc->readahead_lock);
+#else
+  x_free(query);
+#endif
+}
+
+
+/*
+  Returns the result of the page at the offset, if it has been read in
+  background, waiting for the query to finish. The caller owns the result.
+*/
+MYSQL_RES * page_ahead_take(STMT *stmt, unsigned long long offset)
+{
+  MY_PAGE_AHEAD *page= stmt->scroller.ahead;
+  MYSQL_RES     *result= NULL;
+
+  if (page == NULL)
+  {
+    return NULL;
+  }
+
+  if (page->running)
+  {
+    readahead_pause(stmt->dbc);
+  }
+
+  if (page->offset == offset)
+  {
+    result= page->result;
+    page->result= NULL;
+  }
+
+  page_ahead_free(stmt);
+
+  return result;
+}
+
+
+/* Waits for the page of the scroller of the statement and frees it */
+void page_ahead_free(STMT *stmt)
+{
+  MY_PAGE_AHEAD *page= stmt->scroller.ahead;
+
+  if (page == NULL)
+  {
+    return;
+  }
+
+  if (page->running)
+  {
+    readahead_pause(stmt->dbc);
+  }
+
+  mysql_free_result(page->result);
+  x_free(page->query);
+  x_free(page);
+  stmt->scroller.ahead= NULL;
+}
@@ -30,7 +30,6 @@
 #include "driver.h"
 #include <errmsg.h>
 #include <ctype.h>
-#include <locale.h>
 
 #define SQL_MY_PRIMARY_KEY 1212
 
@@ -383,7 +382,8 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
              SQLPOINTER rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue,
              char *value, ulong length, DESCREC *arrec)
 {
-  MYSQL_FIELD *field= mysql_fetch_field_direct(stmt->result, column_number);
+  MY_COLUMN_PLAN *plan= get_column_plan(stmt, column_number);
+  MYSQL_FIELD *field;
   SQLLEN    tmp;
   long long numericValue;
   my_bool   convert= 1;
@@ -391,10 +391,17 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
   char      as_string[50]; /* Buffer that might be required to convert other
                               types data to its string representation */
 
+  if (!plan)
+  {
+    return set_error(stmt, MYERR_S1001, NULL, 4001);
+  }
+
+  field= plan->field;
+
   /* get the exact type if we don't already have it */
   if (fCType == SQL_C_DEFAULT)
   {
-    fCType= unireg_to_c_datatype(field);
+    fCType= plan->default_c_type;
 
     if (!cbValueMax)
     {
@@ -441,7 +448,7 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
   }
   else
   {
-    if (!odbc_supported_conversion(get_sql_data_type(stmt, field, 0), fCType)
+    if (!odbc_supported_conversion(plan->sql_type, fCType)
      && !driver_supported_conversion(field,fCType))
     {
       /*The state 07009 was incorrect
@@ -484,9 +491,7 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
         Handle BLOB -> CHAR conversion 
         Conversion only for field which is having binary character set (63)
       */
-      if (((field->flags & (BLOB_FLAG|BINARY_FLAG)) 
-                == (BLOB_FLAG|BINARY_FLAG) )
-                && field->charsetnr == BINARY_CHARSET_NUMBER )
+      if (plan->binhex)
       {
         return copy_binhex_result(stmt,
                                   (SQLCHAR *)rgbValue, cbValueMax, pcbValue,
@@ -535,7 +540,7 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
 
         return copy_wchar_result(stmt, (SQLWCHAR *)rgbValue,
                         (SQLINTEGER)(cbValueMax / sizeof(SQLWCHAR)), pcbValue,
-                        field, tmp, length);
+                        plan->charset, tmp, length);
       }
 
     case SQL_C_BIT:
@@ -642,17 +647,55 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
     case SQL_C_TYPE_DATE:
       {
         SQL_DATE_STRUCT tmp_date;
-        char *tmp= get_string(stmt, column_number, value, &length, as_string);
+        SQL_TIMESTAMP_STRUCT ts;
+        char *tmp;
 
         if (!rgbValue)
         {
           rgbValue= (char *)&tmp_date;
         }
 
+        /* Dates of binary protocol results do not need parsing */
+        if (ssps_used(stmt) && IS_DATE_FIELD(field))
+        {
+          if (!ssps_get_timestamp(stmt, column_number, &ts,
+                                  stmt->dbc->ds->zero_date_to_min))
+          {
+            ((SQL_DATE_STRUCT *)rgbValue)->year=  ts.year;
+            ((SQL_DATE_STRUCT *)rgbValue)->month= ts.month;
+            ((SQL_DATE_STRUCT *)rgbValue)->day=   ts.day;
+            *pcbValue= sizeof(SQL_DATE_STRUCT);
+
+            /* Time part of a datetime is lost */
+            if (ts.hour || ts.minute || ts.second || ts.fraction)
+            {
+              set_stmt_error(stmt, "01S07", NULL, 0);
+              result= SQL_SUCCESS_WITH_INFO;
+            }
+          }
+          else
+          {
+            *pcbValue= SQL_NULL_DATA;
+          }
+
+          break;
+        }
+
+        tmp= get_string(stmt, column_number, value, &length, as_string);
+
         if (!str_to_date((SQL_DATE_STRUCT *)rgbValue, tmp, length,
                           stmt->dbc->ds->zero_date_to_min))
         {
           *pcbValue= sizeof(SQL_DATE_STRUCT);
+
+          if (IS_DATE_FIELD(field) && field->type != MYSQL_TYPE_DATE
+            && !str_to_ts(&ts, tmp, length, stmt->dbc->ds->zero_date_to_min,
+                          TRUE)
+            && (ts.hour || ts.minute || ts.second || ts.fraction))
+          {
+            set_stmt_error(stmt, "01S07", NULL, 0);
+            result= SQL_SUCCESS_WITH_INFO;
+          }
         }
         else
         {
@@ -711,10 +754,22 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
           field->type == MYSQL_TYPE_DATETIME)
       {
         SQL_TIMESTAMP_STRUCT ts;
+        int ts_status;
+
+        /* Binary protocol results have it in MYSQL_TIME already */
+        if (ssps_used(stmt))
+        {
+          ts_status= ssps_get_timestamp(stmt, column_number, &ts,
+                                        stmt->dbc->ds->zero_date_to_min);
+        }
+        else
+        {
+          ts_status= str_to_ts(&ts, get_string(stmt, column_number, value,
+                               &length, as_string), SQL_NTS,
+                               stmt->dbc->ds->zero_date_to_min, TRUE);
+        }
 
-        switch (str_to_ts(&ts, get_string(stmt, column_number, value, &length,
-                          as_string), SQL_NTS, stmt->dbc->ds->zero_date_to_min,
-                          TRUE))
+        switch (ts_status)
         {
         case SQLTS_BAD_DATE:
           return set_stmt_error(stmt, "22018", "Data value is not a valid time(stamp) value", 0);
@@ -798,7 +853,26 @@ sql_get_data(STMT *stmt, SQLSMALLINT fCType, uint column_number,
     case SQL_C_TIMESTAMP:
     case SQL_C_TYPE_TIMESTAMP:
       {
-      char *tmp= get_string(stmt, column_number, value, &length, as_string);
+      char *tmp;
+
+      /* Neither do datetimes */
+      if (ssps_used(stmt) && IS_DATE_FIELD(field))
+      {
+        if (ssps_get_timestamp(stmt, column_number,
+                               (SQL_TIMESTAMP_STRUCT *)rgbValue,
+                               stmt->dbc->ds->zero_date_to_min))
+        {
+          *pcbValue= SQL_NULL_DATA;
+        }
+        else
+        {
+          *pcbValue= sizeof(SQL_TIMESTAMP_STRUCT);
+        }
+
+        break;
+      }
+
+      tmp= get_string(stmt, column_number, value, &length, as_string);
 
       if (field->type == MYSQL_TYPE_TIME)
       {
@@ -944,7 +1018,7 @@ static SQLRETURN check_result(STMT *stmt)
         }
         else
         {
-          set_sql_select_limit(stmt, real_max_rows, TRUE);
+          set_sql_select_limit(stmt->dbc, real_max_rows, TRUE);
         }
         stmt->stmt_options.max_rows= real_max_rows;
       }
@@ -1002,6 +1076,7 @@ SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT  hstmt, SQLSMALLINT *pccol)
 
   CHECK_HANDLE(hstmt);
   CHECK_DATA_OUTPUT(hstmt, pccol);
+  CHECK_ASYNC(stmt);
 
   if (!ssps_used(stmt))
   {
@@ -1048,6 +1123,8 @@ MySQLDescribeCol(SQLHSTMT hstmt, SQLUSMALLINT column,
 
   *need_free= 0;
 
+  CHECK_ASYNC(stmt);
+
   /* SQLDescribeCol can be called before SQLExecute. Thus we need make sure that
      all parameters have been bound */
   if (!ssps_used(stmt))
@@ -1131,6 +1208,8 @@ MySQLColAttribute(SQLHSTMT hstmt, SQLUSMALLINT column,
   SQLRETURN error= SQL_SUCCESS;
   DESCREC *irrec;
 
+  CHECK_ASYNC(stmt);
+
   if (!ssps_used(stmt))
   {
     /* MySQLColAttribute can be called before SQLExecute. Thus we need make sure that
@@ -1313,6 +1392,7 @@ SQLRETURN SQL_API SQLBindCol(SQLHSTMT      StatementHandle,
   /* TODO if this function fails, the SQL_DESC_COUNT should be unchanged in ard */
 
   CHECK_HANDLE(stmt);
+  CHECK_ASYNC(stmt);
 
   CLEAR_STMT_ERROR(stmt);
 
@@ -1344,6 +1424,7 @@ SQLRETURN SQL_API SQLBindCol(SQLHSTMT      StatementHandle,
         arrec->octet_length_ptr= NULL;
       }
     }
+    ++stmt->ard->generation;
     return SQL_SUCCESS;
   }
 
@@ -1386,10 +1467,11 @@ SQLRETURN SQL_API SQLBindCol(SQLHSTMT      StatementHandle,
 
 /*
   @type    : myodbc3 internal
-  @purpose : returns the latest resultset(dynamic)
+  @purpose : runs the query of the dynamic cursor again, keeping the
+             position of the cursor
 */
 
-my_bool set_dynamic_result(STMT *stmt)
+static my_bool rerun_dynamic_query(STMT *stmt)
 {
   SQLRETURN rc;
   long row= stmt->current_row;
@@ -1407,6 +1489,44 @@ my_bool set_dynamic_result(STMT *stmt)
 }
 
 
+/*
+  @type    : myodbc3 internal
+  @purpose : brings rows [first_row, first_row + rows) of the dynamic cursor
+             up to date - through the keyset if possible, otherwise runs the
+             query again
+*/
+
+my_bool refresh_dynamic_rows(STMT *stmt, long first_row, long rows)
+{
+  if (!keyset_refresh(stmt, first_row, rows))
+  {
+    return FALSE;
+  }
+
+  if (rerun_dynamic_query(stmt))
+  {
+    return TRUE;
+  }
+
+  /* Rows of the new result are up to date, the keyset starts with them */
+  keyset_refresh(stmt, first_row, rows);
+
+  return FALSE;
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : returns the latest resultset(dynamic)
+*/
+
+my_bool set_dynamic_result(STMT *stmt)
+{
+  return refresh_dynamic_rows(stmt, stmt->current_row,
+                              (long)stmt->rows_found_in_set);
+}
+
+
 /*
   @type    : ODBC 1.0 API
   @purpose : retrieves data for a single column in the result set. It can
@@ -1432,6 +1552,7 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
     SQLSMALLINT sColNum= ColumnNumber; 
 
     CHECK_HANDLE(stmt);
+    CHECK_ASYNC(stmt);
 
     if (!stmt->result || (!stmt->current_values && stmt->out_params_state != OPS_STREAMS_PENDING))
     {
@@ -1490,10 +1611,6 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
 
     assert(irrec);
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-      setlocale(LC_NUMERIC, "C");
-
-
     if ((sColNum == -1 && stmt->stmt_options.bookmarks == SQL_UB_VARIABLE))
     {
       char _value[21];
@@ -1520,28 +1637,22 @@ SQLRETURN SQL_API SQLGetData(SQLHSTMT      StatementHandle,
                           arrec);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-        setlocale(LC_NUMERIC,default_locale);
-
     return result;
 }
 
 
 /*
-  @type    : ODBC 1.0 API
+  @type    : myodbc3 internal
   @purpose : determines whether more results are available on a statement
   containing SELECT, UPDATE, INSERT, or DELETE statements and,
   if so, initializes processing for those results
 */
 
-SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
+static SQLRETURN more_results( STMT *pStmt )
 {
-  STMT *  pStmt   = (STMT *)hStmt;
   int         nRetVal;
   SQLRETURN   nReturn = SQL_SUCCESS;
 
-  CHECK_HANDLE(hStmt);
-
   myodbc_mutex_lock( &pStmt->dbc->lock );
 
   CLEAR_STMT_ERROR( pStmt );
@@ -1566,17 +1677,17 @@ SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
   /* call to mysql_next_result() failed */
   if (nRetVal > 0)
   {
-    nRetVal= mysql_errno(&pStmt->dbc->mysql);
+    nRetVal= mysql_errno(pStmt->dbc->mysql);
 
     switch ( nRetVal )
     {
       case CR_SERVER_GONE_ERROR:
       case CR_SERVER_LOST:
-        nReturn = set_stmt_error( pStmt, "08S01", mysql_error( &pStmt->dbc->mysql ), nRetVal );
+        nReturn = set_stmt_error( pStmt, "08S01", mysql_error( pStmt->dbc->mysql ), nRetVal );
         goto exitSQLMoreResults;
       case CR_COMMANDS_OUT_OF_SYNC:
       case CR_UNKNOWN_ERROR:
-        nReturn = set_stmt_error( pStmt, "HY000", mysql_error( &pStmt->dbc->mysql ), nRetVal );
+        nReturn = set_stmt_error( pStmt, "HY000", mysql_error( pStmt->dbc->mysql ), nRetVal );
         goto exitSQLMoreResults;
       default:
         nReturn = set_stmt_error( pStmt, "HY000", "unhandled error from mysql_next_result()", nRetVal );
@@ -1611,8 +1722,8 @@ SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
       goto exitSQLMoreResults;
     }
     /* we have fields but no resultset (not even an empty one) - this is bad */
-    nReturn = set_stmt_error(pStmt, "HY000", mysql_error( &pStmt->dbc->mysql ),
-                              mysql_errno(&pStmt->dbc->mysql));
+    nReturn = set_stmt_error(pStmt, "HY000", mysql_error( pStmt->dbc->mysql ),
+                              mysql_errno(pStmt->dbc->mysql));
     goto exitSQLMoreResults;
   }
   
@@ -1639,11 +1750,14 @@ SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
     free_result_bind(pStmt);
     if (bind_result(pStmt) || get_result(pStmt))
     {
-      nReturn= set_stmt_error(pStmt, "HY000", mysql_error( &pStmt->dbc->mysql ),
-                            mysql_errno(&pStmt->dbc->mysql));
+      nReturn= set_stmt_error(pStmt, "HY000", mysql_error( pStmt->dbc->mysql ),
+                            mysql_errno(pStmt->dbc->mysql));
     }
 
+    /* Converting the metadata does not need the connection */
+    myodbc_mutex_unlock( &pStmt->dbc->lock );
     fix_result_types(pStmt);
+    return nReturn;
   }
 
 exitSQLMoreResults:
@@ -1652,6 +1766,27 @@ exitSQLMoreResults:
 }
 
 
+/*
+  @type    : ODBC 1.0 API
+  @purpose : determines whether more results are available on a statement
+  containing SELECT, UPDATE, INSERT, or DELETE statements and,
+  if so, initializes processing for those results
+*/
+
+SQLRETURN SQL_API SQLMoreResults( SQLHSTMT hStmt )
+{
+  SQLRETURN rc;
+
+  CHECK_HANDLE(hStmt);
+
+  if (async_requested((STMT *)hStmt) &&
+      async_call((STMT *)hStmt, more_results, NULL, 0, &rc))
+    return rc;
+
+  return more_results((STMT *)hStmt);
+}
+
+
 /*
   @type    : ODBC 1.0 API
   @purpose : returns the number of rows affected by an UPDATE, INSERT,
@@ -1667,6 +1802,7 @@ SQLRETURN SQL_API SQLRowCount( SQLHSTMT hstmt,
 
     CHECK_HANDLE(hstmt);
     CHECK_DATA_OUTPUT(hstmt, pcrow);
+    CHECK_ASYNC(stmt);
 
     if ( stmt->result )
     {
@@ -1830,9 +1966,35 @@ fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
                                       sizeof(SQLLEN), rownum);
       }
 
-      tmp_res= sql_get_data(stmt, arrec->concise_type, (uint)i,
-                            TargetValuePtr, arrec->octet_length, pcbValue,
-                            *values, length, arrec);
+      if (stmt->result_direct && stmt->result_direct[i])
+      {
+        /* libmysql has put the value right into the application buffer */
+        tmp_res= SQL_SUCCESS;
+
+        if (!*stmt->result_bind[i].is_null)
+        {
+          if (pcbValue)
+          {
+            *pcbValue= bind_length(arrec->concise_type, 0);
+          }
+        }
+        else if (pcbValue)
+        {
+          *pcbValue= SQL_NULL_DATA;
+        }
+        else
+        {
+          tmp_res= set_stmt_error(stmt, "22002",
+                             "Indicator variable required but not supplied", 0);
+        }
+      }
+      else
+      {
+        tmp_res= sql_get_data(stmt, arrec->concise_type, (uint)i,
+                              TargetValuePtr, arrec->octet_length, pcbValue,
+                              *values, length, arrec);
+      }
+
       if (tmp_res != SQL_SUCCESS)
       {
         if (tmp_res == SQL_SUCCESS_WITH_INFO)
@@ -1852,125 +2014,702 @@ fill_fetch_buffers(STMT *stmt, MYSQL_ROW values, uint rownum)
 }
 
 
-/*
-  @type    : myodbc3 internal
-  @purpose : fetches the specified row from the result set and
-             returns data for all bound columns. Row can be specified
-             at an absolute or relative position
+/**
+  Merge result of a single cell conversion into the result of its row,
+  the same way fill_fetch_buffers() does it for the whole row.
 */
-SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
-                                       SQLUSMALLINT         fFetchType,
-                                       SQLLEN               irow,
-                                       SQLULEN             *pcrow,
-                                       SQLUSMALLINT        *rgfRowStatus,
-                                       my_bool              upd_status )
+static void rowset_merge_res(SQLRETURN *row_res, SQLRETURN cell_res)
 {
-    SQLULEN           rows_to_fetch;
-    long              cur_row, max_row;
-    SQLRETURN         row_res, res;
-    STMT              *stmt= (STMT *) hstmt;
-    MYSQL_ROW         values= 0;
-    MYSQL_ROW_OFFSET  save_position= 0;
-    SQLULEN           dummy_pcrow;
-    BOOL              disconnected= FALSE;
-    long              brow= 0;
+  if (cell_res == SQL_SUCCESS)
+    return;
 
-    if ( !stmt->result )
-      return set_stmt_error(stmt, "24000", "Fetch without a SELECT", 0);
+  if (cell_res == SQL_SUCCESS_WITH_INFO)
+  {
+    if (*row_res == SQL_SUCCESS)
+      *row_res= cell_res;
+  }
+  else
+  {
+    *row_res= SQL_ERROR;
+  }
+}
 
-    cur_row = stmt->current_row;
 
-    if ( !pcrow )
-      pcrow= &dummy_pcrow;
+/**
+  Set the length/indicator of a cell of the rowset. For NULL values the
+  indicator is required, and the cell is failed with 22002 if it is missing.
 
-    /* for scrollable cursor("scroller") max_row is max row for currently
-       fetched part of resultset */
-    max_row= (long) num_rows(stmt);
-    reset_getdata_position(stmt);
-    stmt->current_values= 0;          /* For SQLGetData */
+  @return TRUE if the value is NULL and the caller has nothing to convert
+*/
+static my_bool rowset_indicator(STMT *stmt, DESCREC *arrec, uint row,
+                                char *value, SQLLEN length)
+{
+  SQLLEN *pcbValue= NULL;
 
-    switch ( fFetchType )
+  if (arrec->octet_length_ptr)
+  {
+    pcbValue= ptr_offset_adjust(arrec->octet_length_ptr,
+                                stmt->ard->bind_offset_ptr,
+                                stmt->ard->bind_type,
+                                sizeof(SQLLEN), row);
+  }
+
+  if (value == NULL)
+  {
+    if (!pcbValue)
     {
-      case SQL_FETCH_NEXT:
-        cur_row= (stmt->current_row < 0 ? 0 :
-                  stmt->current_row + stmt->rows_found_in_set);
-        break;
-      case SQL_FETCH_PRIOR:
-        cur_row= (stmt->current_row <= 0 ? -1 :
-                  (long)(stmt->current_row - stmt->ard->array_size));
-        break;
-      case SQL_FETCH_FIRST:
-        cur_row= 0L;
-        break;
-      case SQL_FETCH_LAST:
-        cur_row= max_row - stmt->ard->array_size;
-        break;
-      case SQL_FETCH_ABSOLUTE:
-        if (irow < 0)
-        {
-          /* Fetch from end of result set */
-          if ( max_row+irow < 0 && -irow <= (long) stmt->ard->array_size )
-          {
-            /*
-              | FetchOffset | > LastResultRow AND
-              | FetchOffset | <= RowsetSize
-            */
-            cur_row= 0;     /* Return from beginning */
-          }
-          else
-            cur_row= max_row + irow;     /* Ok if max_row <= -irow */
-        }
-        else
-          cur_row= (long) irow - 1;
-        break;
+      rowset_merge_res(&stmt->rowset.res[row],
+                       set_stmt_error(stmt, "22002",
+                         "Indicator variable required but not supplied", 0));
+    }
+    else
+    {
+      *pcbValue= SQL_NULL_DATA;
+    }
+    return TRUE;
+  }
 
-      case SQL_FETCH_RELATIVE:
-        cur_row= stmt->current_row + irow;
-        if (stmt->current_row > 0 && cur_row < 0 &&
-           (long) - irow <= (long)stmt->ard->array_size)
-        {
-          cur_row= 0;
-        }
-        break;
+  if (pcbValue)
+  {
+    *pcbValue= length;
+  }
 
-      case SQL_FETCH_BOOKMARK:
-        {
-          if (stmt->stmt_options.bookmark_ptr)
-          {
-            DESCREC *arrec;
-            IS_BOOKMARK_VARIABLE(stmt);
-            arrec= desc_get_rec(stmt->ard, -1, FALSE);
+  return FALSE;
+}
 
-            if (arrec->concise_type == SQL_C_BOOKMARK)
-            {
-              brow= *((SQLLEN *) stmt->stmt_options.bookmark_ptr);
-            }
-            else
-            {
-              brow= atol((SQLCHAR *) stmt->stmt_options.bookmark_ptr);
-            }
-          }
 
-          cur_row= brow + irow;
-          if (cur_row < 0 && (long)-irow <= (long)stmt->ard->array_size) 
-          {
-            cur_row= 0;
-          }
-        }
-        break;
+/**
+  Column converter for integer columns bound as integer C types. The text
+  protocol value is parsed exactly like sql_get_data() does it, but the
+  type dispatch happens once per column instead of once per cell.
+*/
+static void convert_column_integer(STMT *stmt, uint column, DESCREC *arrec,
+                                   uint rows)
+{
+  SQLCHAR *target= NULL;
+  SQLLEN  stride, width= bind_length(arrec->concise_type, 0);
+  uint    row;
 
-      default:
-          return set_error(stmt, MYERR_S1106, "Fetch type out of range", 0);
-    }
+  stride= stmt->ard->bind_type == SQL_BIND_BY_COLUMN ? arrec->octet_length
+                                                     : stmt->ard->bind_type;
+  if (arrec->data_ptr)
+  {
+    target= ptr_offset_adjust(arrec->data_ptr, stmt->ard->bind_offset_ptr,
+                              stmt->ard->bind_type, arrec->octet_length, 0);
+  }
 
-    if ( cur_row < 0 )
+  for (row= 0; row < rows; ++row)
+  {
+    char    *value= stmt->rowset.values[row][column];
+    SQLCHAR *cell;
+
+    if (rowset_indicator(stmt, arrec, row, value, width) || !target)
+      continue;
+
+    cell= target + stride * row;
+
+    switch (arrec->concise_type)
     {
-      stmt->current_row= -1;  /* Before first row */
-      stmt->rows_found_in_set= 0;
-      data_seek(stmt, 0L);
-      set_stmt_error(stmt, "01S07", "One or more row has error.", 0);
-      return SQL_SUCCESS_WITH_INFO; //SQL_NO_DATA_FOUND
-    }
+    case SQL_C_TINYINT:
+    case SQL_C_STINYINT:
+      *((SQLSCHAR *)cell)= (SQLSCHAR)atoi(value);
+      break;
+    case SQL_C_UTINYINT:
+      *((SQLCHAR *)cell)= (SQLCHAR)(unsigned int)atoi(value);
+      break;
+    case SQL_C_SHORT:
+    case SQL_C_SSHORT:
+      *((SQLSMALLINT *)cell)= (SQLSMALLINT)atoi(value);
+      break;
+    case SQL_C_USHORT:
+      *((SQLUSMALLINT *)cell)= (SQLUSMALLINT)(uint)strtoll(value, NULL, 10);
+      break;
+    case SQL_C_LONG:
+    case SQL_C_SLONG:
+      *((SQLINTEGER *)cell)= (SQLINTEGER)strtoll(value, NULL, 10);
+      break;
+    case SQL_C_ULONG:
+      *((SQLUINTEGER *)cell)= (SQLUINTEGER)strtoll(value, NULL, 10);
+      break;
+    case SQL_C_SBIGINT:
+      *((longlong *)cell)= (longlong)strtoll(value, NULL, 10);
+      break;
+    case SQL_C_UBIGINT:
+      *((ulonglong *)cell)= (ulonglong)strtoll(value, NULL, 10);
+      break;
+    }
+  }
+}
+
+
+/**
+  Column converter for numeric columns bound as SQL_C_DOUBLE/SQL_C_FLOAT.
+*/
+static void convert_column_double(STMT *stmt, uint column, DESCREC *arrec,
+                                  uint rows)
+{
+  SQLCHAR *target= NULL;
+  SQLLEN  stride;
+  uint    row;
+
+  stride= stmt->ard->bind_type == SQL_BIND_BY_COLUMN ? arrec->octet_length
+                                                     : stmt->ard->bind_type;
+  if (arrec->data_ptr)
+  {
+    target= ptr_offset_adjust(arrec->data_ptr, stmt->ard->bind_offset_ptr,
+                              stmt->ard->bind_type, arrec->octet_length, 0);
+  }
+
+  for (row= 0; row < rows; ++row)
+  {
+    char    *value= stmt->rowset.values[row][column];
+    SQLCHAR *cell;
+
+    if (arrec->concise_type == SQL_C_FLOAT)
+    {
+      if (rowset_indicator(stmt, arrec, row, value, sizeof(float)) || !target)
+        continue;
+      cell= target + stride * row;
+      *((float *)cell)= (float)myodbc_strtold(value, NULL);
+    }
+    else
+    {
+      if (rowset_indicator(stmt, arrec, row, value, sizeof(double)) || !target)
+        continue;
+      cell= target + stride * row;
+      *((double *)cell)= (double)myodbc_strtold(value, NULL);
+    }
+  }
+}
+
+
+/**
+  Column converter for everything without a dedicated converter. Runs the
+  regular sql_get_data() for each cell of the column.
+*/
+static void convert_column_generic(STMT *stmt, uint column, DESCREC *arrec,
+                                   uint rows)
+{
+  uint row;
+  uint field_count= stmt->result->field_count;
+
+  for (row= 0; row < rows; ++row)
+  {
+    char      *value= stmt->rowset.values[row][column];
+    ulong     length= stmt->rowset.lengths[row * field_count + column];
+    SQLLEN    *pcbValue= NULL;
+    SQLPOINTER TargetValuePtr= NULL;
+
+    reset_getdata_position(stmt);
+
+    if (arrec->data_ptr)
+    {
+      TargetValuePtr= ptr_offset_adjust(arrec->data_ptr,
+                                        stmt->ard->bind_offset_ptr,
+                                        stmt->ard->bind_type,
+                                        arrec->octet_length, row);
+    }
+
+    if (!length && value)
+    {
+      length= strlen(value);
+    }
+
+    if (arrec->octet_length_ptr)
+    {
+      pcbValue= ptr_offset_adjust(arrec->octet_length_ptr,
+                                  stmt->ard->bind_offset_ptr,
+                                  stmt->ard->bind_type,
+                                  sizeof(SQLLEN), row);
+    }
+
+    rowset_merge_res(&stmt->rowset.res[row],
+                     sql_get_data(stmt, arrec->concise_type, column,
+                                  TargetValuePtr, arrec->octet_length,
+                                  pcbValue, value, length, arrec));
+  }
+}
+
+
+static my_bool is_integer_field(MYSQL_FIELD *field)
+{
+  switch (field->type)
+  {
+  case MYSQL_TYPE_TINY:
+  case MYSQL_TYPE_SHORT:
+  case MYSQL_TYPE_LONG:
+  case MYSQL_TYPE_INT24:
+  case MYSQL_TYPE_LONGLONG:
+  case MYSQL_TYPE_YEAR:
+    return TRUE;
+  default:
+    return FALSE;
+  }
+}
+
+
+/**
+  Pick the converter for a (field type, ARD concise type) pair.
+
+  @return NULL if the column is not bound
+*/
+static MY_COLUMN_CONVERTER choose_column_converter(MYSQL_FIELD *field,
+                                                  DESCREC *arrec)
+{
+  if (!(ARD_IS_BOUND(arrec)))
+  {
+    return NULL;
+  }
+
+  switch (arrec->concise_type)
+  {
+  case SQL_C_TINYINT:
+  case SQL_C_STINYINT:
+  case SQL_C_UTINYINT:
+  case SQL_C_SHORT:
+  case SQL_C_SSHORT:
+  case SQL_C_USHORT:
+  case SQL_C_LONG:
+  case SQL_C_SLONG:
+  case SQL_C_ULONG:
+  case SQL_C_SBIGINT:
+  case SQL_C_UBIGINT:
+    if (is_integer_field(field))
+    {
+      return convert_column_integer;
+    }
+    break;
+
+  case SQL_C_FLOAT:
+  case SQL_C_DOUBLE:
+    if (is_integer_field(field) || field->type == MYSQL_TYPE_FLOAT
+     || field->type == MYSQL_TYPE_DOUBLE || field->type == MYSQL_TYPE_DECIMAL
+     || field->type == MYSQL_TYPE_NEWDECIMAL)
+    {
+      return convert_column_double;
+    }
+    break;
+  }
+
+  return convert_column_generic;
+}
+
+
+/**
+  Mark the conversion plan of the statement as outdated. Has to be called
+  whenever fields of the result are replaced. A new result can get the
+  address of a freed one, so the plan is for the result generation too.
+*/
+void invalidate_conversion_plan(STMT *stmt)
+{
+  ++stmt->result_generation;
+  stmt->plan.result= NULL;
+  stmt->plan.ard= NULL;
+}
+
+
+/**
+  Build column part of the conversion plan for the current result, unless
+  it is already built.
+
+  @return TRUE on allocation error
+*/
+static my_bool build_conversion_plan(STMT *stmt)
+{
+  MY_CONV_PLAN *plan= &stmt->plan;
+  uint i;
+
+  if (plan->result == stmt->result
+   && plan->result_generation == stmt->result_generation)
+  {
+    return FALSE;
+  }
+
+  if (stmt->result->field_count > plan->alloced)
+  {
+    MY_COLUMN_PLAN *columns= myodbc_realloc(plan->columns,
+                              sizeof(MY_COLUMN_PLAN) * stmt->result->field_count,
+                              MYF(MY_ALLOW_ZERO_PTR));
+    if (!columns)
+    {
+      return TRUE;
+    }
+
+    plan->columns= columns;
+    plan->alloced= stmt->result->field_count;
+  }
+
+  for (i= 0; i < stmt->result->field_count; ++i)
+  {
+    MY_COLUMN_PLAN *column= plan->columns + i;
+    MYSQL_FIELD    *field= mysql_fetch_field_direct(stmt->result, i);
+
+    column->field= field;
+    column->sql_type= get_sql_data_type(stmt, field, NULL);
+    column->default_c_type= unireg_to_c_datatype(field);
+    column->binhex= (field->flags & (BLOB_FLAG|BINARY_FLAG)) ==
+                      (BLOB_FLAG|BINARY_FLAG)
+                    && field->charsetnr == BINARY_CHARSET_NUMBER;
+    column->charset= get_charset(field->charsetnr ? field->charsetnr :
+                                 UTF8_CHARSET_NUMBER, MYF(0));
+    column->conv= NULL;
+  }
+
+  plan->count= stmt->result->field_count;
+  plan->result= stmt->result;
+  plan->result_generation= stmt->result_generation;
+  /* Converters have to be chosen for the new fields */
+  plan->ard= NULL;
+
+  return FALSE;
+}
+
+
+/**
+  Get conversion plan of a result column.
+
+  @return NULL on allocation error
+*/
+MY_COLUMN_PLAN *get_column_plan(STMT *stmt, uint column)
+{
+  if (build_conversion_plan(stmt))
+  {
+    return NULL;
+  }
+
+  assert(column < stmt->plan.count);
+  return stmt->plan.columns + column;
+}
+
+
+/**
+  Choose converters of bound columns if the ARD has changed since they
+  were chosen last time.
+
+  @return TRUE on allocation error
+*/
+my_bool bind_conversion_plan(STMT *stmt)
+{
+  MY_CONV_PLAN *plan= &stmt->plan;
+  uint i;
+
+  if (build_conversion_plan(stmt))
+  {
+    return TRUE;
+  }
+
+  if (plan->ard == stmt->ard && plan->ard_generation == stmt->ard->generation)
+  {
+    return FALSE;
+  }
+
+  for (i= 0; i < plan->count; ++i)
+  {
+    DESCREC *arrec= (SQLLEN)i < stmt->ard->count ?
+                    desc_get_rec(stmt->ard, i, FALSE) : NULL;
+
+    plan->columns[i].conv= choose_column_converter(plan->columns[i].field,
+                                                   arrec);
+  }
+
+  plan->ard= stmt->ard;
+  plan->ard_generation= stmt->ard->generation;
+
+  return FALSE;
+}
+
+
+/**
+  Check if the block of rows can be fetched with the columnar path. That is
+  possible only if row buffers stay valid until the whole block is fetched,
+  i.e. for text protocol results stored on the client side.
+*/
+static my_bool columnar_fetch_possible(STMT *stmt, SQLUSMALLINT fFetchType,
+                                       SQLULEN rows_to_fetch)
+{
+  return rows_to_fetch > 1 && !ssps_used(stmt) && !stmt->fix_fields
+      && !stmt->result_array && !stmt->fake_result && !if_forward_cache(stmt)
+      && !scroller_exists(stmt) && stmt->out_params_state == OPS_UNKNOWN
+      && !(fFetchType == SQL_FETCH_BOOKMARK &&
+           stmt->stmt_options.bookmarks == SQL_UB_VARIABLE);
+}
+
+
+/**
+  Make sure rowset buffers can hold the block of rows to be fetched.
+
+  @return TRUE on allocation error
+*/
+static my_bool rowset_reserve(STMT *stmt, uint rows)
+{
+  MY_ROWSET *rowset= &stmt->rowset;
+  uint columns= stmt->result->field_count;
+
+  if (rows > rowset->alloc_rows || columns > rowset->alloc_columns)
+  {
+    uint new_rows= myodbc_max(rows, rowset->alloc_rows);
+    uint new_columns= myodbc_max(columns, rowset->alloc_columns);
+    void *values, *lengths, *res;
+
+    values= myodbc_realloc(rowset->values, sizeof(MYSQL_ROW) * new_rows,
+                           MYF(MY_ALLOW_ZERO_PTR));
+    if (values)
+      rowset->values= values;
+    lengths= myodbc_realloc(rowset->lengths,
+                            sizeof(ulong) * new_rows * new_columns,
+                            MYF(MY_ALLOW_ZERO_PTR));
+    if (lengths)
+      rowset->lengths= lengths;
+    res= myodbc_realloc(rowset->res, sizeof(SQLRETURN) * new_rows,
+                        MYF(MY_ALLOW_ZERO_PTR));
+    if (res)
+      rowset->res= res;
+
+    if (!values || !lengths || !res)
+    {
+      return TRUE;
+    }
+
+    rowset->alloc_rows= new_rows;
+    rowset->alloc_columns= new_columns;
+  }
+
+  return FALSE;
+}
+
+
+/**
+  Remember a fetched row of the block for the columnar fill. The lengths are
+  taken from the IRD, as fill_fetch_buffers() does, so rows of a stored
+  result with lengths of their own (stmt->lengths) come out the same.
+*/
+static void rowset_add_row(STMT *stmt, uint rownum, MYSQL_ROW values)
+{
+  uint    i, columns= stmt->result->field_count;
+  ulong   *lengths= stmt->rowset.lengths + rownum * columns;
+  DESCREC *irrec;
+
+  stmt->rowset.values[rownum]= values;
+  stmt->rowset.res[rownum]= SQL_SUCCESS;
+
+  for (i= 0; i < columns; ++i)
+  {
+    irrec= desc_get_rec(stmt->ird, i, FALSE);
+    lengths[i]= irrec ? irrec->row.datalen : 0;
+  }
+}
+
+
+/**
+  Populate fetch buffers of the whole block column by column
+
+  @param[in]  stmt        Handle of statement
+  @param[in]  rows        Number of rows gathered with rowset_add_row()
+*/
+static void fill_fetch_buffers_columnar(STMT *stmt, uint rows)
+{
+  uint i;
+  uint columns= (uint)myodbc_min(stmt->ird->count, stmt->ard->count);
+  MY_COLUMN_PLAN *plan;
+
+  if (bind_conversion_plan(stmt))
+  {
+    for (i= 0; i < rows; ++i)
+    {
+      stmt->rowset.res[i]= set_error(stmt, MYERR_S1001, NULL, 4001);
+    }
+    return;
+  }
+
+  for (i= 0, plan= stmt->plan.columns; i < columns; ++i, ++plan)
+  {
+    if (plan->conv)
+    {
+      plan->conv(stmt, i, desc_get_rec(stmt->ard, i, FALSE), rows);
+    }
+  }
+}
+
+
+void free_rowset(STMT *stmt)
+{
+  x_free(stmt->rowset.values);
+  x_free(stmt->rowset.lengths);
+  x_free(stmt->rowset.res);
+  memset(&stmt->rowset, 0, sizeof(MY_ROWSET));
+
+  x_free(stmt->plan.columns);
+  memset(&stmt->plan, 0, sizeof(MY_CONV_PLAN));
+
+  x_free(stmt->row_index.rows);
+  memset(&stmt->row_index, 0, sizeof(MY_ROW_INDEX));
+}
+
+
+/**
+  Set status of a fetched row and fold it into the overall fetch result
+*/
+static void set_fetch_row_status(STMT *stmt, SQLULEN rownum,
+                                 SQLRETURN row_res, SQLRETURN row_book,
+                                 SQLRETURN *res, SQLUSMALLINT *rgfRowStatus,
+                                 my_bool upd_status)
+{
+  /* For SQL_SUCCESS we need all rows to be SQL_SUCCESS */
+  if (*res != row_res || *res != row_book)
+  {
+    /* Any successful row makes overall result SQL_SUCCESS_WITH_INFO */
+    if (SQL_SUCCEEDED(row_res) && SQL_SUCCEEDED(row_res))
+    {
+      *res= SQL_SUCCESS_WITH_INFO;
+    }
+    /* Else error */
+    else if (rownum == 0)
+    {
+      /* SQL_ERROR only if all rows fail */
+      *res= SQL_ERROR;
+    }
+    else
+    {
+      *res= SQL_SUCCESS_WITH_INFO;
+    }
+  }
+
+  /* "Fetching" includes buffers filling. I think errors in that
+     have to affect row status */
+
+  if (rgfRowStatus)
+  {
+    rgfRowStatus[rownum]= sqlreturn2row_status(row_res);
+  }
+  /*
+    No need to update rowStatusPtr_ex, it's the same as rgfRowStatus.
+  */
+  if (upd_status && stmt->ird->array_status_ptr)
+  {
+    stmt->ird->array_status_ptr[rownum]= sqlreturn2row_status(row_res);
+  }
+}
+
+
+/*
+  @type    : myodbc3 internal
+  @purpose : fetches the specified row from the result set and
+             returns data for all bound columns. Row can be specified
+             at an absolute or relative position
+*/
+SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
+                                       SQLUSMALLINT         fFetchType,
+                                       SQLLEN               irow,
+                                       SQLULEN             *pcrow,
+                                       SQLUSMALLINT        *rgfRowStatus,
+                                       my_bool              upd_status )
+{
+    SQLULEN           rows_to_fetch;
+    long              cur_row, max_row;
+    SQLRETURN         row_res, res;
+    STMT              *stmt= (STMT *) hstmt;
+    MYSQL_ROW         values= 0;
+    MYSQL_ROW_OFFSET  save_position= 0;
+    SQLULEN           dummy_pcrow;
+    BOOL              disconnected= FALSE;
+    long              brow= 0;
+
+    if ( !stmt->result )
+      return set_stmt_error(stmt, "24000", "Fetch without a SELECT", 0);
+
+    cur_row = stmt->current_row;
+
+    if ( !pcrow )
+      pcrow= &dummy_pcrow;
+
+    /* for scrollable cursor("scroller") max_row is max row for currently
+       fetched part of resultset */
+    max_row= (long) num_rows(stmt);
+    reset_getdata_position(stmt);
+    stmt->current_values= 0;          /* For SQLGetData */
+
+    switch ( fFetchType )
+    {
+      case SQL_FETCH_NEXT:
+        cur_row= (stmt->current_row < 0 ? 0 :
+                  stmt->current_row + stmt->rows_found_in_set);
+        break;
+      case SQL_FETCH_PRIOR:
+        cur_row= (stmt->current_row <= 0 ? -1 :
+                  (long)(stmt->current_row - stmt->ard->array_size));
+        break;
+      case SQL_FETCH_FIRST:
+        cur_row= 0L;
+        break;
+      case SQL_FETCH_LAST:
+        cur_row= max_row - stmt->ard->array_size;
+        break;
+      case SQL_FETCH_ABSOLUTE:
+        if (irow < 0)
+        {
+          /* Fetch from end of result set */
+          if ( max_row+irow < 0 && -irow <= (long) stmt->ard->array_size )
+          {
+            /*
+              | FetchOffset | > LastResultRow AND
+              | FetchOffset | <= RowsetSize
+            */
+            cur_row= 0;     /* Return from beginning */
+          }
+          else
+            cur_row= max_row + irow;     /* Ok if max_row <= -irow */
+        }
+        else
+          cur_row= (long) irow - 1;
+        break;
+
+      case SQL_FETCH_RELATIVE:
+        cur_row= stmt->current_row + irow;
+        if (stmt->current_row > 0 && cur_row < 0 &&
+           (long) - irow <= (long)stmt->ard->array_size)
+        {
+          cur_row= 0;
+        }
+        break;
+
+      case SQL_FETCH_BOOKMARK:
+        {
+          if (stmt->stmt_options.bookmark_ptr)
+          {
+            DESCREC *arrec;
+            IS_BOOKMARK_VARIABLE(stmt);
+            arrec= desc_get_rec(stmt->ard, -1, FALSE);
+
+            if (arrec->concise_type == SQL_C_BOOKMARK)
+            {
+              brow= *((SQLLEN *) stmt->stmt_options.bookmark_ptr);
+            }
+            else
+            {
+              brow= atol((SQLCHAR *) stmt->stmt_options.bookmark_ptr);
+            }
+          }
+
+          cur_row= brow + irow;
+          if (cur_row < 0 && (long)-irow <= (long)stmt->ard->array_size) 
+          {
+            cur_row= 0;
+          }
+        }
+        break;
+
+      default:
+          return set_error(stmt, MYERR_S1106, "Fetch type out of range", 0);
+    }
+
+    if ( cur_row < 0 )
+    {
+      stmt->current_row= -1;  /* Before first row */
+      stmt->rows_found_in_set= 0;
+      data_seek(stmt, 0L);
+      set_stmt_error(stmt, "01S07", "One or more row has error.", 0);
+      return SQL_SUCCESS_WITH_INFO; //SQL_NO_DATA_FOUND
+    }
     if ( cur_row > max_row )
     {
       if (scroller_exists(stmt))
@@ -1983,7 +2722,7 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
             set_stmt_error(stmt, "01S07", "One or more row has error.", 0);
             return SQL_SUCCESS_WITH_INFO; //SQL_NO_DATA_FOUND
           case SQL_ERROR:   return set_error(stmt,MYERR_S1000,
-                                            mysql_error(&stmt->dbc->mysql), 0);
+                                            mysql_error(stmt->dbc->mysql), 0);
         }
       }
       else
@@ -2041,14 +2780,10 @@ SQLRETURN SQL_API myodbc_single_fetch( SQLHSTMT             hstmt,
       }
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC, "C");
-    }
-
     res= SQL_SUCCESS;
     {
       save_position= row_tell(stmt);
+      ssps_bind_direct(stmt, (uint)cur_row);
       /* - Actual fetching happens here - */
       if (!(values= fetch_row(stmt)) )
       {
@@ -2132,7 +2867,7 @@ exitSQLSingleFetch:
     stmt->rows_found_in_set= 1;
     *pcrow= cur_row;
 
-    disconnected= is_connection_lost(mysql_errno(&stmt->dbc->mysql))
+    disconnected= is_connection_lost(mysql_errno(stmt->dbc->mysql))
       && handle_connection_error(stmt);
 
     if ( upd_status && stmt->ird->rows_processed_ptr )
@@ -2161,11 +2896,6 @@ exitSQLSingleFetch:
       stmt->end_of_set= row_seek(stmt, save_position);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC,default_locale);
-    }
-
     if (SQL_SUCCEEDED(res)
       && stmt->rows_found_in_set < stmt->ard->array_size)
     {
@@ -2208,6 +2938,7 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
     MYSQL_ROW_OFFSET  save_position= 0;
     SQLULEN           dummy_pcrow;
     BOOL              disconnected= FALSE;
+    my_bool           columnar;
     long              brow= 0;
 
     if ( !stmt->result )
@@ -2239,7 +2970,11 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
                           "Wrong fetchtype with FORWARD ONLY cursor", 0);
     }
 
-    if ( if_dynamic_cursor(stmt) && set_dynamic_result(stmt) )
+    /* Rows counted from the end depend on what the query gives now */
+    if ( if_dynamic_cursor(stmt) &&
+         (fFetchType == SQL_FETCH_LAST ||
+          (fFetchType == SQL_FETCH_ABSOLUTE && irow < 0)) &&
+         rerun_dynamic_query(stmt) )
       return set_error(stmt,MYERR_S1000,
                        "Driver Failed to set the internal dynamic result", 0);
 
@@ -2327,7 +3062,7 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
         {
           case SQL_NO_DATA: return SQL_NO_DATA_FOUND;
           case SQL_ERROR:   return set_error(stmt,MYERR_S1000,
-                                            mysql_error(&stmt->dbc->mysql), 0);
+                                            mysql_error(stmt->dbc->mysql), 0);
         }
       }
       else
@@ -2336,6 +3071,21 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       }
     }
 
+    /*
+      Values of the rowset of a dynamic cursor are refreshed by the keys of
+      its rows, the query runs again if the rowset leaves the keyset
+    */
+    if ( if_dynamic_cursor(stmt) )
+    {
+      if ( refresh_dynamic_rows(stmt, cur_row, (long)stmt->ard->array_size) )
+        return set_error(stmt,MYERR_S1000,
+                         "Driver Failed to set the internal dynamic result", 0);
+
+      max_row= (long) num_rows(stmt);
+      if ( cur_row > max_row )
+        cur_row= max_row;
+    }
+
     if ( !stmt->result_array && !if_forward_cache(stmt) )
     {
         /*
@@ -2383,10 +3133,8 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       }
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC, "C");
-    }
+    columnar= columnar_fetch_possible(stmt, fFetchType, rows_to_fetch)
+           && !rowset_reserve(stmt, (uint)rows_to_fetch);
 
     res= SQL_SUCCESS;
     for (i= 0 ; i < rows_to_fetch ; ++i)
@@ -2406,6 +3154,7 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
         {
             save_position= row_tell(stmt);
         }
+        ssps_bind_direct(stmt, (uint)i);
         /* - Actual fetching happens here - */
         if ( stmt->out_params_state == OPS_UNKNOWN
           && !(values= fetch_row(stmt)) )
@@ -2471,6 +3220,14 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
         }
       }
 
+      if (columnar)
+      {
+        /* Buffers are filled column by column once the block is fetched */
+        rowset_add_row(stmt, (uint)i, values);
+        ++cur_row;
+        continue;
+      }
+
       if (fFetchType == SQL_FETCH_BOOKMARK && 
            stmt->stmt_options.bookmarks == SQL_UB_VARIABLE)
       {
@@ -2478,48 +3235,29 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       }  
       row_res= fill_fetch_buffers(stmt, values, i);
 
-      /* For SQL_SUCCESS we need all rows to be SQL_SUCCESS */
-      if (res != row_res || res != row_book)
-      {
-        /* Any successful row makes overall result SQL_SUCCESS_WITH_INFO */
-        if (SQL_SUCCEEDED(row_res) && SQL_SUCCEEDED(row_res))
-        {
-          res= SQL_SUCCESS_WITH_INFO;
-        }
-        /* Else error */
-        else if (i == 0)
-        {
-          /* SQL_ERROR only if all rows fail */
-          res= SQL_ERROR;
-        }
-        else
-        {
-          res= SQL_SUCCESS_WITH_INFO;
-        }
-      }
+      set_fetch_row_status(stmt, i, row_res, row_book, &res, rgfRowStatus,
+                           upd_status);
 
-      /* "Fetching" includes buffers filling. I think errors in that 
-         have to affect row status */
+      ++cur_row;
+    }   /* fetching cycle end*/
 
-      if (rgfRowStatus)
-      {
-        rgfRowStatus[i]= sqlreturn2row_status(row_res);
-      }
-      /*
-        No need to update rowStatusPtr_ex, it's the same as rgfRowStatus.
-      */
-      if (upd_status && stmt->ird->array_status_ptr)
+    if (columnar)
+    {
+      SQLULEN rownum;
+
+      fill_fetch_buffers_columnar(stmt, (uint)i);
+
+      for (rownum= 0; rownum < i; ++rownum)
       {
-        stmt->ird->array_status_ptr[i]= sqlreturn2row_status(row_res);
+        set_fetch_row_status(stmt, rownum, stmt->rowset.res[rownum], row_book,
+                             &res, rgfRowStatus, upd_status);
       }
-
-      ++cur_row;
-    }   /* fetching cycle end*/
+    }
 
     stmt->rows_found_in_set= i;
     *pcrow= i;
 
-    disconnected= is_connection_lost(mysql_errno(&stmt->dbc->mysql))
+    disconnected= is_connection_lost(mysql_errno(stmt->dbc->mysql))
       && handle_connection_error(stmt);
 
     if ( upd_status && stmt->ird->rows_processed_ptr )
@@ -2551,11 +3289,6 @@ SQLRETURN SQL_API my_SQLExtendedFetch( SQLHSTMT             hstmt,
       stmt->end_of_set= row_seek(stmt, save_position);
     }
 
-    if (!stmt->dbc->ds->dont_use_set_locale)
-    {
-      setlocale(LC_NUMERIC,default_locale);
-    }
-
     if (SQL_SUCCEEDED(res)
       && stmt->rows_found_in_set < stmt->ard->array_size)
     {
@@ -2591,6 +3324,7 @@ SQLRETURN SQL_API SQLExtendedFetch( SQLHSTMT        hstmt,
     STMT_OPTIONS *options;
 
     CHECK_HANDLE(hstmt);
+    CHECK_ASYNC((STMT *)hstmt);
 
     options= &((STMT *)hstmt)->stmt_options;
     options->rowStatusPtr_ex= rgfRowStatus;
@@ -2604,21 +3338,17 @@ SQLRETURN SQL_API SQLExtendedFetch( SQLHSTMT        hstmt,
 
 
 /*
-  @type    : ODBC 3.0 API
+  @type    : myodbc3 internal
   @purpose : fetches the specified rowset of data from the result set and
   returns data for all bound columns. Rowsets can be specified
   at an absolute or relative position
 */
 
-SQLRETURN SQL_API SQLFetchScroll( SQLHSTMT      StatementHandle,
-                                  SQLSMALLINT   FetchOrientation,
-                                  SQLLEN        FetchOffset )
+static SQLRETURN fetch_scroll(STMT *stmt, SQLSMALLINT FetchOrientation,
+                              SQLLEN FetchOffset)
 {
-    STMT *stmt = (STMT *)StatementHandle;
     STMT_OPTIONS *options;
 
-    CHECK_HANDLE(stmt);
-
     options= &stmt->stmt_options;
     options->rowStatusPtr_ex= NULL;
 
@@ -2637,28 +3367,96 @@ SQLRETURN SQL_API SQLFetchScroll( SQLHSTMT      StatementHandle,
                        stmt->stmt_options.bookmark_ptr);
     }
 
-    return my_SQLExtendedFetch(StatementHandle, FetchOrientation, FetchOffset,
+    return my_SQLExtendedFetch(stmt, FetchOrientation, FetchOffset,
                                stmt->ird->rows_processed_ptr, stmt->ird->array_status_ptr,
                                0);
 }
 
+
+/* Arguments of SQLFetchScroll() run by a worker */
+typedef struct
+{
+  SQLSMALLINT orientation;
+  SQLLEN      offset;
+} MY_FETCH_SCROLL_ARGS;
+
+static SQLRETURN fetch_scroll_async(STMT *stmt)
+{
+  MY_FETCH_SCROLL_ARGS *args= (MY_FETCH_SCROLL_ARGS *)stmt->async.args;
+
+  return fetch_scroll(stmt, args->orientation, args->offset);
+}
+
+
 /*
-  @type    : ODBC 1.0 API
-  @purpose : fetches the next rowset of data from the result set and
-  returns data for all bound columns
+  Rows of a stored result are fetched without talking to the server, so
+  only fetches of a result being read go to a worker.
 */
+static BOOL fetch_in_background(STMT *stmt)
+{
+  return stmt->async.run != NULL ||
+         (async_requested(stmt) && stmt->result && if_forward_cache(stmt));
+}
 
-SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle)
+
+/*
+  @type    : ODBC 3.0 API
+  @purpose : fetches the specified rowset of data from the result set and
+  returns data for all bound columns. Rowsets can be specified
+  at an absolute or relative position
+*/
+
+SQLRETURN SQL_API SQLFetchScroll( SQLHSTMT      StatementHandle,
+                                  SQLSMALLINT   FetchOrientation,
+                                  SQLLEN        FetchOffset )
 {
     STMT *stmt = (STMT *)StatementHandle;
-    STMT_OPTIONS *options;
+    MY_FETCH_SCROLL_ARGS args;
+    SQLRETURN rc;
 
     CHECK_HANDLE(stmt);
 
+    if (fetch_in_background(stmt))
+    {
+      args.orientation= FetchOrientation;
+      args.offset=      FetchOffset;
+
+      if (async_call(stmt, fetch_scroll_async, &args, sizeof(args), &rc))
+        return rc;
+    }
+
+    return fetch_scroll(stmt, FetchOrientation, FetchOffset);
+}
+
+
+static SQLRETURN fetch_next(STMT *stmt)
+{
+    STMT_OPTIONS *options;
+
     options= &stmt->stmt_options;
     options->rowStatusPtr_ex= NULL;
 
-    return my_SQLExtendedFetch(StatementHandle, SQL_FETCH_NEXT, 0,
+    return my_SQLExtendedFetch(stmt, SQL_FETCH_NEXT, 0,
                                stmt->ird->rows_processed_ptr, stmt->ird->array_status_ptr,
                                0);
 }
+
+/*
+  @type    : ODBC 1.0 API
+  @purpose : fetches the next rowset of data from the result set and
+  returns data for all bound columns
+*/
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle)
+{
+    STMT *stmt = (STMT *)StatementHandle;
+    SQLRETURN rc;
+
+    CHECK_HANDLE(stmt);
+
+    if (fetch_in_background(stmt) &&
+        async_call(stmt, fetch_next, NULL, 0, &rc))
+      return rc;
+
+    return fetch_next(stmt);
+}
@@ -69,12 +69,13 @@ static SQLRETURN my_transact(SQLHDBC hdbc, SQLSMALLINT CompletionType)
     MYLOG_DBC_QUERY(dbc, query);
 
     myodbc_mutex_lock(&dbc->lock);
+    readahead_pause(dbc);
     if (check_if_server_is_alive(dbc) ||
-	mysql_real_query(&dbc->mysql,query,length))
+	mysql_real_query(dbc->mysql,query,length))
     {
       result= set_conn_error(hdbc,MYERR_S1000,
-			     mysql_error(&dbc->mysql),
-			     mysql_errno(&dbc->mysql));
+			     mysql_error(dbc->mysql),
+			     mysql_errno(dbc->mysql));
     }
     myodbc_mutex_unlock(&dbc->lock);
   }
@@ -280,7 +280,7 @@ SQLDescribeColW(SQLHSTMT hstmt, SQLUSMALLINT column,
 
   if (free_value == -1)
   {
-    set_mem_error(&stmt->dbc->mysql);
+    set_mem_error(stmt->dbc->mysql);
     return handle_connection_error(stmt);
   }
 
@@ -292,7 +292,7 @@ SQLDescribeColW(SQLHSTMT hstmt, SQLUSMALLINT column,
     {
       if (free_value)
         x_free(value);
-      set_mem_error(&stmt->dbc->mysql);
+      set_mem_error(stmt->dbc->mysql);
       return handle_connection_error(stmt);
     }
 
@@ -350,13 +350,32 @@ SQLErrorW(SQLHENV henv, SQLHDBC hdbc, SQLHSTMT hstmt, SQLWCHAR *sqlstate,
 }
 
 
+/* SQLExecDirectW() run by a worker, the query is in stmt->async.args */
+static SQLRETURN exec_direct_async(STMT *stmt)
+{
+  SQLRETURN rc= SQLPrepareWImpl(stmt, (SQLWCHAR *)stmt->async.args,
+                                (SQLINTEGER)(stmt->async.args_length /
+                                             sizeof(SQLWCHAR)));
+
+  return rc ? rc : my_SQLExecute(stmt);
+}
+
+
 SQLRETURN SQL_API
 SQLExecDirectW(SQLHSTMT hstmt, SQLWCHAR *str, SQLINTEGER str_len)
 {
   int error;
+  SQLRETURN rc;
 
   CHECK_HANDLE(hstmt);
 
+  if (str && (str_len == SQL_NTS || str_len > 0) &&
+      async_requested((STMT *)hstmt) &&
+      async_call((STMT *)hstmt, exec_direct_async, str,
+                 (str_len == SQL_NTS ? sqlwcharlen(str) : (size_t)str_len)
+                 * sizeof(SQLWCHAR), &rc))
+    return rc;
+
   if ((error= SQLPrepareWImpl(hstmt, str, str_len)))
     return error;
   error= my_SQLExecute((STMT *)hstmt);
@@ -529,6 +548,7 @@ SQLGetCursorNameW(SQLHSTMT hstmt, SQLWCHAR *cursor, SQLSMALLINT cursor_max,
   uint errors;
 
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC(stmt);
 
   CLEAR_STMT_ERROR(stmt);
 
@@ -843,6 +863,7 @@ SQLRETURN SQL_API
 SQLPrepareW(SQLHSTMT hstmt, SQLWCHAR *str, SQLINTEGER str_len)
 {
   CHECK_HANDLE(hstmt);
+  CHECK_ASYNC((STMT *)hstmt);
 
   return SQLPrepareWImpl(hstmt, str, str_len);
 }
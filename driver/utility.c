@@ -30,6 +30,11 @@
 #include "driver.h"
 #include "errmsg.h"
 #include <ctype.h>
+#include <math.h>
+#include <locale.h>
+#ifdef __APPLE__
+# include <xlocale.h>
+#endif
 
 
 #define DATETIME_DIGITS 14
@@ -88,11 +93,13 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
     query_length= strlen(query);
   }
 
+  readahead_pause(dbc);
+
   if ( check_if_server_is_alive(dbc) ||
-       mysql_real_query(&dbc->mysql, query, query_length) )
+       mysql_real_query(dbc->mysql, query, query_length) )
   {
-    result= set_conn_error(dbc,MYERR_S1000,mysql_error(&dbc->mysql),
-                           mysql_errno(&dbc->mysql));
+    result= set_conn_error(dbc,MYERR_S1000,mysql_error(dbc->mysql),
+                           mysql_errno(dbc->mysql));
   }
 
   if (req_lock)
@@ -115,13 +122,12 @@ SQLRETURN odbc_stmt(DBC *dbc, const char *query,
 void myodbc_link_fields(STMT *stmt, MYSQL_FIELD *fields, uint field_count)
 {
     MYSQL_RES *result;
-    myodbc_mutex_lock(&stmt->dbc->lock);
+    /* Nothing goes over the wire, the connection is not locked */
     result= stmt->result;
     result->fields= fields;
     result->field_count= field_count;
     result->current_field= 0;
     fix_result_types(stmt);
-    myodbc_mutex_unlock(&stmt->dbc->lock);
 }
 
 
@@ -170,8 +176,11 @@ void fix_result_types(STMT *stmt)
   DESCREC *irrec;
   MYSQL_FIELD *field;
   int capint32= stmt->dbc->ds->limit_column_size ? 1 : 0;
+  char *catalog= NULL;
+  char catalog_buff[NAME_LEN + 1];
 
   stmt->state= ST_EXECUTED;  /* Mark set found */
+  invalidate_conversion_plan(stmt);
 
   /* Populate the IRD records */
   for (i= 0; i < field_count(stmt); ++i)
@@ -260,7 +269,13 @@ void fix_result_types(STMT *stmt)
     }
     else
     {
-      irrec->catalog_name= (SQLCHAR *)(stmt->dbc->database ? stmt->dbc->database : "");
+      /* The statement has its own copy of the current database name */
+      if (catalog == NULL)
+      {
+        catalog= strdup_root(&stmt->alloc_root,
+                             current_catalog_copy(stmt->dbc, catalog_buff, ""));
+      }
+      irrec->catalog_name= (SQLCHAR *)(catalog ? catalog : "");
     }
 
     irrec->fixed_prec_scale= SQL_FALSE;
@@ -753,15 +768,36 @@ convert_to_out:
 }
 
 
+/**
+  Check if bytes below 0x80 of a character set are plain ASCII characters,
+  so they can be stored as SQLWCHAR without looking the character up.
+*/
+static my_bool charset_ascii_compatible(CHARSET_INFO *cs)
+{
+  if (cs->mbminlen != 1)
+    return FALSE;
+
+#ifdef MY_CS_NONASCII
+  return !(cs->state & MY_CS_NONASCII);
+#else
+  return strcmp(cs->csname, "swe7") != 0;
+#endif
+}
+
+
 /**
   Copy a result from the server into a buffer as a SQL_C_WCHAR.
 
+  Runs of 7-bit characters of ASCII compatible character sets are copied
+  as they are, everything else is decoded by the character set and stored
+  as UTF-16 (or UTF-32) directly.
+
   @param[in]     stmt        Pointer to statement
   @param[out]    result      Buffer for result
   @param[in]     result_len  Size of result buffer (in characters)
   @param[out]    avail_bytes Pointer to buffer for storing amount of data
                              available before this call
-  @param[in]     field       Field being stored
+  @param[in]     from_cs     Character set of the source data
   @param[in]     src         Source data for result
   @param[in]     src_bytes   Length of source data (in bytes)
 
@@ -770,20 +806,23 @@ convert_to_out:
 SQLRETURN
 copy_wchar_result(STMT *stmt,
                   SQLWCHAR *result, SQLINTEGER result_len, SQLLEN *avail_bytes,
-                  MYSQL_FIELD *field, char *src, long src_bytes)
+                  CHARSET_INFO *from_cs, char *src, long src_bytes)
 {
   SQLRETURN rc= SQL_SUCCESS;
   char *src_end;
   SQLWCHAR *result_end;
   ulong used_chars= 0, error_count= 0;
-  CHARSET_INFO *from_cs= get_charset(field->charsetnr ? field->charsetnr :
-                                     UTF8_CHARSET_NUMBER,
-                                     MYF(0));
+  my_bool ascii;
+  int (*mb_wc)(struct charset_info_st *, my_wc_t *, const uchar *,
+               const uchar *);
 
   if (!from_cs)
     return set_stmt_error(stmt, "07006", "Source character set not "
     "supported by client", 0);
 
+  mb_wc= from_cs->cset->mb_wc;
+  ascii= charset_ascii_compatible(from_cs);
+
   if (!result_len)
     result= NULL; /* Don't copy anything! */
 
@@ -830,17 +869,44 @@ copy_wchar_result(STMT *stmt,
 
   while (src < src_end)
   {
-    /* Find the conversion functions. */
-    int (*mb_wc)(struct charset_info_st *, my_wc_t *, const uchar *,
-                 const uchar *) = from_cs->cset->mb_wc;
-    int (*wc_mb)(struct charset_info_st *, my_wc_t, uchar *s,
-                 uchar *e)= utf8_charset_info->cset->wc_mb;
     my_wc_t wc;
-    uchar u8[5]; /* Max length of utf-8 string we'll see. */
-    SQLWCHAR dummy[2]; /* If SQLWCHAR is UTF-16, we may need two chars. */
-    int to_cnvres;
+    int cnvres;
 
-    int cnvres= (*mb_wc)(from_cs, &wc, (uchar *)src, (uchar *)src_end);
+    /*
+      Once the buffer is full the rest only has to be scanned on the first
+      call, when the total length is not known yet.
+    */
+    if (!result && result_len && stmt->getdata.dst_bytes != (ulong)~0L)
+      break;
+
+    if (ascii && !((uchar)*src & 0x80))
+    {
+      char *run= src;
+
+      if (result)
+      {
+        while (src < src_end && result < result_end && !((uchar)*src & 0x80))
+          *result++= (SQLWCHAR)(uchar)*src++;
+
+        stmt->getdata.source+= src - run;
+
+        if (result == result_end)
+        {
+          *result= 0;
+          result= NULL;
+        }
+      }
+      else
+      {
+        while (src < src_end && !((uchar)*src & 0x80))
+          ++src;
+      }
+
+      used_chars+= src - run;
+      continue;
+    }
+
+    cnvres= (*mb_wc)(from_cs, &wc, (uchar *)src, (uchar *)src_end);
     if (cnvres == MY_CS_ILSEQ)
     {
       ++error_count;
@@ -858,78 +924,53 @@ copy_wchar_result(STMT *stmt,
                             "Unknown failure when converting character "
                             "from server character set.", 0);
 
-convert_to_out:
-    /*
-     We always convert into a temporary buffer, so we can properly handle
-     characters that are going to get split across requests.
-    */
-    to_cnvres= (*wc_mb)(utf8_charset_info, wc, u8, u8 + sizeof(u8));
-
-    if (to_cnvres > 0)
+    /* Not a character that can be stored as UTF-16 */
+    if ((wc >= 0xD800 && wc <= 0xDFFF) || wc > 0x10FFFF)
     {
-      u8[to_cnvres]= '\0';
+      ++error_count;
+      wc= '?';
+    }
 
-      src+= cnvres;
+    src+= cnvres;
 
-      if (sizeof(SQLWCHAR) == 4)
+    if (sizeof(SQLWCHAR) == 4 || wc < 0x10000)
+    {
+      if (result)
       {
-        utf8toutf32(u8, (UTF32 *)(result ? result : dummy));
-        if (result)
-          ++result;
-        used_chars+= 1;
+        *result++= (SQLWCHAR)wc;
+        stmt->getdata.source+= cnvres;
       }
-      else
-      {
-        UTF32 u32;
-        UTF16 out[2];
-        int chars;
-        utf8toutf32(u8, &u32);
-        chars= utf32toutf16(u32, (UTF16 *)out);
+      used_chars+= 1;
+    }
+    else
+    {
+      UTF16 out[2];
 
-        if (result)
-          *result++= out[0];
+      utf32toutf16((UTF32)wc, out);
+      used_chars+= 2;
 
-        used_chars+= chars;
+      if (result)
+      {
+        *result++= out[0];
+        stmt->getdata.source+= cnvres;
 
-        if (chars > 1 && result && result != result_end)
+        if (result != result_end)
           *result++= out[1];
-        else if (chars > 1 && result)
+        else
         {
+          /* The pair is split, 2nd half is returned by the next call */
           *((SQLWCHAR *)stmt->getdata.latest)= out[1];
-          stmt->getdata.latest_bytes= 2;
+          stmt->getdata.latest_bytes= sizeof(SQLWCHAR);
           stmt->getdata.latest_used= 0;
-          *result= 0;
-          result= NULL;
-
-          if (stmt->getdata.dst_bytes != (ulong)~0L)
-          {
-            stmt->getdata.source+= cnvres;
-            break;
-          }
         }
-        else if (chars > 1)
-          continue;
-      }
-
-      if (result)
-        stmt->getdata.source+= cnvres;
-
-      if (result && result == result_end)
-      {
-        *result= 0;
-        result= NULL;
       }
     }
-    else if (stmt->getdata.latest_bytes == MY_CS_ILUNI && wc != '?')
+
+    if (result && result == result_end)
     {
-      ++error_count;
-      wc= '?';
-      goto convert_to_out;
+      *result= 0;
+      result= NULL;
     }
-    else
-      return set_stmt_error(stmt, "HY000",
-                            "Unknown failure when converting character "
-                            "to result character set.", 0);
   }
 
   if (result)
@@ -2259,17 +2300,24 @@ ulong str_to_time_as_long(const char *str, uint length)
 /*
   @type    : myodbc internal
   @purpose : if there was a long time since last question, check that
-  the server is up with mysql_ping (to force a reconnect)
+  the server is up with mysql_ping (to force a reconnect). Only done with
+  LIVENESS_CHECK=0, the default, otherwise a lost connection is found by
+  the query.
 */
 
 int check_if_server_is_alive( DBC *dbc )
 {
-    time_t seconds= (time_t) time( (time_t*)0 );
+    time_t seconds;
     int result= 0;
 
+    if (dbc->ds == NULL || dbc->ds->liveness_check != LIVENESS_CHECK_PING)
+      return 0;
+
+    seconds= (time_t) time( (time_t*)0 );
+
     if ( (ulong)(seconds - dbc->last_query_time) >= CHECK_IF_ALIVE )
     {
-        if ( mysql_ping( &dbc->mysql ) )
+        if ( mysql_ping( readahead_yield(dbc) ) )
         {
             /*  BUG: 14639
 
@@ -2286,7 +2334,7 @@ int check_if_server_is_alive( DBC *dbc )
                 PAH - 9.MAR.06
             */
             
-            if ( mysql_errno( &dbc->mysql ) == CR_SERVER_LOST )
+            if ( mysql_errno( dbc->mysql ) == CR_SERVER_LOST )
                 result = 1;
         }
     }
@@ -2324,40 +2372,55 @@ my_bool dynstr_append_quoted_name(DYNAMIC_STRING *str, const char *name)
 
 my_bool reget_current_catalog(DBC *dbc)
 {
-    x_free(dbc->database);
-    dbc->database= NULL;
+    MYSQL_RES *res;
+    MYSQL_ROW row;
+    char      *database= NULL;
+
+    /* The result has to be read before anything else goes over the wire */
+    myodbc_mutex_lock(&dbc->lock);
 
-    if ( odbc_stmt(dbc, "select database()", SQL_NTS, TRUE) )
+    if ( odbc_stmt(dbc, "select database()", SQL_NTS, FALSE) )
     {
+        myodbc_mutex_unlock(&dbc->lock);
         return 1;
     }
-    else
-    {
-        MYSQL_RES *res;
-        MYSQL_ROW row;
 
-        if ( (res= mysql_store_result(&dbc->mysql)) &&
-             (row= mysql_fetch_row(res)) )
-        {
-/*            if (cmp_database(row[0], dbc->database)) */
-            {
-                if ( row[0] )
-                {
-                    dbc->database = myodbc_strdup(row[0], MYF(MY_WME));
-                }
-                else
-                {
-                    dbc->database = NULL;
-                }
-            }
-        }
-        mysql_free_result(res);
+    if ( (res= mysql_store_result(dbc->mysql)) &&
+         (row= mysql_fetch_row(res)) && row[0] )
+    {
+        database= myodbc_strdup(row[0], MYF(MY_WME));
     }
+    mysql_free_result(res);
+
+    myodbc_mutex_lock(&dbc->session_lock);
+    x_free(dbc->database);
+    dbc->database= database;
+    myodbc_mutex_unlock(&dbc->session_lock);
+
+    myodbc_mutex_unlock(&dbc->lock);
 
     return 0;
 }
 
 
+/*
+  @type    : myodbc3 internal
+  @purpose : copies the current database name to the buffer of NAME_LEN + 1
+             bytes, or the string none if there is no current database. The
+             name can be replaced by another thread once session_lock is
+             released, so it is never used without a copy
+*/
+
+char * current_catalog_copy(DBC *dbc, char *to, const char *none)
+{
+    myodbc_mutex_lock(&dbc->session_lock);
+    strmake(to, dbc->database ? dbc->database : none, NAME_LEN);
+    myodbc_mutex_unlock(&dbc->session_lock);
+
+    return to;
+}
+
+
 /*
   @type    : myodbc internal
   @purpose : compare strings without regarding to case
@@ -2719,8 +2782,8 @@ void sqlnum_from_str(const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
   int build_up[8], tmp_prec_calc[8];
   /* current segment as integer */
   unsigned int curnum;
-  /* current segment digits copied for strtoul() */
-  char curdigs[5];
+  /* current position in the segment */
+  const char *digit;
   /* number of digits in current segment */
   int usedig;
   int i;
@@ -2764,11 +2827,12 @@ void sqlnum_from_str(const char *numstr, SQL_NUMERIC_STRUCT *sqlnum,
       break;
     else */if (overflow)
       /*continue;*/goto end;
-    /* grab just this piece, and convert to int */
-    memcpy(curdigs, numstr + i, usedig);
-    curdigs[usedig]= 0;
-    curnum= strtoul(curdigs, NULL, 10);
-    if (curdigs[usedig - 1] == '.')
+    /* convert just this piece to int, decimal point ends it */
+    for (curnum= 0, digit= numstr + i;
+         digit < numstr + i + usedig && *digit >= '0' && *digit <= '9';
+         ++digit)
+      curnum= curnum * 10 + (*digit - '0');
+    if (numstr[i + usedig - 1] == '.')
       sqlnum_scale(build_up, usedig - 1);
     else
       sqlnum_scale(build_up, usedig);
@@ -3056,17 +3120,17 @@ SQLRETURN set_sql_select_limit(DBC *dbc, SQLULEN lim_value, my_bool req_lock)
   SQLRETURN rc;
 
   /* Both 0 and max(SQLULEN) value mean no limit and sql_select_limit to DEFAULT */
+  if (lim_value == sql_select_unlimited)
+    lim_value= 0;
+
   if (lim_value == dbc->sql_select_limit
-   || lim_value == sql_select_unlimited && dbc->sql_select_limit == 0)
+   || lim_value == 0 && dbc->sql_select_limit == sql_select_unlimited)
     return SQL_SUCCESS;
 
-  if (lim_value > 0 && lim_value < sql_select_unlimited)
+  if (lim_value > 0)
     sprintf(query, "set @@sql_select_limit=%lu", (unsigned long)lim_value);
   else
-  {
     strcpy(query, "set @@sql_select_limit=DEFAULT");
-    lim_value= 0;
-  }
 
   if (SQL_SUCCEEDED(rc= odbc_stmt(dbc, query, SQL_NTS, req_lock)))
   {
@@ -3077,6 +3141,41 @@ SQLRETURN set_sql_select_limit(DBC *dbc, SQLULEN lim_value, my_bool req_lock)
 }
 
 
+/**
+  Get the largest packet the server accepts. It is read from the server on
+  the first call for the connection.
+
+  @param[in]  dbc         dbc handler
+
+  Returns the value of @@max_allowed_packet, 0 if it could not be read
+*/
+ulong get_max_allowed_packet(DBC *dbc)
+{
+  if (dbc->max_allowed_packet == 0)
+  {
+    MYSQL_RES *res;
+    MYSQL_ROW  row;
+
+    myodbc_mutex_lock(&dbc->lock);
+
+    if (odbc_stmt(dbc, "SELECT @@max_allowed_packet", SQL_NTS, FALSE)
+          == SQL_SUCCESS
+        && (res= mysql_store_result(dbc->mysql)))
+    {
+      if ((row= mysql_fetch_row(res)) && row[0])
+      {
+        dbc->max_allowed_packet= strtoul(row[0], NULL, 10);
+      }
+      mysql_free_result(res);
+    }
+
+    myodbc_mutex_unlock(&dbc->lock);
+  }
+
+  return dbc->max_allowed_packet;
+}
+
+
 /**
   Detects the parameter type.
 
@@ -3664,7 +3763,7 @@ void set_row_count(STMT *stmt, my_ulonglong rows)
   if (stmt != NULL && stmt->result != NULL)
   {
     stmt->result->row_count= rows;
-    stmt->dbc->mysql.affected_rows= rows;
+    stmt->dbc->mysql->affected_rows= rows;
   }
 }
 
@@ -3799,51 +3898,179 @@ char * complete_timestamp(const char * value, ulong length, char buff[21])
 }
 
 
-/*
-  HPUX has some problems with long double : http://docs.hp.com/en/B3782-90716/ch02s02.html
-
-  strtold() has implementations that return struct long_double, 128bit one,
-  which contains four 32bit words.
-  Fix described :
-  --------
-  union {
-	long_double l_d;
-	long double ld;
-  } u;
-  // convert str to a long_double; store return val in union
-  //(Putting value into union enables converted value to be
-  // accessed as an ANSI C long double)
-  u.l_d = strtold( (const char *)str, (char **)NULL);
-  --------
-  reinterpret_cast doesn't work :(
+/* Exact powers of ten, for the fast path of myodbc_strtold() */
+static const double exact_pow10[]=
+{
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* "C" numeric locale, for conversions the application locale must not
+   change */
+#ifdef _WIN32
+static _locale_t c_numeric_locale= NULL;
+#else
+static locale_t  c_numeric_locale= (locale_t)0;
+#endif
+
+
+void numeric_locale_init(void)
+{
+#ifdef _WIN32
+  c_numeric_locale= _create_locale(LC_NUMERIC, "C");
+#else
+  c_numeric_locale= newlocale(LC_NUMERIC_MASK, "C", (locale_t)0);
+#endif
+}
+
+
+void numeric_locale_end(void)
+{
+  if (c_numeric_locale)
+  {
+#ifdef _WIN32
+    _free_locale(c_numeric_locale);
+#else
+    freelocale(c_numeric_locale);
+#endif
+  }
+  c_numeric_locale= 0;
+}
+
+
+/**
+  strtold() in the "C" locale. The locale is switched for the calling
+  thread only, other threads of the application are not affected.
 */
-long double myodbc_strtold(const char *nptr, char **endptr)
+static long double strtold_c(const char *nptr, char **endptr)
 {
-/*
- * Experienced odd compilation errors on one of windows build hosts -
- * cmake reported there is strold function. Since double and long double on windows
- * are of the same size - we are using strtod on those platforms regardless
- * to the HAVE_FUNCTION_STRTOLD value
- */
 #ifdef _WIN32
-  return strtod(nptr, endptr);
+  /* long double is double with MSVC */
+  return _strtod_l(nptr, endptr, c_numeric_locale);
 #else
-# ifndef HAVE_FUNCTION_STRTOLD
-	return strtod(nptr, endptr);
-# else
-#  if defined(__hpux) && defined(_LONG_DOUBLE)
-	union {
-		long_double l_d;
-		long double ld;
-	} u;
-	u.l_d = strtold( nptr, endptr);
-	return u.ld;
-#  else
-	return strtold(nptr, endptr);
-#  endif
-# endif
+  locale_t    prev= uselocale(c_numeric_locale);
+  long double value= strtold(nptr, endptr);
+
+  uselocale(prev);
+  return value;
 #endif
+}
+
+
+/**
+  Convert a string to a floating point number. Decimal point is always '.'
+  whatever the locale of the application is, so no setlocale() is needed
+  around the call.
+
+  Plain decimal numbers with up to 15 digits are converted directly,
+  both the digits and the power of ten are exact in that case, so the
+  division gives correctly rounded result. Everything else, including
+  exponents, infinity, NaN and hexadecimal numbers, goes to strtold() in
+  the "C" locale, so the precision of long double is kept.
+
+  @param[in]  nptr    Nul-terminated string to convert
+  @param[out] endptr  If not NULL, the first character not converted
+
+  @return The converted number
+*/
+long double myodbc_strtold(const char *nptr, char **endptr)
+{
+  const char  *start, *pos;
+  ulonglong   mantissa= 0;
+  int         digits= 0, frac_digits= 0, error;
+  my_bool     negative= FALSE, seen_point= FALSE;
+  char        *end;
+  long double value;
+
+  for (start= nptr; *start == ' ' || *start == '\t'; ++start);
+
+  pos= start;
+  if (*pos == '-' || *pos == '+')
+    negative= *pos++ == '-';
+
+  for (;; ++pos)
+  {
+    if (*pos >= '0' && *pos <= '9')
+    {
+      if (++digits > DBL_DIG)
+        break;
+      mantissa= mantissa * 10 + (*pos - '0');
+      frac_digits+= seen_point;
+    }
+    else if (*pos == '.' && !seen_point)
+      seen_point= TRUE;
+    else
+      break;
+  }
+
+  /* "0x" is the prefix of a hexadecimal number */
+  if (digits > 0 && digits <= DBL_DIG && *pos != 'e' && *pos != 'E'
+   && *pos != 'x' && *pos != 'X')
+  {
+    value= (long double)mantissa / exact_pow10[frac_digits];
+    end= (char *)pos;
 
+    if (negative)
+      value= -value;
+  }
+  else if (c_numeric_locale)
+  {
+    value= strtold_c(start, &end);
+  }
+  else
+  {
+    /* No "C" locale, at least decimal numbers are converted right */
+    end= (char *)start + strlen(start);
+    value= my_strtod(start, &end, &error);
+  }
+
+  if (endptr)
+    *endptr= end;
+
+  return value;
+}
+
+
+/**
+  Locale independent string representation of a floating point number, in
+  the form the server parses.
+
+  @param[in]  value       Number to convert
+  @param[out] buff        Buffer for the result, at least
+                          MY_GCVT_MAX_FIELD_WIDTH + 1 bytes
+  @param[in]  exact_numeric  Round to DBL_DIG + 1 significant digits, used
+                             for exact numeric targets. Otherwise the result
+                             is the shortest string that converts back to
+                             the same double.
+
+  @return Length of the result, 0 if value is infinity or NaN
+*/
+size_t myodbc_d2str(double value, char *buff, my_bool exact_numeric)
+{
+  my_bool error;
+  size_t  length;
+
+  /* Only infinity and NaN give something but 0 here */
+  if (value - value != 0.0)
+  {
+    *buff= '\0';
+    return 0;
+  }
+
+  if (exact_numeric && value != 0.0)
+  {
+    int precision= DBL_DIG - (int)floor(log10(fabs(value)));
+
+    if (precision >= 0 && precision < NOT_FIXED_DEC)
+    {
+      return my_fcvt(value, precision, buff, &error);
+    }
+  }
+
+  length= my_gcvt(value, MY_GCVT_ARG_DOUBLE, MY_GCVT_MAX_FIELD_WIDTH, buff,
+                  &error);
+
+  return error ? 0 : length;
 }
 
 
@@ -3883,6 +4110,30 @@ char *add_to_buffer(NET *net,char *to,const char *from,ulong length)
     return to+length;
 }
 
+
+/**
+  Returns the buffer of the statement to build queries with parameters in.
+  It is kept for the next executions, and is allocated at the first use.
+
+  @return NULL if the buffer could not be allocated
+*/
+NET * stmt_query_net(STMT *stmt)
+{
+  NET *net= &stmt->query_net;
+
+  if (net->buff == NULL)
+  {
+    net->max_packet_size= stmt->dbc->mysql->net.max_packet_size;
+    if (myodbc_net_realloc(net, myodbc_max(stmt->dbc->net_buffer_len,
+                                           IO_SIZE)))
+    {
+      return NULL;
+    }
+  }
+
+  return net;
+}
+
 /*
   Get the offset and row numbers from a string with LIMIT
 
@@ -4098,7 +4349,7 @@ int get_session_variable(STMT *stmt, const char *var, char *result)
       return 0;
     }
 
-    res= mysql_store_result(&stmt->dbc->mysql);
+    res= mysql_store_result(stmt->dbc->mysql);
     if (!res)
       return 0;
 
@@ -4118,42 +4369,191 @@ int get_session_variable(STMT *stmt, const char *var, char *result)
 
 
 /**
-  Sets the value of @@max_execution_time
+  Sets the query timeout of the statement. It is applied when the statement
+  is executed, see add_limit_hints() and set_max_execution_time(). Where the
+  server can not enforce it, the driver kills the query, see cancel.c.
 
   @param[in]  stmt        stmt handler
-  @param[in]  new_value   Value to set @@max_execution_time.
-
-  Returns new_value if operation was successful, -1 otherwise
+  @param[in]  new_value   Timeout in seconds, 0 for no timeout
  */
 SQLRETURN set_query_timeout(STMT *stmt, SQLULEN new_value)
 {
-  char query[44];
-  SQLRETURN rc= SQL_SUCCESS;
+  stmt->stmt_options.query_timeout= new_value;
 
-  if (new_value == stmt->stmt_options.query_timeout ||
-      !is_minimum_version(stmt->dbc->mysql.server_version, "5.7.8"))
-  {
-    /* Do nothing if setting same timeout or MySQL server older than 5.7.8 */
+  return SQL_SUCCESS;
+}
+
+
+/**
+  Sets the value of @@max_execution_time for the session, unless it already
+  has that value.
+
+  @param[in]  dbc         dbc handler
+  @param[in]  timeout     Query timeout in seconds. 0 and (SQLULEN)-1 mean
+                          no timeout and @@max_execution_time to DEFAULT
+  @param[in]  req_lock    The flag if dbc->lock thread lock should be used
+                          when executing a query
+ */
+SQLRETURN set_max_execution_time(DBC *dbc, SQLULEN timeout, my_bool req_lock)
+{
+  char query[48];
+  SQLRETURN rc;
+
+  if (timeout == (SQLULEN)-1)
+    timeout= 0;
+
+  if (timeout == dbc->max_execution_time
+   || !is_minimum_version(dbc->mysql->server_version, "5.7.8"))
     return SQL_SUCCESS;
+
+  if (timeout > 0)
+    sprintf(query, "set @@max_execution_time=%llu",
+            (unsigned long long)timeout * 1000);
+  else
+    strcpy(query, "set @@max_execution_time=DEFAULT");
+
+  if (SQL_SUCCEEDED(rc= odbc_stmt(dbc, query, SQL_NTS, req_lock)))
+  {
+    dbc->max_execution_time= timeout;
+  }
+
+  return rc;
+}
+
+
+/**
+  Puts max rows and query timeout of the statement into an optimizer hint
+  right after the SELECT keyword, so the limits come with the query itself
+  instead of being set in session variables. SET_VAR() needs MySQL 8.0.3,
+  MAX_EXECUTION_TIME() needs 5.7.8. Comments and opening parentheses before
+  the SELECT keyword are skipped, queries that do not start with it are
+  left as they are. The server reads only the first hint comment after
+  SELECT, so if the query has one the limits are added at its end, after
+  the hints of the application, which take precedence over them.
+
+  @param[in]      stmt          stmt handler
+  @param[in]      query         Query to execute
+  @param[in,out]  query_length  Length of the query
+  @param[out]     hinted        HINT_SELECT_LIMIT and HINT_EXECUTION_TIME
+                                flags of the limits added
+
+  @return The new query, or NULL if there is nothing to add or on error
+ */
+char * add_limit_hints(STMT *stmt, const char *query, SQLULEN *query_length,
+                       uint *hinted)
+{
+  const char *server_version= stmt->dbc->mysql->server_version;
+  SQLULEN     max_rows= stmt->stmt_options.max_rows,
+              timeout= stmt->stmt_options.query_timeout;
+  const char  *pos= query, *end= query + *query_length, *close= NULL;
+  char        hint[128], *to, *result;
+  size_t      hint_length;
+
+  *hinted= 0;
+
+  while (pos < end)
+  {
+    if (isspace((unsigned char)*pos) || *pos == '(')
+    {
+      ++pos;
+    }
+    else if (*pos == '#' || (end - pos >= 3 && !memcmp(pos, "--", 2)
+                             && isspace((unsigned char)pos[2])))
+    {
+      while (pos < end && *pos != '\n')
+        ++pos;
+    }
+    /* Not a comment if it starts with '!', the server runs what is in it */
+    else if (end - pos >= 3 && !memcmp(pos, "/*", 2) && pos[2] != '!')
+    {
+      for (pos+= 2; pos + 1 < end; ++pos)
+      {
+        if (pos[0] == '*' && pos[1] == '/')
+          break;
+      }
+
+      /* Not terminated, let the server report it */
+      if (pos + 1 >= end)
+        return NULL;
+
+      pos+= 2;
+    }
+    else
+    {
+      break;
+    }
   }
 
-  if (new_value > 0)
+  if (end - pos < 7 || myodbc_casecmp(pos, "SELECT", 6)
+   || (!isspace((unsigned char)pos[6]) && pos[6] != '(' && pos[6] != '/'))
+    return NULL;
+
+  pos+= 6;
+
+  /* Is there a hint comment already? Then the limits go before its end */
+  for (close= pos; close < end && isspace((unsigned char)*close); ++close);
+
+  if (end - close >= 3 && !memcmp(close, "/*+", 3))
   {
-    unsigned long long msec_value= (unsigned long long)new_value * 1000;
-    sprintf(query, "set @@max_execution_time=%llu", msec_value);
+    for (close+= 3; close + 1 < end; ++close)
+    {
+      if (close[0] == '*' && close[1] == '/')
+        break;
+    }
+
+    /* Not terminated, let the server report it */
+    if (close + 1 >= end)
+      return NULL;
+
+    pos= close;
+    to= hint;
   }
   else
   {
-    strcpy(query, "set @@max_execution_time=DEFAULT");
-    new_value= 0;
+    close= NULL;
+    to= myodbc_stpmov(hint, " /*+");
   }
 
-  if (SQL_SUCCEEDED(rc= odbc_stmt(stmt->dbc, query, SQL_NTS, TRUE)))
+  if (max_rows > 0 && max_rows != sql_select_unlimited
+   && is_minimum_version(server_version, "8.0.3"))
   {
-    stmt->stmt_options.query_timeout= new_value;
+    to+= sprintf(to, " SET_VAR(sql_select_limit=%lu)", (unsigned long)max_rows);
+    *hinted|= HINT_SELECT_LIMIT;
   }
 
-  return rc;
+  if (timeout > 0 && timeout != (SQLULEN)-1
+   && is_minimum_version(server_version, "5.7.8"))
+  {
+    to+= sprintf(to, " MAX_EXECUTION_TIME(%llu)",
+                 (unsigned long long)timeout * 1000);
+    *hinted|= HINT_EXECUTION_TIME;
+  }
+
+  if (*hinted == 0)
+    return NULL;
+
+  to= myodbc_stpmov(to, close ? " " : " */");
+  hint_length= to - hint;
+
+  if (!(result= myodbc_malloc(*query_length + hint_length + 1, MYF(0))))
+  {
+    *hinted= 0;
+    return NULL;
+  }
+
+  /* SELECT (with the hints of the query), then ours, then the rest */
+  to= result;
+  memcpy(to, query, pos - query);
+  to+= pos - query;
+  memcpy(to, hint, hint_length);
+  to+= hint_length;
+  memcpy(to, pos, end - pos);
+  to+= end - pos;
+  *to= '\0';
+
+  *query_length= to - result;
+
+  return result;
 }
 
 
@@ -4161,7 +4561,7 @@ SQLULEN get_query_timeout(STMT *stmt)
 {
   SQLULEN query_timeout= SQL_QUERY_TIMEOUT_DEFAULT; /* 0 */
   
-  if (is_minimum_version(stmt->dbc->mysql.server_version, "5.7.8"))
+  if (is_minimum_version(stmt->dbc->mysql->server_version, "5.7.8"))
   {
     /* Be cautious with very long values even if they don't make sense */
     char query_timeout_char[32]= {0};
@@ -4180,7 +4580,7 @@ const char get_identifier_quote(STMT *stmt)
 {
   const char tick= '`', quote= '"', empty= ' ';
 
-  if (is_minimum_version(stmt->dbc->mysql.server_version, "3.23.06"))
+  if (is_minimum_version(stmt->dbc->mysql->server_version, "3.23.06"))
   {
     /* 
       The full list of all SQL modes takes over 512 symbols, so we reserve
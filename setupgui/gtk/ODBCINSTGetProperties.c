@@ -41,6 +41,16 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"INITSTMT",          "T", "Initial statement executed at the connecting time"},
   {"CHARSET",           "T", "The character set to use for the connection"},
   {"PREFETCH",          "T", "Prefecth from server by N rows at a time"},
+  {"SSPS_CACHE_SIZE",   "T", "Keep up to N prepared statements for reuse"},
+  {"READAHEAD_ROWS",    "T", "Read up to N rows of a forward-only result in background"},
+  {"READAHEAD_SIZE",    "T", "Limit rows read in background to N kilobytes"},
+  {"POOL_MAX_IDLE",     "T", "Keep up to N idle connections open for reuse"},
+  {"POOL_MIN_IDLE",     "T", "Never close N idle connections for being idle"},
+  {"POOL_IDLE_TIMEOUT", "T", "Close idle connections after N seconds"},
+  {"POOL_PING_INTERVAL","T", "Check idle connections every N seconds"},
+  {"LIVENESS_CHECK",    "T", "On a lost connection 0 pings after idle time, 1 re-runs reads once, 2 only reports it"},
+  {"TCP_KEEPALIVE",     "T", "Send TCP keepalive probes after N idle seconds"},
+  {"KEY_CACHE_TTL",     "T", "Reuse keys of tables read by a connection for N seconds"},
   {"READTIMEOUT",       "T", "The timeout in seconds for attempts to read from the server"},
   {"WRITETIMEOUT",      "T", "The timeout in seconds for attempts to write to the server"},
   {"SSLCA",             "F", "The path to a file with a list of trust SSL CAs"},
@@ -81,6 +91,7 @@ static const char *MYODBC_OPTIONS[][3] = {
   {"CAN_HANDLE_EXP_PWD",      "C", "Can Handle Expired Password"},
   {"ENABLE_CLEARTEXT_PLUGIN", "C", "Enable Cleartext Authentication"},
   {"NO_SSPS",                 "C", "Prepare statements on the client"},
+  {"MULTI_ROW_INSERTS",       "C", "Send INSERT parameter arrays as multi-row INSERTs"},
   {NULL, NULL, NULL}
 };
 
@@ -1203,6 +1203,171 @@ DECLARE_TEST(t_ssl_mode)
   return OK;
 }
 
+/*
+  Connections pooled by the driver are reused by the next connect with the
+  same options, with the session reset.
+*/
+DECLARE_TEST(t_driver_pool)
+{
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLINTEGER  connection_id;
+  const SQLCHAR *options= "POOL_MAX_IDLE=2;POOL_PING_INTERVAL=1";
+
+  ok_env(henv, SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbc1));
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL, options));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SET @t_driver_pool= 1");
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  connection_id= my_fetch_int(hstmt1, 1);
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+
+  /* Give the thread a chance to ping the idle connection */
+  sleep(2);
+
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL, options));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SELECT CONNECTION_ID(), @t_driver_pool IS NULL");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), connection_id);
+  is_num(my_fetch_int(hstmt1, 2), 1);
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+
+  /* Other options, other pool */
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL,
+                               "POOL_MAX_IDLE=1"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is(my_fetch_int(hstmt1, 1) != connection_id);
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+  ok_con(hdbc1, SQLFreeConnect(hdbc1));
+
+  return OK;
+}
+
+
+/*
+  With LIVENESS_CHECK=1 a SELECT on a connection killed meanwhile is run
+  again on a new one, with LIVENESS_CHECK=2 the loss is reported.
+*/
+DECLARE_TEST(t_liveness_retry)
+{
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLINTEGER  connection_id;
+  SQLCHAR     query[64];
+
+  ok_env(henv, SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbc1));
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL,
+                               "LIVENESS_CHECK=1;TCP_KEEPALIVE=60"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  connection_id= my_fetch_int(hstmt1, 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  sprintf((char *)query, "KILL %d", connection_id);
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is(my_fetch_int(hstmt1, 1) != connection_id);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL,
+                               "LIVENESS_CHECK=2"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_sql(hstmt1, "SELECT CONNECTION_ID()");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  connection_id= my_fetch_int(hstmt1, 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  sprintf((char *)query, "KILL %d", connection_id);
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+
+  expect_sql(hstmt1, "SELECT 1", SQL_ERROR);
+  is(check_sqlstate(hstmt1, "08S01") == OK);
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+  ok_con(hdbc1, SQLFreeConnect(hdbc1));
+
+  return OK;
+}
+
+
+/*
+  Queries of two connections run at once with SQL_ATTR_ASYNC_ENABLE, polled
+  from one thread.
+*/
+DECLARE_TEST(t_async_exec)
+{
+  SQLHDBC     hdbc1;
+  SQLHSTMT    hstmt1;
+  SQLRETURN   rc, rc1;
+  SQLUINTEGER async;
+  int         polls= 0;
+
+  ok_env(henv, SQLAllocHandle(SQL_HANDLE_DBC, henv, &hdbc1));
+  ok_con(hdbc1, get_connection(&hdbc1, NULL, NULL, NULL, NULL, NULL));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt1));
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_ASYNC_ENABLE,
+                                 (SQLPOINTER)SQL_ASYNC_ENABLE_ON, 0));
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, &async, 0,
+                                NULL));
+  is_num(async, SQL_ASYNC_ENABLE_ON);
+
+  do
+  {
+    rc= SQLExecDirect(hstmt, (SQLCHAR *)"SELECT SLEEP(1), 1", SQL_NTS);
+    rc1= SQLExecDirect(hstmt1, (SQLCHAR *)"SELECT SLEEP(1), 2", SQL_NTS);
+    ++polls;
+  } while (rc == SQL_STILL_EXECUTING || rc1 == SQL_STILL_EXECUTING);
+
+  ok_stmt(hstmt, rc);
+  ok_stmt(hstmt1, rc1);
+  is(polls > 1);
+
+  while ((rc= SQLFetch(hstmt)) == SQL_STILL_EXECUTING);
+  ok_stmt(hstmt, rc);
+  is_num(my_fetch_int(hstmt, 2), 1);
+  while ((rc= SQLFetch(hstmt)) == SQL_STILL_EXECUTING);
+  expect_stmt(hstmt, rc, SQL_NO_DATA);
+
+  while ((rc= SQLFetch(hstmt1)) == SQL_STILL_EXECUTING);
+  ok_stmt(hstmt1, rc);
+  is_num(my_fetch_int(hstmt1, 2), 2);
+
+  /* Errors of the query come with the final result */
+  while ((rc= SQLExecDirect(hstmt1, (SQLCHAR *)"SELECT * FROM t_async_none",
+                            SQL_NTS)) == SQL_STILL_EXECUTING);
+  expect_stmt(hstmt1, rc, SQL_ERROR);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE,
+                                (SQLPOINTER)SQL_ASYNC_ENABLE_OFF, 0));
+
+  ok_con(hdbc1, SQLDisconnect(hdbc1));
+  ok_con(hdbc1, SQLFreeConnect(hdbc1));
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_tls_opts)
   ADD_TEST(t_ssl_mode)
@@ -1237,6 +1402,9 @@ BEGIN_TESTS
   ADD_TEST(t_bug45378)
   ADD_TEST(t_bug63844)
   ADD_TEST(t_bug52996)
+  ADD_TEST(t_driver_pool)
+  ADD_TEST(t_async_exec)
+  ADD_TEST(t_liveness_retry)
   END_TESTS
 
 
@@ -1261,6 +1261,78 @@ DECLARE_TEST(t_bug_14005343)
 }
 
 
+/*
+  Keys of a table cached by the connection with KEY_CACHE_TTL, and dropped
+  when the table is altered on the connection
+*/
+DECLARE_TEST(t_key_cache)
+{
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+  char use_mydb[80];
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, USE_DRIVER,
+                                        NULL, NULL, NULL,
+                                        "KEY_CACHE_TTL=600"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_key_cache");
+  ok_sql(hstmt1, "CREATE TABLE t_key_cache (a INT NOT NULL, b INT NOT NULL, "
+                 "c INT, PRIMARY KEY (a), KEY (c))");
+
+  ok_stmt(hstmt1, SQLPrimaryKeys(hstmt1, mydb, SQL_NTS, NULL, 0,
+                                 (SQLCHAR *)"t_key_cache", SQL_NTS));
+  is_num(myrowcount(hstmt1), 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* The same keys, from the cache this time */
+  ok_stmt(hstmt1, SQLStatistics(hstmt1, mydb, SQL_NTS, NULL, 0,
+                                (SQLCHAR *)"t_key_cache", SQL_NTS,
+                                SQL_INDEX_ALL, SQL_QUICK));
+  is_num(myrowcount(hstmt1), 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLStatistics(hstmt1, mydb, SQL_NTS, NULL, 0,
+                                (SQLCHAR *)"t_key_cache", SQL_NTS,
+                                SQL_INDEX_UNIQUE, SQL_QUICK));
+  is_num(myrowcount(hstmt1), 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Keys of the current database are those of the table USE switched to */
+  ok_sql(hstmt1, "DROP DATABASE IF EXISTS t_key_cache_db");
+  ok_sql(hstmt1, "CREATE DATABASE t_key_cache_db");
+  ok_sql(hstmt1, "CREATE TABLE t_key_cache_db.t_key_cache (a INT NOT NULL, "
+                 "b INT NOT NULL, PRIMARY KEY (a, b))");
+  ok_sql(hstmt1, "USE t_key_cache_db");
+
+  ok_stmt(hstmt1, SQLPrimaryKeys(hstmt1, NULL, 0, NULL, 0,
+                                 (SQLCHAR *)"t_key_cache", SQL_NTS));
+  is_num(myrowcount(hstmt1), 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLPrimaryKeys(hstmt1, mydb, SQL_NTS, NULL, 0,
+                                 (SQLCHAR *)"t_key_cache", SQL_NTS));
+  is_num(myrowcount(hstmt1), 1);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP DATABASE t_key_cache_db");
+  sprintf(use_mydb, "USE %s", (char *)mydb);
+  ok_stmt(hstmt1, SQLExecDirect(hstmt1, (SQLCHAR *)use_mydb, SQL_NTS));
+
+  ok_sql(hstmt1, "ALTER TABLE t_key_cache DROP PRIMARY KEY, "
+                 "ADD PRIMARY KEY (a, b)");
+
+  ok_stmt(hstmt1, SQLPrimaryKeys(hstmt1, mydb, SQL_NTS, NULL, 0,
+                                 (SQLCHAR *)"t_key_cache", SQL_NTS));
+  is_num(myrowcount(hstmt1), 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_key_cache");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_bug_14005343)
   ADD_TEST(t_bug69554)
@@ -1280,6 +1352,7 @@ BEGIN_TESTS
   ADD_TEST(t_bug14085211_part1)
   // ADD_TODO(t_bug14085211_part2) TODO: Fix
   ADD_TEST(t_sqlcolumns_after_select)
+  ADD_TEST(t_key_cache)
   // ADD_TEST(t_bug14555713) TODO: Fix
   // ADD_TODO(t_bug69448) TODO: Fix
 END_TESTS
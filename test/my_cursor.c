@@ -3415,6 +3415,162 @@ DECLARE_TEST(t_18805455)
 }
 
 
+/*
+  Rows of forward-only results read by the background thread, that does
+  not need "Don't cache results"
+*/
+DECLARE_TEST(t_readahead)
+{
+  SQLINTEGER  id, expected;
+  SQLCHAR     txt[256];
+  SQLLEN      txt_len;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, USE_DRIVER,
+                                        NULL, NULL, NULL,
+                                        "READAHEAD_ROWS=8;READAHEAD_SIZE=1"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_readahead");
+  ok_sql(hstmt1, "CREATE TABLE t_readahead (id INT PRIMARY KEY)");
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"INSERT INTO t_readahead "
+                             "VALUES (?)", SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &id, 0, NULL));
+  for (id= 0; id < 500; ++id)
+  {
+    ok_stmt(hstmt1, SQLExecute(hstmt1));
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  /* Rows up to 200 bytes long, so READAHEAD_SIZE limits the ring too */
+  ok_sql(hstmt1, "SELECT id, REPEAT('x', id % 200) FROM t_readahead "
+                 "ORDER BY id");
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 1, SQL_C_LONG, &id, 0, NULL));
+  ok_stmt(hstmt1, SQLBindCol(hstmt1, 2, SQL_C_CHAR, txt, sizeof(txt),
+                             &txt_len));
+
+  for (expected= 0; expected < 500; ++expected)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, expected);
+    is_num(txt_len, expected % 200);
+  }
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  /* Closing the cursor in the middle of the result */
+  ok_sql(hstmt1, "SELECT id, REPEAT('x', id % 200) FROM t_readahead "
+                 "ORDER BY id");
+  for (expected= 0; expected < 10; ++expected)
+  {
+    ok_stmt(hstmt1, SQLFetch(hstmt1));
+    is_num(id, expected);
+  }
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+
+  ok_sql(hstmt1, "SELECT COUNT(*) FROM t_readahead");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 500);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_readahead");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+/*
+  Update and delete of the whole rowset, done with one statement for rows
+  of a table with a key
+*/
+DECLARE_TEST(t_setpos_rowset_by_key)
+{
+  SQLINTEGER   a[4], b[4];
+  SQLCHAR      name[4][20];
+  SQLLEN       key_len[4], name_len[4], rows_fetched;
+  SQLUSMALLINT status[4];
+  SQLLEN       row_count;
+  int          i;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_setpos_rowset_by_key");
+  ok_sql(hstmt, "CREATE TABLE t_setpos_rowset_by_key (a INT, b INT, "
+                "name VARCHAR(20), PRIMARY KEY (a, b))");
+  ok_sql(hstmt, "INSERT INTO t_setpos_rowset_by_key VALUES (1, 1, 'a'), "
+                "(1, 2, NULL), (2, 1, 'c'), (2, 2, 'd'), (3, 1, 'e'), "
+                "(3, 2, 'f')");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_STATIC, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)4, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, status, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                &rows_fetched, 0));
+
+  ok_sql(hstmt, "SELECT a, b, name FROM t_setpos_rowset_by_key "
+                "ORDER BY a, b");
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, a, 0, key_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_LONG, b, 0, key_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_CHAR, name, sizeof(name[0]),
+                            name_len));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(rows_fetched, 4);
+  is_num(name_len[1], SQL_NULL_DATA);
+
+  /* New names for all rows but the third one, keys are left as they are */
+  for (i= 0; i < 4; ++i)
+  {
+    sprintf((char *)name[i], "new%d", i);
+    name_len[i]= SQL_NTS;
+    key_len[i]= SQL_COLUMN_IGNORE;
+  }
+  name_len[2]= SQL_COLUMN_IGNORE;
+
+  ok_stmt(hstmt, SQLSetPos(hstmt, 0, SQL_UPDATE, SQL_LOCK_NO_CHANGE));
+  ok_stmt(hstmt, SQLRowCount(hstmt, &row_count));
+  is_num(row_count, 3);
+  is_num(status[0], SQL_ROW_UPDATED);
+  is_num(status[2], SQL_ROW_UPDATED);
+
+  /* Delete the rowset */
+  ok_stmt(hstmt, SQLSetPos(hstmt, 0, SQL_DELETE, SQL_LOCK_NO_CHANGE));
+  ok_stmt(hstmt, SQLRowCount(hstmt, &row_count));
+  is_num(row_count, 4);
+  for (i= 0; i < 4; ++i)
+  {
+    is_num(status[i], SQL_ROW_DELETED);
+  }
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+
+  ok_sql(hstmt, "SELECT a, b, name FROM t_setpos_rowset_by_key "
+                "ORDER BY a, b");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 1), 3);
+  is_num(my_fetch_int(hstmt, 2), 1);
+  is_str(my_fetch_str(hstmt, name[0], 3), "e", 2);
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 2), 2);
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_setpos_rowset_by_key");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_positioned_cursor)
   ADD_TEST(my_setpos_cursor)
@@ -3474,6 +3630,8 @@ BEGIN_TESTS
   ADD_TEST(t_bug39961)
 #endif
   ADD_TEST(t_bug41946)
+  ADD_TEST(t_readahead)
+  ADD_TEST(t_setpos_rowset_by_key)
   /*ADD_TEST(t_sqlputdata)*/
   // ADD_TEST(t_18805455) TODO: Fix
 END_TESTS
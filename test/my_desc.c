@@ -514,6 +514,58 @@ DECLARE_TEST(t_set_null_use_implicit)
 }
 
 
+/*
+  Memory of freed statements and descriptors is reused for new ones, which
+  have to start with the defaults nevertheless.
+*/
+DECLARE_TEST(t_handle_reuse)
+{
+  SQLHANDLE   hstmt1, expard;
+  SQLULEN     array_size;
+  SQLSMALLINT count, name_len;
+  SQLCHAR     name[64];
+  int         i;
+
+  for (i= 0; i < 100; ++i)
+  {
+    ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt1));
+    ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_DESC, hdbc, &expard));
+
+    ok_desc(expard, SQLSetDescField(expard, 0, SQL_DESC_COUNT,
+                                    (SQLPOINTER)3, SQL_IS_SMALLINT));
+    ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE,
+                                   (SQLPOINTER)10, 0));
+    ok_stmt(hstmt1, SQLSetCursorName(hstmt1, (SQLCHAR *)"reused", SQL_NTS));
+
+    ok_desc(expard, SQLFreeHandle(SQL_HANDLE_DESC, expard));
+    ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+  }
+
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt1));
+  ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_DESC, hdbc, &expard));
+
+  ok_stmt(hstmt1, SQLGetStmtAttr(hstmt1, SQL_ATTR_ROW_ARRAY_SIZE,
+                                 &array_size, 0, NULL));
+  is_num(array_size, 1);
+  ok_desc(expard, SQLGetDescField(expard, 0, SQL_DESC_COUNT, &count,
+                                  SQL_IS_SMALLINT, NULL));
+  is_num(count, 0);
+
+  /* A generated name, not the one of a previous statement */
+  ok_stmt(hstmt1, SQLGetCursorName(hstmt1, name, sizeof(name), &name_len));
+  is(strcmp((char *)name, "reused") != 0);
+
+  ok_sql(hstmt1, "SELECT 1");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 1);
+
+  ok_desc(expard, SQLFreeHandle(SQL_HANDLE_DESC, expard));
+  ok_stmt(hstmt1, SQLFreeHandle(SQL_HANDLE_STMT, hstmt1));
+
+  return OK;
+}
+
+
 /*
   Test free-ing a statement that has an explicitely allocated
   descriptor associated with it. If this test fails, it will
@@ -662,6 +714,7 @@ BEGIN_TESTS
   ADD_TEST(t_mult_stmt_free)
   ADD_TEST(t_set_null_use_implicit)
   ADD_TEST(t_free_stmt_with_exp_desc)
+  ADD_TEST(t_handle_reuse)
   ADD_TEST(t_bug41081)
   ADD_TEST(t_bug44576)
 #endif
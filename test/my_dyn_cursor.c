@@ -719,6 +719,81 @@ DECLARE_TEST(my_dynamic_cursor)
 }
 
 
+/*
+  Rows of a dynamic cursor are refreshed by their keys inside of the keyset,
+  and by running the query again outside of it
+*/
+DECLARE_TEST(my_keyset_refresh)
+{
+    SQLHSTMT    hstmt2;
+    SQLINTEGER  id[2], val[2];
+    SQLULEN     keyset_size= 0;
+    SQLULEN     rows_fetched;
+
+    ok_sql(hstmt, "DROP TABLE IF EXISTS my_keyset_refresh");
+    ok_sql(hstmt, "CREATE TABLE my_keyset_refresh (id INT PRIMARY KEY, val INT)");
+    ok_sql(hstmt, "INSERT INTO my_keyset_refresh VALUES (1,10),(2,20),(3,30),"
+                  "(4,40),(5,50),(6,60),(7,70),(8,80)");
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+    ok_con(hdbc, SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt2));
+
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                  (SQLPOINTER)SQL_CURSOR_DYNAMIC, 0));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_KEYSET_SIZE,
+                                  (SQLPOINTER)4, 0));
+    ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_KEYSET_SIZE, &keyset_size,
+                                  0, NULL));
+    is_num(keyset_size, 4);
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                  (SQLPOINTER)2, 0));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                  &rows_fetched, 0));
+
+    ok_sql(hstmt, "SELECT id, val FROM my_keyset_refresh ORDER BY id");
+    ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, id, 0, NULL));
+    ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_LONG, val, 0, NULL));
+
+    ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+    is_num(rows_fetched, 2);
+    is_num(id[0], 1);
+    is_num(val[1], 20);
+
+    /* Inside of the keyset new values are seen */
+    ok_sql(hstmt2, "UPDATE my_keyset_refresh SET val=31 WHERE id=3");
+    ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+    is_num(rows_fetched, 2);
+    is_num(id[0], 3);
+    is_num(val[0], 31);
+    is_num(id[1], 4);
+
+    ok_sql(hstmt2, "UPDATE my_keyset_refresh SET val=11 WHERE id=1");
+    ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0));
+    is_num(id[0], 1);
+    is_num(val[0], 11);
+
+    /* Deleted row is not there when the query runs again */
+    ok_sql(hstmt2, "DELETE FROM my_keyset_refresh WHERE id=5");
+    ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 5));
+    is_num(rows_fetched, 2);
+    is_num(id[0], 6);
+    is_num(id[1], 7);
+
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                  (SQLPOINTER)1, 0));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+    ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_KEYSET_SIZE,
+                                  (SQLPOINTER)0, 0));
+
+    ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+    ok_sql(hstmt, "DROP TABLE IF EXISTS my_keyset_refresh");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_dynamic_pos_cursor)
   ADD_TEST(my_dynamic_pos_cursor1)
@@ -729,6 +804,7 @@ BEGIN_TESTS
 #ifndef USE_IODBC
   ADD_TEST(my_dynamic_cursor)
 #endif
+  ADD_TEST(my_keyset_refresh)
   END_TESTS
 
 SET_DSN_OPTION(35);
@@ -533,9 +533,41 @@ DECLARE_TEST(t_query_timeout)
 }
 
 
+/*
+  SQL_ATTR_QUERY_TIMEOUT of statements the server does not time out itself.
+  The driver kills the query over a control connection.
+*/
+DECLARE_TEST(t_query_timeout_kill)
+{
+  time_t t1, t2;
+  SQLRETURN rc;
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_QUERY_TIMEOUT, (SQLPOINTER)1, 0));
+
+  t1= time(NULL);
+  rc= SQLExecDirect(hstmt, "DO SLEEP(10)", SQL_NTS);
+  t2= time(NULL);
+
+  /* SLEEP() may just return early instead of failing */
+  if (rc == SQL_ERROR)
+  {
+    is(check_sqlstate(hstmt, "HYT00") == OK);
+  }
+
+  is(t2 - t1 < 5);
+
+  /* The connection is still usable and the timeout is gone */
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_QUERY_TIMEOUT, (SQLPOINTER)0, 0));
+  ok_sql(hstmt, "DO SLEEP(2)");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   /* Query timeout should go first */
   ADD_TEST(t_query_timeout)
+  ADD_TEST(t_query_timeout_kill)
   ADD_TEST(sqlgetinfo)
   ADD_TEST(t_gettypeinfo)
   ADD_TEST(t_stmt_attr_status)
@@ -23,6 +23,7 @@
 */
 
 #include "odbctap.h"
+#include <locale.h>
 
 /********************************************************
 * initialize tables                                     *
@@ -1699,6 +1700,381 @@ DECLARE_TEST(t_inoutstream17842966)
 
 #endif /* #ifndef USE_IODBC */
 
+/*
+  Floating point parameters and results do not depend on the decimal
+  point of the application locale.
+*/
+DECLARE_TEST(t_double_locale)
+{
+  SQLDOUBLE param= 1.25, dres;
+  SQLCHAR   cres[32];
+  char     *saved= strdup(setlocale(LC_NUMERIC, NULL));
+
+  /* Whichever of these exists, all of them use ',' as decimal point */
+  if (!setlocale(LC_NUMERIC, "de_DE.UTF-8") &&
+      !setlocale(LC_NUMERIC, "de_DE") &&
+      !setlocale(LC_NUMERIC, "German"))
+    printMessage("No locale with ',' decimal point, testing with %s", saved);
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_DOUBLE,
+                                  SQL_DOUBLE, 0, 0, &param, 0, NULL));
+  ok_sql(hstmt, "SELECT ? * 2, 0.5, '1.25e3'");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_DOUBLE, &dres, 0, NULL));
+  is(dres == 2.5);
+  ok_stmt(hstmt, SQLGetData(hstmt, 2, SQL_C_DOUBLE, &dres, 0, NULL));
+  is(dres == 0.5);
+  ok_stmt(hstmt, SQLGetData(hstmt, 2, SQL_C_CHAR, cres, sizeof(cres), NULL));
+  is_str(cres, "0.5", 4);
+  /* Not a plain decimal number, converted by strtold() in "C" locale */
+  ok_stmt(hstmt, SQLGetData(hstmt, 3, SQL_C_DOUBLE, &dres, 0, NULL));
+  is(dres == 1250.0);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+
+  setlocale(LC_NUMERIC, saved);
+  free(saved);
+
+  return OK;
+}
+
+
+/*
+  Array of paramsets of INSERT ... VALUES is sent in multi-row INSERTs with
+  MULTI_ROW_INSERTS, with ignored paramsets and string parameters of
+  different length.
+*/
+DECLARE_TEST(t_paramarray_insert_batch)
+{
+#define BATCH_ROWS 1000
+  SQLINTEGER   id[BATCH_ROWS];
+  SQLCHAR      name[BATCH_ROWS][20];
+  SQLLEN       name_len[BATCH_ROWS];
+  SQLUSMALLINT status[BATCH_ROWS], operation[BATCH_ROWS];
+  SQLULEN      processed= 0;
+  SQLLEN       rows= 0;
+  SQLINTEGER   count, sum;
+  int i;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, "MULTI_ROW_INSERTS=1"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_paramarray_insert_batch");
+  ok_sql(hstmt1, "CREATE TABLE t_paramarray_insert_batch "
+                 "(id INT PRIMARY KEY, name VARCHAR(20))");
+
+  for (i= 0; i < BATCH_ROWS; ++i)
+  {
+    id[i]= i;
+    name_len[i]= sprintf((char *)name[i], "name %d)', (", i);
+    operation[i]= i % 10 == 3 ? SQL_PARAM_IGNORE : SQL_PARAM_PROCEED;
+  }
+
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)BATCH_ROWS, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_STATUS_PTR,
+                                 status, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_OPERATION_PTR,
+                                 operation, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                 &processed, 0));
+
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, id, 0, NULL));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 20, 0, name, sizeof(name[0]),
+                                   name_len));
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"INSERT INTO "
+                             "t_paramarray_insert_batch VALUES (?, ?) "
+                             "ON DUPLICATE KEY UPDATE name= VALUES(name)",
+                             SQL_NTS));
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+
+  is_num(processed, BATCH_ROWS);
+  ok_stmt(hstmt1, SQLRowCount(hstmt1, &rows));
+  is_num(rows, BATCH_ROWS - BATCH_ROWS / 10);
+
+  for (i= 0; i < BATCH_ROWS; ++i)
+  {
+    is_num(status[i], operation[i] == SQL_PARAM_IGNORE ? SQL_PARAM_UNUSED
+                                                       : SQL_PARAM_SUCCESS);
+  }
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMSET_SIZE,
+                                 (SQLPOINTER)1, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAM_OPERATION_PTR,
+                                 NULL, 0));
+  ok_stmt(hstmt1, SQLSetStmtAttr(hstmt1, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                 NULL, 0));
+
+  ok_sql(hstmt1, "SELECT COUNT(*), SUM(id) FROM t_paramarray_insert_batch "
+                 "WHERE name = CONCAT('name ', id, ')'', (')");
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  count= my_fetch_int(hstmt1, 1);
+  sum= my_fetch_int(hstmt1, 2);
+  is_num(count, BATCH_ROWS - BATCH_ROWS / 10);
+  is_num(sum, (BATCH_ROWS - 1) * BATCH_ROWS / 2
+              - (3 + (BATCH_ROWS - 7)) * (BATCH_ROWS / 10) / 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_paramarray_insert_batch");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+#undef BATCH_ROWS
+  return OK;
+}
+
+
+/*
+  Without MULTI_ROW_INSERTS paramsets of INSERT are executed one by one, a
+  failed paramset of a non-transactional table gets its own status and the
+  others are inserted.
+*/
+DECLARE_TEST(t_paramarray_insert_rows)
+{
+  SQLINTEGER   id[4]= {1, 2, 1, 3};
+  SQLUSMALLINT status[4];
+  SQLULEN      processed= 0;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_paramarray_insert_rows");
+  ok_sql(hstmt, "CREATE TABLE t_paramarray_insert_rows "
+                "(id INT PRIMARY KEY) ENGINE=MyISAM");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                (SQLPOINTER)4, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, status, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                &processed, 0));
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, id, 0, NULL));
+
+  expect_stmt(hstmt, SQLExecDirect(hstmt, (SQLCHAR *)"INSERT INTO "
+                                   "t_paramarray_insert_rows VALUES (?)",
+                                   SQL_NTS), SQL_SUCCESS_WITH_INFO);
+
+  is_num(processed, 4);
+  is_num(status[0], SQL_PARAM_SUCCESS);
+  is_num(status[1], SQL_PARAM_SUCCESS);
+  is_num(status[2], SQL_PARAM_ERROR);
+  is_num(status[3], SQL_PARAM_SUCCESS);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, NULL, 0));
+
+  ok_sql(hstmt, "SELECT COUNT(*) FROM t_paramarray_insert_rows");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(my_fetch_int(hstmt, 1), 3);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_paramarray_insert_rows");
+
+  return OK;
+}
+
+
+/*
+  Paramsets of UPDATE are executed one by one, a failed paramset does not
+  prevent execution of the following ones, and the row count is the total
+  of all paramsets.
+*/
+DECLARE_TEST(t_paramarray_update)
+{
+#define UPDATE_ROWS 10
+  SQLINTEGER   id[UPDATE_ROWS], val[UPDATE_ROWS];
+  SQLUSMALLINT status[UPDATE_ROWS];
+  SQLULEN      processed= 0;
+  SQLLEN       rows= 0;
+  int i;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_paramarray_update");
+  ok_sql(hstmt, "CREATE TABLE t_paramarray_update "
+                "(id INT PRIMARY KEY, val INT UNIQUE)");
+  ok_sql(hstmt, "INSERT INTO t_paramarray_update VALUES (0,0),(1,1),"
+                "(2,2),(3,3),(4,4),(5,5),(6,6),(7,7),(8,8),(9,9)");
+
+  /* Paramset #5 violates unique key, the value is taken by #4 */
+  for (i= 0; i < UPDATE_ROWS; ++i)
+  {
+    id[i]= i;
+    val[i]= 100 + i;
+  }
+  val[5]= 104;
+  val[6]= 200;
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                (SQLPOINTER)UPDATE_ROWS, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, status, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR,
+                                &processed, 0));
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, val, 0, NULL));
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, id, 0, NULL));
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)"UPDATE t_paramarray_update"
+                            " SET val= ? WHERE id= ?", SQL_NTS));
+
+  expect_stmt(hstmt, SQLExecute(hstmt), SQL_SUCCESS_WITH_INFO);
+
+  is_num(processed, UPDATE_ROWS);
+  ok_stmt(hstmt, SQLRowCount(hstmt, &rows));
+  is_num(rows, UPDATE_ROWS - 1);
+
+  for (i= 0; i < UPDATE_ROWS; ++i)
+  {
+    is_num(status[i], i == 5 ? SQL_PARAM_ERROR : SQL_PARAM_SUCCESS);
+  }
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE,
+                                (SQLPOINTER)1, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, NULL, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, NULL, 0));
+
+  ok_sql(hstmt, "SELECT SUM(val) FROM t_paramarray_update");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  /* 100..109 without 105 and 106, plus 200 and 5 */
+  is_num(my_fetch_int(hstmt, 1), 1045 - 105 - 106 + 200 + 5);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_paramarray_update");
+
+#undef UPDATE_ROWS
+  return OK;
+}
+
+
+/*
+  Queries with parameters are built in the buffer of the statement, which is
+  kept for the next executions. It has to grow, and the parameters of
+  another statement must not get in.
+*/
+DECLARE_TEST(t_param_buffer_reuse)
+{
+  SQLCHAR   *big;
+  SQLCHAR   small[]= "abc";
+  SQLLEN    len;
+  SQLHSTMT  hstmt2;
+  const SQLLEN big_len= 300000;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, "NO_SSPS=1"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt2));
+
+  big= malloc(big_len + 1);
+  memset(big, 'x', big_len);
+  big[big_len]= '\0';
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT LENGTH(?)", SQL_NTS));
+  ok_stmt(hstmt2, SQLPrepare(hstmt2, (SQLCHAR *)"SELECT CONCAT(?, 'd')",
+                             SQL_NTS));
+  ok_stmt(hstmt2, SQLBindParameter(hstmt2, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 0, 0, small, 0, NULL));
+
+  len= big_len;
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_LONGVARCHAR, 0, 0, big, 0, &len));
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), big_len);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt2, SQLExecute(hstmt2));
+  ok_stmt(hstmt2, SQLFetch(hstmt2));
+  is_str(my_fetch_str(hstmt2, big, 1), "abcd", 5);
+  ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+
+  len= 3;
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 0, 0, small, 0, &len));
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 3);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free(big);
+  ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+/*
+  Statement built on the client is executed from the template compiled at
+  prepare, and again after it is prepared with another query
+*/
+DECLARE_TEST(t_param_template)
+{
+  SQLCHAR   str1[8], str2[8], buff[32];
+  SQLINTEGER num;
+  SQLLEN    len1;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL, "NO_SSPS=1"));
+
+  ok_stmt(hstmt1, SQLPrepare(hstmt1,
+                             (SQLCHAR *)"SELECT CONCAT(?, '?', ?), ? + 1",
+                             SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 0, 0, str1, 0, &len1));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 2, SQL_PARAM_INPUT, SQL_C_CHAR,
+                                   SQL_VARCHAR, 0, 0, str2, 0, NULL));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 3, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &num, 0, NULL));
+
+  strcpy((char *)str1, "ab");
+  len1= 2;
+  strcpy((char *)str2, "cd");
+  num= 41;
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_str(my_fetch_str(hstmt1, buff, 1), "ab?cd", 6);
+  is_num(my_fetch_int(hstmt1, 2), 42);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  strcpy((char *)str1, "x'y");
+  len1= 3;
+  strcpy((char *)str2, "");
+  num= -2147483647;
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_str(my_fetch_str(hstmt1, buff, 1), "x'y?", 5);
+  is_str(my_fetch_str(hstmt1, buff, 2), "-2147483646", 12);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT ? * 2", SQL_NTS));
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &num, 0, NULL));
+  num= 21;
+  ok_stmt(hstmt1, SQLExecute(hstmt1));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(my_fetch_int(hstmt1, 1), 42);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(my_init_table)
 #ifndef USE_IODBC
@@ -1711,6 +2087,11 @@ BEGIN_TESTS
   ADD_TEST(paramarray_ignore_paramset)
   ADD_TEST(paramarray_select)
   ADD_TEST(t_bug56804)
+  ADD_TEST(t_paramarray_insert_batch)
+  ADD_TEST(t_paramarray_insert_rows)
+  ADD_TEST(t_paramarray_update)
+  ADD_TEST(t_param_buffer_reuse)
+  ADD_TEST(t_param_template)
 #endif
   ADD_TEST(t_param_offset)
   ADD_TEST(t_bug49029)
@@ -1723,6 +2104,7 @@ BEGIN_TESTS
   // ADD_TEST(t_bug14586094) TODO: Fix
   // ADD_TEST(t_longtextoutparam)  TODO: Fix
   ADD_TEST(t_bug53891)
+  ADD_TEST(t_double_locale)
 #if USE_UNIXODBC
   ADD_TEST(t_odbc_outstream_params)
   ADD_TEST(t_odbc_inoutstream_params)
@@ -1252,6 +1252,269 @@ DECLARE_TEST(t_bug67920)
 }
 
 
+static SQLINTEGER session_status(SQLHSTMT hstmt, const char *name)
+{
+  SQLCHAR    query[64];
+  SQLINTEGER count;
+
+  sprintf((char *)query, "SHOW SESSION STATUS LIKE '%s'", name);
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  count= my_fetch_int(hstmt, 2);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return count;
+}
+
+
+/*
+  Statement prepared by a handle that has been freed is reused by the next
+  handle preparing the same query, until the table is altered.
+*/
+DECLARE_TEST(t_ssps_cache)
+{
+  SQLINTEGER  id, prepared;
+  SQLSMALLINT cols;
+  SQLHSTMT    hstmt2;
+  int i;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL,
+                                        "NO_SSPS=0;SSPS_CACHE_SIZE=2"));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_ssps_cache");
+  ok_sql(hstmt1, "CREATE TABLE t_ssps_cache (id INT, a INT)");
+  ok_sql(hstmt1, "INSERT INTO t_ssps_cache VALUES (1, 10), (2, 20)");
+
+  prepared= session_status(hstmt1, "Com_stmt_prepare");
+
+  for (i= 0; i < 5; ++i)
+  {
+    ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt2));
+
+    id= 1 + i % 2;
+    ok_stmt(hstmt2, SQLBindParameter(hstmt2, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                     SQL_INTEGER, 0, 0, &id, 0, NULL));
+    /* Spaces around the query do not matter */
+    ok_stmt(hstmt2, SQLPrepare(hstmt2, i % 2 ?
+                    (SQLCHAR *)"  SELECT a FROM t_ssps_cache WHERE id = ?\n" :
+                    (SQLCHAR *)"SELECT a FROM t_ssps_cache WHERE id = ?",
+                    SQL_NTS));
+    ok_stmt(hstmt2, SQLExecute(hstmt2));
+    ok_stmt(hstmt2, SQLFetch(hstmt2));
+    is_num(my_fetch_int(hstmt2, 1), id * 10);
+    expect_stmt(hstmt2, SQLFetch(hstmt2), SQL_NO_DATA);
+
+    ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+  }
+
+  is_num(session_status(hstmt1, "Com_stmt_prepare"), prepared + 1);
+
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &id, 0, NULL));
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT * FROM t_ssps_cache "
+                             "WHERE id = ?", SQL_NTS));
+  ok_stmt(hstmt1, SQLNumResultCols(hstmt1, &cols));
+  is_num(cols, 2);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  /* Drops the cached statements */
+  ok_sql(hstmt1, "ALTER TABLE t_ssps_cache ADD COLUMN b INT");
+
+  ok_stmt(hstmt1, SQLBindParameter(hstmt1, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                   SQL_INTEGER, 0, 0, &id, 0, NULL));
+  ok_stmt(hstmt1, SQLPrepare(hstmt1, (SQLCHAR *)"SELECT * FROM t_ssps_cache "
+                             "WHERE id = ?", SQL_NTS));
+  ok_stmt(hstmt1, SQLNumResultCols(hstmt1, &cols));
+  is_num(cols, 3);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_RESET_PARAMS));
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_ssps_cache");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+/*
+  SELECT without parameters is executed as prepared statement when the
+  connection caches them, and its values come in binary.
+*/
+DECLARE_TEST(t_ssps_no_params)
+{
+  SQLINTEGER           executed, i;
+  SQLDOUBLE            d;
+  SQL_TIMESTAMP_STRUCT ts;
+  SQL_DATE_STRUCT      date;
+  SQL_TIME_STRUCT      tm;
+  SQLLEN               len;
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL, NULL,
+                                        NULL, NULL,
+                                        "NO_SSPS=0;SSPS_CACHE_SIZE=4"));
+
+  ok_sql(hstmt1, "SET SESSION sql_mode=''");
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_ssps_no_params");
+  ok_sql(hstmt1, "CREATE TABLE t_ssps_no_params (i INT, d DOUBLE, "
+                 "dt DATETIME(6), dd DATE)");
+  ok_sql(hstmt1, "INSERT INTO t_ssps_no_params VALUES (7, 2.5, "
+                 "'2014-02-03 04:05:06.123456', '2014-02-03'), "
+                 "(8, -1, '0000-00-00 00:00:00', '2014-00-03')");
+
+  executed= session_status(hstmt1, "Com_stmt_execute");
+
+  ok_sql(hstmt1, "SELECT i, d, dt, dd FROM t_ssps_no_params ORDER BY i");
+
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 1, SQL_C_LONG, &i, 0, NULL));
+  is_num(i, 7);
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 2, SQL_C_DOUBLE, &d, 0, NULL));
+  is(d == 2.5);
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 3, SQL_C_TYPE_TIMESTAMP, &ts, 0, &len));
+  is_num(ts.year, 2014);
+  is_num(ts.month, 2);
+  is_num(ts.day, 3);
+  is_num(ts.hour, 4);
+  is_num(ts.minute, 5);
+  is_num(ts.second, 6);
+  is_num(ts.fraction, 123456000);
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 4, SQL_C_TYPE_DATE, &date, 0, &len));
+  is_num(date.year, 2014);
+  is_num(date.month, 2);
+  is_num(date.day, 3);
+
+  /* Parts of datetime are truncated with a warning, as in text results */
+  expect_stmt(hstmt1, SQLGetData(hstmt1, 3, SQL_C_TYPE_DATE, &date, 0, &len),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(check_sqlstate(hstmt1, "01S07"), OK);
+  is_num(date.year, 2014);
+  is_num(date.day, 3);
+  expect_stmt(hstmt1, SQLGetData(hstmt1, 3, SQL_C_TYPE_TIME, &tm, 0, &len),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(check_sqlstate(hstmt1, "01S07"), OK);
+  is_num(tm.hour, 4);
+  is_num(tm.minute, 5);
+  is_num(tm.second, 6);
+
+  /* Zero dates are NULL */
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 3, SQL_C_TYPE_TIMESTAMP, &ts, 0, &len));
+  is_num(len, SQL_NULL_DATA);
+  ok_stmt(hstmt1, SQLGetData(hstmt1, 4, SQL_C_TYPE_DATE, &date, 0, &len));
+  is_num(len, SQL_NULL_DATA);
+
+  expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  is_num(session_status(hstmt1, "Com_stmt_execute"), executed + 1);
+
+  ok_sql(hstmt1, "DROP TABLE IF EXISTS t_ssps_no_params");
+
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  return OK;
+}
+
+
+/*
+  Fixed-width columns bound with the C type matching the wire representation
+  are fetched right into the application buffers.
+*/
+DECLARE_TEST(t_ssps_direct_bind)
+{
+  SQLINTEGER  i[2], param= 0;
+  SQLUINTEGER u[2];
+  SQLBIGINT   b[2];
+  SQLDOUBLE   d[2];
+  SQLCHAR     c[2][8];
+  SQLLEN      i_len[2], u_len[2], b_len[2], d_len[2], c_len[2];
+  SQLULEN     rows;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_ssps_direct_bind");
+  ok_sql(hstmt, "CREATE TABLE t_ssps_direct_bind (i INT, u INT UNSIGNED, "
+                "b BIGINT, d DOUBLE, c INT)");
+  ok_sql(hstmt, "INSERT INTO t_ssps_direct_bind VALUES "
+                "(1, 4000000000, 100000000000, 0.5, 11), "
+                "(2, NULL, -3, NULL, 12), (3, 30, 5, 1.5, NULL)");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)2, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, &rows, 0));
+
+  ok_stmt(hstmt, SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_LONG,
+                                  SQL_INTEGER, 0, 0, &param, 0, NULL));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, i, 0, i_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_ULONG, u, 0, u_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_SBIGINT, b, 0, b_len));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 4, SQL_C_DOUBLE, d, 0, d_len));
+  /* Converted column in the same row */
+  ok_stmt(hstmt, SQLBindCol(hstmt, 5, SQL_C_CHAR, c, sizeof(c[0]), c_len));
+
+  ok_stmt(hstmt, SQLPrepare(hstmt, (SQLCHAR *)"SELECT i, u, b, d, c "
+                            "FROM t_ssps_direct_bind WHERE i > ? ORDER BY i",
+                            SQL_NTS));
+  ok_stmt(hstmt, SQLExecute(hstmt));
+
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(rows, 2);
+  is_num(i[0], 1);
+  is_num(i_len[0], sizeof(SQLINTEGER));
+  is(u[0] == 4000000000UL);
+  is(b[0] == 100000000000LL);
+  is_num(b_len[0], sizeof(SQLBIGINT));
+  is(d[0] == 0.5);
+  is_str(c[0], "11", 3);
+  is_num(i[1], 2);
+  is_num(u_len[1], SQL_NULL_DATA);
+  is(b[1] == -3);
+  is_num(d_len[1], SQL_NULL_DATA);
+  is_str(c[1], "12", 3);
+
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(rows, 1);
+  is_num(i[0], 3);
+  is_num(u[0], 30);
+  is(b[0] == 5);
+  is(d[0] == 1.5);
+  is_num(c_len[0], SQL_NULL_DATA);
+
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  /* Single rows fetched into the same buffers */
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+  param= 1;
+  ok_stmt(hstmt, SQLExecute(hstmt));
+
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(i[0], 2);
+  is_num(d_len[0], SQL_NULL_DATA);
+  ok_stmt(hstmt, SQLGetData(hstmt, 3, SQL_C_SBIGINT, &b[1], 0, NULL));
+  is(b[1] == -3);
+
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  is_num(i[0], 3);
+  is(d[0] == 1.5);
+
+  expect_stmt(hstmt, SQLFetch(hstmt), SQL_NO_DATA);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_RESET_PARAMS));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_ssps_direct_bind");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_prep_basic)
   ADD_TEST(t_prep_buffer_length)
@@ -1273,6 +1536,9 @@ BEGIN_TESTS
   ADD_TEST(t_bug67702)
   ADD_TEST(t_bug68243)
   ADD_TEST(t_bug67920)
+  ADD_TEST(t_ssps_cache)
+  ADD_TEST(t_ssps_no_params)
+  ADD_TEST(t_ssps_direct_bind)
 END_TESTS
 
 
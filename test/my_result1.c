@@ -552,6 +552,102 @@ DECLARE_TEST(t_max_rows)
 }
 
 
+static SQLINTEGER session_status(SQLHSTMT hstmt, const char *name)
+{
+  SQLCHAR    query[64];
+  SQLINTEGER count;
+
+  sprintf((char *)query, "SHOW SESSION STATUS LIKE '%s'", name);
+  ok_stmt(hstmt, SQLExecDirect(hstmt, query, SQL_NTS));
+  ok_stmt(hstmt, SQLFetch(hstmt));
+  count= my_fetch_int(hstmt, 2);
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return count;
+}
+
+
+/*
+  SQL_ATTR_MAX_ROWS and SQL_ATTR_QUERY_TIMEOUT of SELECT statements are
+  sent as optimizer hints, so alternating statements with different limits
+  do not set session variables. Comments and parentheses can come before
+  SELECT.
+*/
+DECLARE_TEST(t_limit_hints)
+{
+  SQLHSTMT    hstmt2;
+  SQLINTEGER  set_options;
+  int         i;
+  SQLCHAR    *queries[]= {(SQLCHAR *)"SELECT * FROM t_limit_hints",
+                          (SQLCHAR *)"/* c */ SELECT * FROM t_limit_hints",
+                          (SQLCHAR *)"-- c\nSELECT * FROM t_limit_hints",
+                          (SQLCHAR *)"# c\n SELECT * FROM t_limit_hints",
+                          (SQLCHAR *)"(SELECT * FROM t_limit_hints)"};
+
+  if (!mysql_min_version(hdbc, "8.0.3", 5))
+    skip("SET_VAR optimizer hint requires MySQL 8.0.3");
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_limit_hints");
+  ok_sql(hstmt, "CREATE TABLE t_limit_hints (id INT)");
+  ok_sql(hstmt, "INSERT INTO t_limit_hints VALUES (1),(2),(3),(4),(5),(6)");
+
+  ok_con(hdbc, SQLAllocStmt(hdbc, &hstmt2));
+  ok_stmt(hstmt2, SQLSetStmtAttr(hstmt2, SQL_ATTR_MAX_ROWS, (SQLPOINTER)2, 0));
+  ok_stmt(hstmt2, SQLSetStmtAttr(hstmt2, SQL_ATTR_QUERY_TIMEOUT,
+                                 (SQLPOINTER)10, 0));
+
+  set_options= session_status(hstmt, "Com_set_option");
+
+  for (i= 0; i < sizeof(queries) / sizeof(queries[0]); ++i)
+  {
+    ok_stmt(hstmt2, SQLExecDirect(hstmt2, queries[i], SQL_NTS));
+    is_num(myrowcount(hstmt2), 2);
+    ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+
+    ok_sql(hstmt, "  select * from t_limit_hints");
+    is_num(myrowcount(hstmt), 6);
+    ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  }
+
+  is_num(session_status(hstmt, "Com_set_option"), set_options);
+
+  ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_DROP));
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_limit_hints");
+
+  return OK;
+}
+
+
+/*
+  SQL_ATTR_QUERY_TIMEOUT is kept by the statement also on servers older
+  than 5.7.8, and setting it does not touch the session.
+*/
+DECLARE_TEST(t_query_timeout_stored)
+{
+  SQLULEN     timeout= 0;
+  SQLINTEGER  set_options= session_status(hstmt, "Com_set_option");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT,
+                                (SQLPOINTER)7, 0));
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, &timeout,
+                                0, NULL));
+  is_num(timeout, 7);
+
+  ok_sql(hstmt, "SELECT 1");
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  is_num(session_status(hstmt, "Com_set_option"), set_options);
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT,
+                                (SQLPOINTER)0, 0));
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_QUERY_TIMEOUT, &timeout,
+                                0, NULL));
+  is_num(timeout, 0);
+
+  return OK;
+}
+
+
 DECLARE_TEST(t_multistep)
 {
   SQLRETURN  rc;
@@ -2258,6 +2354,8 @@ BEGIN_TESTS
   ADD_TEST(t_convert)
 #ifndef USE_IODBC
   ADD_TEST(t_max_rows)
+  ADD_TEST(t_limit_hints)
+  ADD_TEST(t_query_timeout_stored)
   ADD_TEST(t_empty_str_bug)
   ADD_TEST(tmysql_rowstatus)
   ADD_TEST(t_bug27544)
@@ -1368,6 +1368,265 @@ DECLARE_TEST(t_prefetch_bug)
     return OK;
 }
 
+/*
+  Row array fetch with column-wise and row-wise binding. Fixed-width
+  numeric columns are filled column by column for the whole block.
+*/
+DECLARE_TEST(t_rowset_columnar)
+{
+  SQLINTEGER  id[5];
+  SQLSMALLINT sm[5];
+  SQLBIGINT   big[5];
+  SQLDOUBLE   dbl[5];
+  SQLCHAR     name[5][10];
+  SQLLEN      id_ind[5], sm_ind[5], big_ind[5], dbl_ind[5], name_ind[5];
+  SQLULEN     rows_fetched;
+  SQLUSMALLINT status[5];
+  int         i;
+
+  struct {
+    SQLINTEGER id;
+    SQLLEN     id_ind;
+    SQLDOUBLE  dbl;
+    SQLLEN     dbl_ind;
+  } rowbuf[5];
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rowset_columnar");
+  ok_sql(hstmt, "CREATE TABLE t_rowset_columnar (id INT, sm SMALLINT,"
+                "big BIGINT, dbl DOUBLE, name VARCHAR(20))");
+  ok_sql(hstmt, "INSERT INTO t_rowset_columnar VALUES "
+                "(1, -1, 10000000000, 1.5, 'a'),"
+                "(2, NULL, -2, NULL, 'bb'),"
+                "(3, 300, 3, -0.25, NULL),"
+                "(4, 4, NULL, 4e10, 'dddd'),"
+                "(5, 5, 5, 5, 'e'),"
+                "(6, 6, 6, 6, 'f')");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)5, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR,
+                                &rows_fetched, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR,
+                                status, 0));
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, id, 0, id_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_SHORT, sm, 0, sm_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 3, SQL_C_SBIGINT, big, 0, big_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 4, SQL_C_DOUBLE, dbl, 0, dbl_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 5, SQL_C_CHAR, name, sizeof(name[0]),
+                            name_ind));
+
+  ok_sql(hstmt, "SELECT id, sm, big, dbl, name FROM t_rowset_columnar "
+                "ORDER BY id");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(rows_fetched, 5);
+
+  for (i= 0; i < 5; ++i)
+  {
+    is_num(status[i], SQL_ROW_SUCCESS);
+    is_num(id[i], i + 1);
+    is_num(id_ind[i], sizeof(SQLINTEGER));
+  }
+
+  is_num(sm[0], -1);
+  is_num(sm_ind[1], SQL_NULL_DATA);
+  is_num(sm[2], 300);
+  is_num(sm_ind[2], sizeof(SQLSMALLINT));
+  is(big[0] == 10000000000LL);
+  is(big[1] == -2);
+  is_num(big_ind[3], SQL_NULL_DATA);
+  is(dbl[0] == 1.5);
+  is_num(dbl_ind[1], SQL_NULL_DATA);
+  is(dbl[2] == -0.25);
+  is(dbl[3] == 4e10);
+  is_str(name[1], "bb", 3);
+  is_num(name_ind[1], 2);
+  is_num(name_ind[2], SQL_NULL_DATA);
+  is_str(name[3], "dddd", 5);
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(rows_fetched, 1);
+  is_num(id[0], 6);
+  is_num(status[1], SQL_ROW_NOROW);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+
+  /* Row-wise binding */
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE,
+                                (SQLPOINTER)sizeof(rowbuf[0]), 0));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &rowbuf[0].id, 0,
+                            &rowbuf[0].id_ind));
+  ok_stmt(hstmt, SQLBindCol(hstmt, 2, SQL_C_DOUBLE, &rowbuf[0].dbl, 0,
+                            &rowbuf[0].dbl_ind));
+
+  ok_sql(hstmt, "SELECT id, dbl FROM t_rowset_columnar ORDER BY id");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(rows_fetched, 5);
+
+  for (i= 0; i < 5; ++i)
+  {
+    is_num(rowbuf[i].id, i + 1);
+  }
+  is(rowbuf[0].dbl == 1.5);
+  is_num(rowbuf[1].dbl_ind, SQL_NULL_DATA);
+  is(rowbuf[4].dbl == 5.0);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE,
+                                (SQLPOINTER)SQL_BIND_BY_COLUMN, 0));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rowset_columnar");
+
+  return OK;
+}
+
+
+/*
+  Rebinding columns between fetches of the same result has to take
+  effect on the next fetch.
+*/
+DECLARE_TEST(t_rebind_between_fetches)
+{
+  SQLINTEGER  id[2];
+  SQLCHAR     id_str[2][10];
+  SQLDOUBLE   dbl[2];
+  SQLLEN      ind[2];
+  SQLHDESC    ard;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rebind");
+  ok_sql(hstmt, "CREATE TABLE t_rebind (id INT)");
+  ok_sql(hstmt, "INSERT INTO t_rebind VALUES (1),(2),(3),(4),(5),(6)");
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)2, 0));
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, id, 0, ind));
+  ok_sql(hstmt, "SELECT id FROM t_rebind ORDER BY id");
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_num(id[0], 1);
+  is_num(id[1], 2);
+
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_CHAR, id_str, sizeof(id_str[0]),
+                            ind));
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is_str(id_str[0], "3", 2);
+  is_str(id_str[1], "4", 2);
+  is_num(ind[1], 1);
+
+  ok_stmt(hstmt, SQLGetStmtAttr(hstmt, SQL_ATTR_APP_ROW_DESC, &ard, 0, NULL));
+  ok_desc(ard, SQLSetDescField(ard, 1, SQL_DESC_CONCISE_TYPE,
+                               (SQLPOINTER)SQL_C_DOUBLE, SQL_IS_SMALLINT));
+  ok_desc(ard, SQLSetDescField(ard, 1, SQL_DESC_DATA_PTR,
+                               dbl, SQL_IS_POINTER));
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0));
+  is(dbl[0] == 5.0);
+  is(dbl[1] == 6.0);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE,
+                                (SQLPOINTER)1, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_rebind");
+
+  return OK;
+}
+
+
+/*
+  Pages of queries ordered by a unique key are read by the key and in
+  background, rows have to come in the same order, no matter what else
+  runs on the connection meanwhile.
+*/
+DECLARE_TEST(t_prefetch_keyset)
+{
+  SQLHSTMT    hstmt2;
+  SQLINTEGER  id, total;
+  int         i, row;
+  const char *queries[]= {
+    "SELECT 'K-001', id FROM t_prefetch_keyset WHERE id > 10 OR id <= 10 "
+      "ORDER BY id",
+    "SELECT 'K-002', id FROM t_prefetch_keyset ORDER BY id DESC",
+    "SELECT 'K-003', id FROM t_prefetch_keyset ORDER BY id LIMIT 3, 12",
+    "SELECT 'K-004', id FROM t_prefetch_keyset "
+      "ORDER BY t_prefetch_keyset.`id`;",
+    /* Not a unique key, read by offset */
+    "SELECT 'K-005', id FROM t_prefetch_keyset ORDER BY v, id"
+  };
+  int first[]= {1, 23, 4, 1, 1}, step[]= {1, -1, 1, 1, 1},
+      count[]= {23, 23, 12, 23, 23};
+
+  DECLARE_BASIC_HANDLES(henv1, hdbc1, hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset");
+  ok_sql(hstmt, "CREATE TABLE t_prefetch_keyset (id INT PRIMARY KEY, v INT)");
+
+  for (i= 1; i <= 23; ++i)
+  {
+    SQLCHAR buff[64];
+    sprintf((char *)buff, "INSERT INTO t_prefetch_keyset VALUES (%d, %d)",
+            i, i % 3);
+    ok_stmt(hstmt, SQLExecDirect(hstmt, buff, SQL_NTS));
+  }
+
+  is(OK == alloc_basic_handles_with_opt(&henv1, &hdbc1, &hstmt1, NULL,
+                                        NULL, NULL, NULL,
+                                        "PREFETCH=5;NO_SSPS=1"));
+  ok_con(hdbc1, SQLAllocHandle(SQL_HANDLE_STMT, hdbc1, &hstmt2));
+
+  for (i= 0; i < 4; ++i)
+  {
+    ok_stmt(hstmt1, SQLExecDirect(hstmt1, (SQLCHAR *)queries[i], SQL_NTS));
+    ok_stmt(hstmt1, SQLBindCol(hstmt1, 2, SQL_C_LONG, &id, 0, NULL));
+
+    for (row= 0; row < count[i]; ++row)
+    {
+      ok_stmt(hstmt1, SQLFetch(hstmt1));
+      is_num(first[i] + row * step[i], id);
+
+      /* Another query while the next page may be read */
+      if (row == 7)
+      {
+        ok_sql(hstmt2, "SELECT COUNT(*) FROM t_prefetch_keyset");
+        ok_stmt(hstmt2, SQLFetch(hstmt2));
+        is_num(23, my_fetch_int(hstmt2, 1));
+        ok_stmt(hstmt2, SQLFreeStmt(hstmt2, SQL_CLOSE));
+      }
+    }
+
+    expect_stmt(hstmt1, SQLFetch(hstmt1), SQL_NO_DATA);
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+    ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_UNBIND));
+  }
+
+  ok_stmt(hstmt1, SQLExecDirect(hstmt1, (SQLCHAR *)queries[4], SQL_NTS));
+
+  for (total= 0; SQLFetch(hstmt1) == SQL_SUCCESS; ++total);
+  is_num(count[4], total);
+
+  /* Closed before the next page is taken */
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+  ok_stmt(hstmt1, SQLExecDirect(hstmt1, (SQLCHAR *)queries[0], SQL_NTS));
+  ok_stmt(hstmt1, SQLFetch(hstmt1));
+  is_num(first[0], my_fetch_int(hstmt1, 2));
+  ok_stmt(hstmt1, SQLFreeStmt(hstmt1, SQL_CLOSE));
+
+  ok_stmt(hstmt2, SQLFreeHandle(SQL_HANDLE_STMT, hstmt2));
+  free_basic_handles(&henv1, &hdbc1, &hstmt1);
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_prefetch_keyset");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_bug32420)
   ADD_TEST(t_bug34575)
@@ -1395,6 +1654,9 @@ BEGIN_TESTS
 #endif
   ADD_TEST(t_bug17311065)
   ADD_TEST(t_prefetch_bug)
+  ADD_TEST(t_prefetch_keyset)
+  ADD_TEST(t_rowset_columnar)
+  ADD_TEST(t_rebind_between_fetches)
 END_TESTS
 
 
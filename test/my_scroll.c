@@ -1224,6 +1224,62 @@ DECLARE_TEST(t_absolute_2)
 }
 
 
+/*
+  Scrolling far in a big static cursor, rows are found by their number
+*/
+DECLARE_TEST(t_scroll_big_result)
+{
+  SQLINTEGER id;
+  int i;
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_scroll_big_result");
+  ok_sql(hstmt, "CREATE TABLE t_scroll_big_result (id INT PRIMARY KEY)");
+  ok_sql(hstmt, "INSERT INTO t_scroll_big_result VALUES (1),(2),(3),(4),(5)");
+  /* 5 * 2^10 rows numbered from 1 */
+  for (i= 0; i < 10; ++i)
+  {
+    ok_sql(hstmt, "SET @n= (SELECT COUNT(*) FROM t_scroll_big_result)");
+    ok_sql(hstmt, "INSERT INTO t_scroll_big_result "
+                  "SELECT id + @n FROM t_scroll_big_result");
+  }
+
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_STATIC, 0));
+  ok_sql(hstmt, "SELECT id FROM t_scroll_big_result ORDER BY id");
+  ok_stmt(hstmt, SQLBindCol(hstmt, 1, SQL_C_LONG, &id, 0, NULL));
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 4000));
+  is_num(id, 4000);
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_PRIOR, 0));
+  is_num(id, 3999);
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_RELATIVE, -3000));
+  is_num(id, 999);
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_LAST, 0));
+  is_num(id, 5120);
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, -2));
+  is_num(id, 5119);
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_FIRST, 0));
+  is_num(id, 1);
+  expect_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 5121),
+              SQL_NO_DATA);
+
+  ok_stmt(hstmt, SQLFetchScroll(hstmt, SQL_FETCH_ABSOLUTE, 2500));
+  ok_stmt(hstmt, SQLSetPos(hstmt, 1, SQL_POSITION, SQL_LOCK_NO_CHANGE));
+  id= 0;
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_LONG, &id, 0, NULL));
+  is_num(id, 2500);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_UNBIND));
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+  ok_stmt(hstmt, SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE,
+                                (SQLPOINTER)SQL_CURSOR_FORWARD_ONLY, 0));
+
+  ok_sql(hstmt, "DROP TABLE IF EXISTS t_scroll_big_result");
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(t_scroll)
   ADD_TEST(t_array_relative_10)
@@ -1231,6 +1287,7 @@ BEGIN_TESTS
   ADD_TEST(t_relative_1)
   ADD_TEST(t_absolute_1)
   ADD_TEST(t_absolute_2)
+  ADD_TEST(t_scroll_big_result)
 END_TESTS
 
 
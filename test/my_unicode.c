@@ -1412,6 +1412,50 @@ DECLARE_TEST(t_bug14838690)
 }
 
 
+/*
+  SQL_C_WCHAR data retrieved in pieces, mixing 7-bit and other characters.
+*/
+DECLARE_TEST(t_wchar_getdata_pieces)
+{
+  SQLWCHAR result[3];
+  SQLLEN reslen;
+
+  ok_sql(hstmt, "SELECT CONVERT(_latin1 0x616263E96465 USING utf8)");
+  ok_stmt(hstmt, SQLFetch(hstmt));
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_WCHAR, result,
+                                sizeof(result), &reslen),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(reslen, 6 * sizeof(SQLWCHAR));
+  is_num(result[0], 'a');
+  is_num(result[1], 'b');
+  is_num(result[2], 0);
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_WCHAR, result,
+                                sizeof(result), &reslen),
+              SQL_SUCCESS_WITH_INFO);
+  is_num(reslen, 4 * sizeof(SQLWCHAR));
+  is_num(result[0], 'c');
+  is_num(result[1], 0xe9);
+  is_num(result[2], 0);
+
+  ok_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_WCHAR, result,
+                            sizeof(result), &reslen));
+  is_num(reslen, 2 * sizeof(SQLWCHAR));
+  is_num(result[0], 'd');
+  is_num(result[1], 'e');
+  is_num(result[2], 0);
+
+  expect_stmt(hstmt, SQLGetData(hstmt, 1, SQL_C_WCHAR, result,
+                                sizeof(result), &reslen),
+              SQL_NO_DATA_FOUND);
+
+  ok_stmt(hstmt, SQLFreeStmt(hstmt, SQL_CLOSE));
+
+  return OK;
+}
+
+
 BEGIN_TESTS
   ADD_TEST(sqlconnect)
   ADD_TEST_UNICODE(sqlprepare)
@@ -1439,6 +1483,7 @@ BEGIN_TESTS
   ADD_TEST_UNICODE(t_bug32161)
   // ADD_TEST_UNICODE(t_bug34672) TODO: Fix
   ADD_TEST_UNICODE(t_bug28168)
+  ADD_TEST(t_wchar_getdata_pieces)
   // ADD_TEST_UNICODE(t_bug14363601) TODO: Fix
   // ADD_TEST_UNICODE(t_bug14838690) TODO: Fix
 END_TESTS
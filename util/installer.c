@@ -187,6 +187,28 @@ static SQLWCHAR W_SSLMODE[] =
 { 'S', 'S', 'L', 'M', 'O', 'D', 'E', 0 };
 static SQLWCHAR W_NO_DATE_OVERFLOW[] =
 { 'N', 'O', '_', 'D', 'A', 'T', 'E', '_', 'O', 'V', 'E', 'R', 'F', 'L', 'O', 'W', 0 };
+static SQLWCHAR W_MULTI_ROW_INSERTS[]=
+  {'M','U','L','T','I','_','R','O','W','_','I','N','S','E','R','T','S',0};
+static SQLWCHAR W_SSPS_CACHE_SIZE[]=
+  {'S','S','P','S','_','C','A','C','H','E','_','S','I','Z','E',0};
+static SQLWCHAR W_READAHEAD_ROWS[]=
+  {'R','E','A','D','A','H','E','A','D','_','R','O','W','S',0};
+static SQLWCHAR W_READAHEAD_SIZE[]=
+  {'R','E','A','D','A','H','E','A','D','_','S','I','Z','E',0};
+static SQLWCHAR W_POOL_MAX_IDLE[]=
+  {'P','O','O','L','_','M','A','X','_','I','D','L','E',0};
+static SQLWCHAR W_POOL_MIN_IDLE[]=
+  {'P','O','O','L','_','M','I','N','_','I','D','L','E',0};
+static SQLWCHAR W_POOL_IDLE_TIMEOUT[]=
+  {'P','O','O','L','_','I','D','L','E','_','T','I','M','E','O','U','T',0};
+static SQLWCHAR W_POOL_PING_INTERVAL[]=
+  {'P','O','O','L','_','P','I','N','G','_','I','N','T','E','R','V','A','L',0};
+static SQLWCHAR W_LIVENESS_CHECK[]=
+  {'L','I','V','E','N','E','S','S','_','C','H','E','C','K',0};
+static SQLWCHAR W_TCP_KEEPALIVE[]=
+  {'T','C','P','_','K','E','E','P','A','L','I','V','E',0};
+static SQLWCHAR W_KEY_CACHE_TTL[]=
+  {'K','E','Y','_','C','A','C','H','E','_','T','T','L',0};
 
 /* DS_PARAM */
 /* externally used strings */
@@ -220,7 +242,12 @@ SQLWCHAR *dsnparams[]= {W_DSN, W_DRIVER, W_DESCRIPTION, W_SERVER,
                         W_SAVEFILE, W_RSAKEY, W_PLUGIN_DIR, W_DEFAULT_AUTH,
                         W_DISABLE_SSL_DEFAULT, W_SSL_ENFORCE,
                         W_TLS_1, W_NO_TLS_1_1, W_NO_TLS_1_2,
-                        W_SSLMODE, W_NO_DATE_OVERFLOW};
+                        W_SSLMODE, W_NO_DATE_OVERFLOW, W_MULTI_ROW_INSERTS,
+                        W_SSPS_CACHE_SIZE, W_READAHEAD_ROWS,
+                        W_READAHEAD_SIZE, W_POOL_MAX_IDLE, W_POOL_MIN_IDLE,
+                        W_POOL_IDLE_TIMEOUT, W_POOL_PING_INTERVAL,
+                        W_LIVENESS_CHECK, W_TCP_KEEPALIVE,
+                        W_KEY_CACHE_TTL};
 static const
 int dsnparamcnt= sizeof(dsnparams) / sizeof(SQLWCHAR *);
 /* DS_PARAM */
@@ -699,6 +726,80 @@ void ds_delete(DataSource *ds)
 }
 
 
+/* String attributes of a data source with their UTF-8 copies. DS_PARAM */
+#define DS_STRATTR(A) { offsetof(DataSource, A), offsetof(DataSource, A ## 8) }
+
+static const struct
+{
+  size_t attr, attr8;
+} ds_strattrs[]= {
+  DS_STRATTR(name), DS_STRATTR(driver), DS_STRATTR(description),
+  DS_STRATTR(server), DS_STRATTR(uid), DS_STRATTR(pwd), DS_STRATTR(database),
+  DS_STRATTR(socket), DS_STRATTR(initstmt), DS_STRATTR(charset),
+  DS_STRATTR(sslkey), DS_STRATTR(sslcert), DS_STRATTR(sslca),
+  DS_STRATTR(sslcapath), DS_STRATTR(sslcipher), DS_STRATTR(sslmode),
+  DS_STRATTR(rsakey), DS_STRATTR(savefile), DS_STRATTR(plugin_dir),
+  DS_STRATTR(default_auth)
+};
+
+#define DS_ATTR(ds, offset) ((void **)((char *)(ds) + (offset)))
+
+
+/*
+ * Create a copy of a data source object, UTF-8 attributes included.
+ */
+DataSource *ds_dup(DataSource *ds)
+{
+  DataSource *copy= ds_new();
+  size_t i;
+
+  if (!copy)
+    return NULL;
+
+  memcpy(copy, ds, sizeof(DataSource));
+
+  /* Nothing is shared, so the copy can be deleted at any point */
+  for (i= 0; i < sizeof(ds_strattrs) / sizeof(ds_strattrs[0]); ++i)
+  {
+    *DS_ATTR(copy, ds_strattrs[i].attr)= NULL;
+    *DS_ATTR(copy, ds_strattrs[i].attr8)= NULL;
+  }
+
+  for (i= 0; i < sizeof(ds_strattrs) / sizeof(ds_strattrs[0]); ++i)
+  {
+    SQLWCHAR *attr= *(SQLWCHAR **)DS_ATTR(ds, ds_strattrs[i].attr);
+    char *attr8= *(char **)DS_ATTR(ds, ds_strattrs[i].attr8);
+
+    if ((attr && !(*DS_ATTR(copy, ds_strattrs[i].attr)=
+                     sqlwchardup(attr, SQL_NTS))) ||
+        (attr8 && !(*DS_ATTR(copy, ds_strattrs[i].attr8)=
+                      myodbc_strdup(attr8, MYF(0)))))
+    {
+      ds_delete(copy);
+      return NULL;
+    }
+  }
+
+  return copy;
+}
+
+
+/*
+ * Convert all string attributes of a data source object to UTF-8, so
+ * that the connection can use the *8 members as they are.
+ */
+void ds_set_utf8attrs(DataSource *ds)
+{
+  size_t i;
+
+  for (i= 0; i < sizeof(ds_strattrs) / sizeof(ds_strattrs[0]); ++i)
+  {
+    ds_get_utf8attr(*(SQLWCHAR **)DS_ATTR(ds, ds_strattrs[i].attr),
+                    (SQLCHAR **)DS_ATTR(ds, ds_strattrs[i].attr8));
+  }
+}
+
+
 /*
  * Set a string attribute of a given data source object. The string
  * will be copied into the object.
@@ -808,6 +909,26 @@ void ds_map_param(DataSource *ds, const SQLWCHAR *param,
     *intdest= &ds->clientinteractive;
   else if (!sqlwcharcasecmp(W_PREFETCH, param))
     *intdest= &ds->cursor_prefetch_number;
+  else if (!sqlwcharcasecmp(W_SSPS_CACHE_SIZE, param))
+    *intdest= &ds->ssps_cache_size;
+  else if (!sqlwcharcasecmp(W_READAHEAD_ROWS, param))
+    *intdest= &ds->readahead_rows;
+  else if (!sqlwcharcasecmp(W_READAHEAD_SIZE, param))
+    *intdest= &ds->readahead_size;
+  else if (!sqlwcharcasecmp(W_POOL_MAX_IDLE, param))
+    *intdest= &ds->pool_max_idle;
+  else if (!sqlwcharcasecmp(W_POOL_MIN_IDLE, param))
+    *intdest= &ds->pool_min_idle;
+  else if (!sqlwcharcasecmp(W_POOL_IDLE_TIMEOUT, param))
+    *intdest= &ds->pool_idle_timeout;
+  else if (!sqlwcharcasecmp(W_POOL_PING_INTERVAL, param))
+    *intdest= &ds->pool_ping_interval;
+  else if (!sqlwcharcasecmp(W_LIVENESS_CHECK, param))
+    *intdest= &ds->liveness_check;
+  else if (!sqlwcharcasecmp(W_TCP_KEEPALIVE, param))
+    *intdest= &ds->tcp_keepalive;
+  else if (!sqlwcharcasecmp(W_KEY_CACHE_TTL, param))
+    *intdest= &ds->key_cache_ttl;
   else if (!sqlwcharcasecmp(W_FOUND_ROWS, param))
     *booldest= &ds->return_matching_rows;
   else if (!sqlwcharcasecmp(W_BIG_PACKETS, param))
@@ -888,6 +1009,8 @@ void ds_map_param(DataSource *ds, const SQLWCHAR *param,
     *booldest = &ds->no_tls_1_2;
   else if (!sqlwcharcasecmp(W_NO_DATE_OVERFLOW, param))
     *booldest = &ds->no_date_overflow;
+  else if (!sqlwcharcasecmp(W_MULTI_ROW_INSERTS, param))
+    *booldest= &ds->multi_row_inserts;
 
   /* DS_PARAM */
 }
@@ -1382,6 +1505,17 @@ int ds_add(DataSource *ds)
   if (ds_add_intprop(ds->name, W_NO_TLS_1_1, ds->no_tls_1_1)) goto error;
   if (ds_add_intprop(ds->name, W_NO_TLS_1_2, ds->no_tls_1_2)) goto error;
   if (ds_add_intprop(ds->name, W_NO_DATE_OVERFLOW, ds->no_date_overflow)) goto error;
+  if (ds_add_intprop(ds->name, W_MULTI_ROW_INSERTS, ds->multi_row_inserts)) goto error;
+  if (ds_add_intprop(ds->name, W_SSPS_CACHE_SIZE, ds->ssps_cache_size)) goto error;
+  if (ds_add_intprop(ds->name, W_READAHEAD_ROWS, ds->readahead_rows)) goto error;
+  if (ds_add_intprop(ds->name, W_READAHEAD_SIZE, ds->readahead_size)) goto error;
+  if (ds_add_intprop(ds->name, W_POOL_MAX_IDLE, ds->pool_max_idle)) goto error;
+  if (ds_add_intprop(ds->name, W_POOL_MIN_IDLE, ds->pool_min_idle)) goto error;
+  if (ds_add_intprop(ds->name, W_POOL_IDLE_TIMEOUT, ds->pool_idle_timeout)) goto error;
+  if (ds_add_intprop(ds->name, W_POOL_PING_INTERVAL, ds->pool_ping_interval)) goto error;
+  if (ds_add_intprop(ds->name, W_LIVENESS_CHECK, ds->liveness_check)) goto error;
+  if (ds_add_intprop(ds->name, W_TCP_KEEPALIVE, ds->tcp_keepalive)) goto error;
+  if (ds_add_intprop(ds->name, W_KEY_CACHE_TTL, ds->key_cache_ttl)) goto error;
   /* DS_PARAM */
 
   rc= 0;
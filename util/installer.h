@@ -162,6 +162,28 @@ typedef struct {
   BOOL no_tls_1_2;
 
   BOOL no_date_overflow;
+  /* Paramsets of INSERT ... VALUES are sent as multi-row INSERTs */
+  BOOL multi_row_inserts;
+  /* Number of server-side prepared statements a connection keeps for reuse */
+  unsigned int ssps_cache_size;
+  /* Rows of a forward-only result read ahead by a background thread */
+  unsigned int readahead_rows;
+  /* Limit of memory taken by rows read ahead, in kilobytes */
+  unsigned int readahead_size;
+  /* Connections kept open by the driver for reuse, 0 disables the pool */
+  unsigned int pool_max_idle;
+  /* Idle connections never closed for being idle too long */
+  unsigned int pool_min_idle;
+  /* Seconds an idle connection is kept, 0 keeps it until it is reused */
+  unsigned int pool_idle_timeout;
+  /* Seconds between pings of an idle connection, 0 disables pings */
+  unsigned int pool_ping_interval;
+  /* How a lost connection is detected, one of LIVENESS_CHECK_* */
+  unsigned int liveness_check;
+  /* Seconds of idle time before TCP keepalive probes, 0 keeps the default */
+  unsigned int tcp_keepalive;
+  /* Seconds keys of a table read by a connection are reused, 0 disables */
+  unsigned int key_cache_ttl;
 } DataSource;
 
 /* perhaps that is a good idea to have const ds object with defaults */
@@ -180,6 +202,8 @@ typedef struct{
 
 DataSource *ds_new();
 void ds_delete(DataSource *ds);
+DataSource *ds_dup(DataSource *ds);
+void ds_set_utf8attrs(DataSource *ds);
 int ds_set_strattr(SQLWCHAR **attr, const SQLWCHAR *val);
 int ds_set_strnattr(SQLWCHAR **attr, const SQLWCHAR *val, size_t charcount);
 int ds_lookup(DataSource *ds);
@@ -246,6 +270,11 @@ extern const SQLWCHAR W_INVALID_ATTR_STR[];
 #define ODBC_SSL_MODE_VERIFY_CA          "VERIFY_CA"
 #define ODBC_SSL_MODE_VERIFY_IDENTITY    "VERIFY_IDENTITY"
 
+/* Values of LIVENESS_CHECK */
+#define LIVENESS_CHECK_PING   0 /* ping before a query after a long idle time */
+#define LIVENESS_CHECK_RETRY  1 /* re-run a read once after reconnecting */
+#define LIVENESS_CHECK_NEVER  2 /* just report the lost connection */
+
 #define LPASTE(X) L ## X
 #define LSTR(X) LPASTE(X)
 